@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package org.libbitcoin.consensus;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * The overhead of crossing JNI per input and per block. Run with JMH on the
+ * class path and the binding's native library on java.library.path:
+ *     java -Djava.library.path=. -cp jmh.jar:consensus.jar \
+ *         org.openjdk.jmh.Main ConsensusBenchmark
+ *
+ * call     - a rejected (empty) transaction, only the cost of the JNI call.
+ * perInput - one verifyScript call for each input of the block.
+ * perBlock - one verifyTransactions call for the block, on a single thread.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3)
+@Measurement(iterations = 5)
+@Fork(1)
+public class ConsensusBenchmark
+{
+    // A p2pkh spend, see test/consensus__verify_transaction.cpp.
+    private static final String TRANSACTION =
+        "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000";
+    private static final String PREVOUT_SCRIPT =
+        "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac";
+
+    /** The number of (single input) transactions in the block. */
+    @Param({ "1", "100", "2000" })
+    public int transactions;
+
+    private final int flags = Consensus.verify_flags_p2sh;
+    private ByteBuffer empty;
+    private ByteBuffer block;
+    private ByteBuffer script;
+    private ByteBuffer[] inputs;
+    private Batch batch;
+    private int[] results;
+
+    @Setup
+    public void setup()
+    {
+        final byte[] transaction = decode(TRANSACTION);
+        final byte[] prevout = decode(PREVOUT_SCRIPT);
+
+        empty = ByteBuffer.allocateDirect(0);
+        script = ByteBuffer.allocateDirect(prevout.length);
+        script.put(prevout).flip();
+        block = ByteBuffer.allocateDirect(transaction.length * transactions);
+        inputs = new ByteBuffer[transactions];
+        batch = new Batch();
+        results = new int[transactions];
+
+        for (int index = 0; index < transactions; ++index)
+        {
+            final int offset = block.position();
+            block.put(transaction);
+            inputs[index] = block.duplicate();
+            inputs[index].position(offset).limit(block.position());
+            batch.addTransaction(offset, transaction.length)
+                .addPrevout(0, prevout.length, 0);
+        }
+
+        block.flip();
+        if (perBlock() != Consensus.verify_result_eval_true)
+            throw new IllegalStateException("benchmark block is invalid");
+    }
+
+    @Benchmark
+    public int call()
+    {
+        return Consensus.verifyScript(empty, script, 0, 0, flags);
+    }
+
+    @Benchmark
+    public int perInput()
+    {
+        int result = Consensus.verify_result_eval_true;
+        for (final ByteBuffer input: inputs)
+        {
+            final int code = Consensus.verifyScript(input, script, 0, 0, flags);
+            if (code != Consensus.verify_result_eval_true)
+                result = code;
+        }
+
+        return result;
+    }
+
+    @Benchmark
+    public int perBlock()
+    {
+        return Consensus.verifyTransactions(results, block, script, batch,
+            flags, 1);
+    }
+
+    private static byte[] decode(String hex)
+    {
+        final byte[] out = new byte[hex.length() / 2];
+        for (int index = 0; index < out.length; ++index)
+            out[index] = (byte)Integer.parseInt(
+                hex.substring(index * 2, index * 2 + 2), 16);
+
+        return out;
+    }
+}
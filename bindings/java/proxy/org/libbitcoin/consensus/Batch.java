@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package org.libbitcoin.consensus;
+
+import java.util.Arrays;
+
+/**
+ * The transactions of a batch verification and the outputs that they spend,
+ * as absolute offsets into direct buffers (such as a block and the scripts of
+ * its prevouts). A batch is reusable across blocks by clear().
+ */
+public final class Batch
+{
+    private long[] layout = new long[1024];
+    private int layoutSize = 0;
+    private int size = 0;
+    private int countIndex = -1;
+
+    /**
+     * Add a transaction, followed by the outputs spent by its inputs in order.
+     * @param offset  The offset of the transaction in the buffer.
+     * @param length  The serialized size of the transaction.
+     * @return        This batch.
+     */
+    public Batch addTransaction(int offset, int length)
+    {
+        put(offset);
+        put(length);
+        countIndex = layoutSize;
+        put(0);
+        ++size;
+        return this;
+    }
+
+    /**
+     * Add an output spent by the input of the last added transaction.
+     * @param offset  The offset of the output script in the buffer.
+     * @param length  The size of the output script.
+     * @param value   The value of the output, in satoshis.
+     * @return        This batch.
+     */
+    public Batch addPrevout(int offset, int length, long value)
+    {
+        if (countIndex < 0)
+            throw new IllegalStateException("no transaction added");
+
+        put(offset);
+        put(length);
+        put(value);
+        ++layout[countIndex];
+        return this;
+    }
+
+    /** Remove all transactions, retaining capacity. */
+    public void clear()
+    {
+        layoutSize = 0;
+        size = 0;
+        countIndex = -1;
+    }
+
+    /** The number of transactions. */
+    public int size()
+    {
+        return size;
+    }
+
+    long[] layout()
+    {
+        return layout;
+    }
+
+    int layoutSize()
+    {
+        return layoutSize;
+    }
+
+    private void put(long value)
+    {
+        if (layoutSize == layout.length)
+            layout = Arrays.copyOf(layout, layout.length * 2);
+
+        layout[layoutSize++] = value;
+    }
+}
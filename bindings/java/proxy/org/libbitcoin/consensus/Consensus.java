@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package org.libbitcoin.consensus;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Bitcoin consensus script verification (libbitcoin-consensus).
+ *
+ * Transactions and scripts are read in place from direct buffers, which must
+ * not be modified during a call. Single buffer arguments are read from
+ * position to limit, batches are described by absolute offsets (see Batch).
+ * Methods return a verify_result code, verify_result_eval_true on success.
+ */
+public final class Consensus
+{
+    static
+    {
+        System.loadLibrary("bitcoin-consensus-jni");
+    }
+
+    private Consensus()
+    {
+    }
+
+    public static final String version = version();
+
+    // verify_result
+    public static final int verify_result_eval_false =
+        constant("verify_result_eval_false");
+    public static final int verify_result_eval_true =
+        constant("verify_result_eval_true");
+    public static final int verify_result_script_size =
+        constant("verify_result_script_size");
+    public static final int verify_result_push_size =
+        constant("verify_result_push_size");
+    public static final int verify_result_op_count =
+        constant("verify_result_op_count");
+    public static final int verify_result_stack_size =
+        constant("verify_result_stack_size");
+    public static final int verify_result_sig_count =
+        constant("verify_result_sig_count");
+    public static final int verify_result_pubkey_count =
+        constant("verify_result_pubkey_count");
+    public static final int verify_result_verify =
+        constant("verify_result_verify");
+    public static final int verify_result_equalverify =
+        constant("verify_result_equalverify");
+    public static final int verify_result_checkmultisigverify =
+        constant("verify_result_checkmultisigverify");
+    public static final int verify_result_checksigverify =
+        constant("verify_result_checksigverify");
+    public static final int verify_result_numequalverify =
+        constant("verify_result_numequalverify");
+    public static final int verify_result_bad_opcode =
+        constant("verify_result_bad_opcode");
+    public static final int verify_result_disabled_opcode =
+        constant("verify_result_disabled_opcode");
+    public static final int verify_result_invalid_stack_operation =
+        constant("verify_result_invalid_stack_operation");
+    public static final int verify_result_invalid_altstack_operation =
+        constant("verify_result_invalid_altstack_operation");
+    public static final int verify_result_unbalanced_conditional =
+        constant("verify_result_unbalanced_conditional");
+    public static final int verify_result_sig_hashtype =
+        constant("verify_result_sig_hashtype");
+    public static final int verify_result_sig_der =
+        constant("verify_result_sig_der");
+    public static final int verify_result_minimaldata =
+        constant("verify_result_minimaldata");
+    public static final int verify_result_sig_pushonly =
+        constant("verify_result_sig_pushonly");
+    public static final int verify_result_sig_high_s =
+        constant("verify_result_sig_high_s");
+    public static final int verify_result_sig_nulldummy =
+        constant("verify_result_sig_nulldummy");
+    public static final int verify_result_pubkeytype =
+        constant("verify_result_pubkeytype");
+    public static final int verify_result_cleanstack =
+        constant("verify_result_cleanstack");
+    public static final int verify_result_minimalif =
+        constant("verify_result_minimalif");
+    public static final int verify_result_sig_nullfail =
+        constant("verify_result_sig_nullfail");
+    public static final int verify_result_discourage_upgradable_nops =
+        constant("verify_result_discourage_upgradable_nops");
+    public static final int verify_result_discourage_upgradable_witness_program =
+        constant("verify_result_discourage_upgradable_witness_program");
+    public static final int verify_result_op_return =
+        constant("verify_result_op_return");
+    public static final int verify_result_unknown_error =
+        constant("verify_result_unknown_error");
+    public static final int verify_result_witness_program_wrong_length =
+        constant("verify_result_witness_program_wrong_length");
+    public static final int verify_result_witness_program_empty_witness =
+        constant("verify_result_witness_program_empty_witness");
+    public static final int verify_result_witness_program_mismatch =
+        constant("verify_result_witness_program_mismatch");
+    public static final int verify_result_witness_malleated =
+        constant("verify_result_witness_malleated");
+    public static final int verify_result_witness_malleated_p2sh =
+        constant("verify_result_witness_malleated_p2sh");
+    public static final int verify_result_witness_unexpected =
+        constant("verify_result_witness_unexpected");
+    public static final int verify_result_witness_pubkeytype =
+        constant("verify_result_witness_pubkeytype");
+    public static final int verify_result_tx_invalid =
+        constant("verify_result_tx_invalid");
+    public static final int verify_result_tx_size_invalid =
+        constant("verify_result_tx_size_invalid");
+    public static final int verify_result_tx_input_invalid =
+        constant("verify_result_tx_input_invalid");
+    public static final int verify_result_negative_locktime =
+        constant("verify_result_negative_locktime");
+    public static final int verify_result_unsatisfied_locktime =
+        constant("verify_result_unsatisfied_locktime");
+    public static final int verify_value_overflow =
+        constant("verify_value_overflow");
+    public static final int verify_evaluation_throws =
+        constant("verify_evaluation_throws");
+    public static final int verify_result_block_invalid =
+        constant("verify_result_block_invalid");
+    public static final int verify_result_block_prevouts_invalid =
+        constant("verify_result_block_prevouts_invalid");
+    public static final int verify_result_tx_inputs_empty =
+        constant("verify_result_tx_inputs_empty");
+    public static final int verify_result_tx_outputs_empty =
+        constant("verify_result_tx_outputs_empty");
+    public static final int verify_result_tx_oversize =
+        constant("verify_result_tx_oversize");
+    public static final int verify_result_tx_output_value_invalid =
+        constant("verify_result_tx_output_value_invalid");
+    public static final int verify_result_tx_outputs_value_overflow =
+        constant("verify_result_tx_outputs_value_overflow");
+    public static final int verify_result_tx_inputs_duplicate =
+        constant("verify_result_tx_inputs_duplicate");
+    public static final int verify_result_tx_coinbase_script_size =
+        constant("verify_result_tx_coinbase_script_size");
+    public static final int verify_result_tx_prevout_null =
+        constant("verify_result_tx_prevout_null");
+    public static final int verify_result_tx_not_final =
+        constant("verify_result_tx_not_final");
+    public static final int verify_result_tx_sequence_locked =
+        constant("verify_result_tx_sequence_locked");
+    public static final int verify_result_tx_confirmations_invalid =
+        constant("verify_result_tx_confirmations_invalid");
+    public static final int verify_result_block_merkle_mutated =
+        constant("verify_result_block_merkle_mutated");
+    public static final int verify_result_block_merkle_mismatch =
+        constant("verify_result_block_merkle_mismatch");
+    public static final int verify_result_block_witness_nonce_size =
+        constant("verify_result_block_witness_nonce_size");
+    public static final int verify_result_block_witness_mismatch =
+        constant("verify_result_block_witness_mismatch");
+    public static final int verify_result_block_witness_uncommitted =
+        constant("verify_result_block_witness_uncommitted");
+    public static final int verify_result_block_witness_unexpected =
+        constant("verify_result_block_witness_unexpected");
+    public static final int verify_result_cancelled =
+        constant("verify_result_cancelled");
+
+    // verify_flags
+    public static final int verify_flags_none = constant("verify_flags_none");
+    public static final int verify_flags_p2sh = constant("verify_flags_p2sh");
+    public static final int verify_flags_strictenc =
+        constant("verify_flags_strictenc");
+    public static final int verify_flags_dersig =
+        constant("verify_flags_dersig");
+    public static final int verify_flags_low_s = constant("verify_flags_low_s");
+    public static final int verify_flags_nulldummy =
+        constant("verify_flags_nulldummy");
+    public static final int verify_flags_sigpushonly =
+        constant("verify_flags_sigpushonly");
+    public static final int verify_flags_minimaldata =
+        constant("verify_flags_minimaldata");
+    public static final int verify_flags_discourage_upgradable_nops =
+        constant("verify_flags_discourage_upgradable_nops");
+    public static final int verify_flags_cleanstack =
+        constant("verify_flags_cleanstack");
+    public static final int verify_flags_checklocktimeverify =
+        constant("verify_flags_checklocktimeverify");
+    public static final int verify_flags_checksequenceverify =
+        constant("verify_flags_checksequenceverify");
+    public static final int verify_flags_witness =
+        constant("verify_flags_witness");
+    public static final int verify_flags_discourage_upgradable_witness_program =
+        constant("verify_flags_discourage_upgradable_witness_program");
+    public static final int verify_flags_minimal_if =
+        constant("verify_flags_minimal_if");
+    public static final int verify_flags_null_fail =
+        constant("verify_flags_null_fail");
+    public static final int verify_flags_witness_public_key_compressed =
+        constant("verify_flags_witness_public_key_compressed");
+    public static final int verify_flags_all = constant("verify_flags_all");
+
+    /**
+     * Verify that the transaction input correctly spends the previous output.
+     * @param transaction    The serialized transaction, a direct buffer.
+     * @param prevoutScript  The script of the spent output, a direct buffer.
+     * @param prevoutValue   The value of the spent output, in satoshis.
+     * @param inputIndex     The index of the input within the transaction.
+     * @param flags          Verification constraint flags.
+     * @return               A script verification result code.
+     */
+    public static int verifyScript(ByteBuffer transaction,
+        ByteBuffer prevoutScript, long prevoutValue, int inputIndex, int flags)
+    {
+        return verifyScript(transaction, transaction.position(),
+            transaction.remaining(), prevoutScript, prevoutScript.position(),
+            prevoutScript.remaining(), prevoutValue, inputIndex, flags);
+    }
+
+    /**
+     * Verify each transaction of the batch, as all inputs of a transaction,
+     * with inputs verified on the library's pool. The batch crosses into the
+     * library once, so that a block is verified for the cost of a single
+     * native call.
+     * @param results       Receives the result of each transaction.
+     * @param transactions  The direct buffer of the batch's transactions.
+     * @param scripts       The direct buffer of the batch's prevout scripts,
+     *                      which may be the transactions buffer.
+     * @param batch         The transactions and prevouts within the buffers.
+     * @param flags         Verification constraint flags.
+     * @param threads       One to verify on the calling thread alone,
+     *                      otherwise the library's default pool is used.
+     * @return              The first failure result, by transaction order,
+     *                      or verify_result_eval_true.
+     */
+    public static int verifyTransactions(int[] results,
+        ByteBuffer transactions, ByteBuffer scripts, Batch batch, int flags,
+        int threads)
+    {
+        if (results.length < batch.size())
+            throw new IllegalArgumentException("results shorter than batch");
+
+        if (threads < 0)
+            throw new IllegalArgumentException("threads must not be negative");
+
+        return verifyTransactions(results, transactions, scripts,
+            batch.layout(), batch.layoutSize(), batch.size(), flags, threads);
+    }
+
+    private static native int verifyScript(ByteBuffer transaction,
+        int transactionOffset, int transactionSize, ByteBuffer prevoutScript,
+        int prevoutScriptOffset, int prevoutScriptSize, long prevoutValue,
+        int inputIndex, int flags);
+
+    private static native int verifyTransactions(int[] results,
+        ByteBuffer transactions, ByteBuffer scripts, long[] layout,
+        int layoutSize, int count, int flags, int threads);
+
+    private static native int constant(String name);
+
+    private static native String version();
+}
@@ -1,95 +0,0 @@
-/* ----------------------------------------------------------------------------
- * This file was automatically generated by SWIG (http://www.swig.org).
- * Version 3.0.8
- *
- * Do not make changes to this file unless you know what you are doing--modify
- * the SWIG interface file instead.
- * ----------------------------------------------------------------------------- */
-
-
-public final class verify_result {
-  public final static verify_result verify_result_eval_false = new verify_result("verify_result_eval_false", consensusJNI.verify_result_eval_false_get());
-  public final static verify_result verify_result_eval_true = new verify_result("verify_result_eval_true");
-  public final static verify_result verify_result_script_size = new verify_result("verify_result_script_size");
-  public final static verify_result verify_result_push_size = new verify_result("verify_result_push_size");
-  public final static verify_result verify_result_op_count = new verify_result("verify_result_op_count");
-  public final static verify_result verify_result_stack_size = new verify_result("verify_result_stack_size");
-  public final static verify_result verify_result_sig_count = new verify_result("verify_result_sig_count");
-  public final static verify_result verify_result_pubkey_count = new verify_result("verify_result_pubkey_count");
-  public final static verify_result verify_result_verify = new verify_result("verify_result_verify");
-  public final static verify_result verify_result_equalverify = new verify_result("verify_result_equalverify");
-  public final static verify_result verify_result_checkmultisigverify = new verify_result("verify_result_checkmultisigverify");
-  public final static verify_result verify_result_checksigverify = new verify_result("verify_result_checksigverify");
-  public final static verify_result verify_result_numequalverify = new verify_result("verify_result_numequalverify");
-  public final static verify_result verify_result_bad_opcode = new verify_result("verify_result_bad_opcode");
-  public final static verify_result verify_result_disabled_opcode = new verify_result("verify_result_disabled_opcode");
-  public final static verify_result verify_result_invalid_stack_operation = new verify_result("verify_result_invalid_stack_operation");
-  public final static verify_result verify_result_invalid_altstack_operation = new verify_result("verify_result_invalid_altstack_operation");
-  public final static verify_result verify_result_unbalanced_conditional = new verify_result("verify_result_unbalanced_conditional");
-  public final static verify_result verify_result_sig_hashtype = new verify_result("verify_result_sig_hashtype");
-  public final static verify_result verify_result_sig_der = new verify_result("verify_result_sig_der");
-  public final static verify_result verify_result_minimaldata = new verify_result("verify_result_minimaldata");
-  public final static verify_result verify_result_sig_pushonly = new verify_result("verify_result_sig_pushonly");
-  public final static verify_result verify_result_sig_high_s = new verify_result("verify_result_sig_high_s");
-  public final static verify_result verify_result_sig_nulldummy = new verify_result("verify_result_sig_nulldummy");
-  public final static verify_result verify_result_pubkeytype = new verify_result("verify_result_pubkeytype");
-  public final static verify_result verify_result_cleanstack = new verify_result("verify_result_cleanstack");
-  public final static verify_result verify_result_minimalif = new verify_result("verify_result_minimalif");
-  public final static verify_result verify_result_sig_nullfail = new verify_result("verify_result_sig_nullfail");
-  public final static verify_result verify_result_discourage_upgradable_nops = new verify_result("verify_result_discourage_upgradable_nops");
-  public final static verify_result verify_result_discourage_upgradable_witness_program = new verify_result("verify_result_discourage_upgradable_witness_program");
-  public final static verify_result verify_result_op_return = new verify_result("verify_result_op_return");
-  public final static verify_result verify_result_unknown_error = new verify_result("verify_result_unknown_error");
-  public final static verify_result verify_result_witness_program_wrong_length = new verify_result("verify_result_witness_program_wrong_length");
-  public final static verify_result verify_result_witness_program_empty_witness = new verify_result("verify_result_witness_program_empty_witness");
-  public final static verify_result verify_result_witness_program_mismatch = new verify_result("verify_result_witness_program_mismatch");
-  public final static verify_result verify_result_witness_malleated = new verify_result("verify_result_witness_malleated");
-  public final static verify_result verify_result_witness_malleated_p2sh = new verify_result("verify_result_witness_malleated_p2sh");
-  public final static verify_result verify_result_witness_unexpected = new verify_result("verify_result_witness_unexpected");
-  public final static verify_result verify_result_witness_pubkeytype = new verify_result("verify_result_witness_pubkeytype");
-  public final static verify_result verify_result_tx_invalid = new verify_result("verify_result_tx_invalid");
-  public final static verify_result verify_result_tx_size_invalid = new verify_result("verify_result_tx_size_invalid");
-  public final static verify_result verify_result_tx_input_invalid = new verify_result("verify_result_tx_input_invalid");
-  public final static verify_result verify_result_negative_locktime = new verify_result("verify_result_negative_locktime");
-  public final static verify_result verify_result_unsatisfied_locktime = new verify_result("verify_result_unsatisfied_locktime");
-
-  public final int swigValue() {
-    return swigValue;
-  }
-
-  public String toString() {
-    return swigName;
-  }
-
-  public static verify_result swigToEnum(int swigValue) {
-    if (swigValue < swigValues.length && swigValue >= 0 && swigValues[swigValue].swigValue == swigValue)
-      return swigValues[swigValue];
-    for (int i = 0; i < swigValues.length; i++)
-      if (swigValues[i].swigValue == swigValue)
-        return swigValues[i];
-    throw new IllegalArgumentException("No enum " + verify_result.class + " with value " + swigValue);
-  }
-
-  private verify_result(String swigName) {
-    this.swigName = swigName;
-    this.swigValue = swigNext++;
-  }
-
-  private verify_result(String swigName, int swigValue) {
-    this.swigName = swigName;
-    this.swigValue = swigValue;
-    swigNext = swigValue+1;
-  }
-
-  private verify_result(String swigName, verify_result swigEnum) {
-    this.swigName = swigName;
-    this.swigValue = swigEnum.swigValue;
-    swigNext = this.swigValue+1;
-  }
-
-  private static verify_result[] swigValues = { verify_result_eval_false, verify_result_eval_true, verify_result_script_size, verify_result_push_size, verify_result_op_count, verify_result_stack_size, verify_result_sig_count, verify_result_pubkey_count, verify_result_verify, verify_result_equalverify, verify_result_checkmultisigverify, verify_result_checksigverify, verify_result_numequalverify, verify_result_bad_opcode, verify_result_disabled_opcode, verify_result_invalid_stack_operation, verify_result_invalid_altstack_operation, verify_result_unbalanced_conditional, verify_result_sig_hashtype, verify_result_sig_der, verify_result_minimaldata, verify_result_sig_pushonly, verify_result_sig_high_s, verify_result_sig_nulldummy, verify_result_pubkeytype, verify_result_cleanstack, verify_result_minimalif, verify_result_sig_nullfail, verify_result_discourage_upgradable_nops, verify_result_discourage_upgradable_witness_program, verify_result_op_return, verify_result_unknown_error, verify_result_witness_program_wrong_length, verify_result_witness_program_empty_witness, verify_result_witness_program_mismatch, verify_result_witness_malleated, verify_result_witness_malleated_p2sh, verify_result_witness_unexpected, verify_result_witness_pubkeytype, verify_result_tx_invalid, verify_result_tx_size_invalid, verify_result_tx_input_invalid, verify_result_negative_locktime, verify_result_unsatisfied_locktime };
-  private static int swigNext = 0;
-  private final int swigValue;
-  private final String swigName;
-}
-
@@ -1,553 +1,345 @@
-/* ----------------------------------------------------------------------------
- * This file was automatically generated by SWIG (http://www.swig.org).
- * Version 3.0.8
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
  *
- * This file is not intended to be easily readable and contains a number of
- * coding conventions designed to improve portability and efficiency. Do not make
- * changes to this file unless you know what you are doing--modify the SWIG
- * interface file instead.
- * ----------------------------------------------------------------------------- */
-
-
-#ifndef SWIGJAVA
-#define SWIGJAVA
-#endif
-
-
-
-#ifdef __cplusplus
-/* SwigValueWrapper is described in swig.swg */
-template<typename T> class SwigValueWrapper {
-  struct SwigMovePointer {
-    T *ptr;
-    SwigMovePointer(T *p) : ptr(p) { }
-    ~SwigMovePointer() { delete ptr; }
-    SwigMovePointer& operator=(SwigMovePointer& rhs) { T* oldptr = ptr; ptr = 0; delete oldptr; ptr = rhs.ptr; rhs.ptr = 0; return *this; }
-  } pointer;
-  SwigValueWrapper& operator=(const SwigValueWrapper<T>& rhs);
-  SwigValueWrapper(const SwigValueWrapper<T>& rhs);
-public:
-  SwigValueWrapper() : pointer(0) { }
-  SwigValueWrapper& operator=(const T& t) { SwigMovePointer tmp(new T(t)); pointer = tmp; return *this; }
-  operator T&() const { return *pointer.ptr; }
-  T *operator&() { return pointer.ptr; }
-};
-
-template <typename T> T SwigValueInit() {
-  return T();
-}
-#endif
-
-/* -----------------------------------------------------------------------------
- *  This section contains generic SWIG labels for method/variable
- *  declarations/attributes, and other compiler dependent labels.
- * ----------------------------------------------------------------------------- */
-
-/* template workaround for compilers that cannot correctly implement the C++ standard */
-#ifndef SWIGTEMPLATEDISAMBIGUATOR
-# if defined(__SUNPRO_CC) && (__SUNPRO_CC <= 0x560)
-#  define SWIGTEMPLATEDISAMBIGUATOR template
-# elif defined(__HP_aCC)
-/* Needed even with `aCC -AA' when `aCC -V' reports HP ANSI C++ B3910B A.03.55 */
-/* If we find a maximum version that requires this, the test would be __HP_aCC <= 35500 for A.03.55 */
-#  define SWIGTEMPLATEDISAMBIGUATOR template
-# else
-#  define SWIGTEMPLATEDISAMBIGUATOR
-# endif
-#endif
-
-/* inline attribute */
-#ifndef SWIGINLINE
-# if defined(__cplusplus) || (defined(__GNUC__) && !defined(__STRICT_ANSI__))
-#   define SWIGINLINE inline
-# else
-#   define SWIGINLINE
-# endif
-#endif
-
-/* attribute recognised by some compilers to avoid 'unused' warnings */
-#ifndef SWIGUNUSED
-# if defined(__GNUC__)
-#   if !(defined(__cplusplus)) || (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
-#     define SWIGUNUSED __attribute__ ((__unused__))
-#   else
-#     define SWIGUNUSED
-#   endif
-# elif defined(__ICC)
-#   define SWIGUNUSED __attribute__ ((__unused__))
-# else
-#   define SWIGUNUSED
-# endif
-#endif
-
-#ifndef SWIG_MSC_UNSUPPRESS_4505
-# if defined(_MSC_VER)
-#   pragma warning(disable : 4505) /* unreferenced local function has been removed */
-# endif
-#endif
-
-#ifndef SWIGUNUSEDPARM
-# ifdef __cplusplus
-#   define SWIGUNUSEDPARM(p)
-# else
-#   define SWIGUNUSEDPARM(p) p SWIGUNUSED
-# endif
-#endif
-
-/* internal SWIG method */
-#ifndef SWIGINTERN
-# define SWIGINTERN static SWIGUNUSED
-#endif
-
-/* internal inline SWIG method */
-#ifndef SWIGINTERNINLINE
-# define SWIGINTERNINLINE SWIGINTERN SWIGINLINE
-#endif
-
-/* exporting methods */
-#if (__GNUC__ >= 4) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)
-#  ifndef GCC_HASCLASSVISIBILITY
-#    define GCC_HASCLASSVISIBILITY
-#  endif
-#endif
-
-#ifndef SWIGEXPORT
-# if defined(_WIN32) || defined(__WIN32__) || defined(__CYGWIN__)
-#   if defined(STATIC_LINKED)
-#     define SWIGEXPORT
-#   else
-#     define SWIGEXPORT __declspec(dllexport)
-#   endif
-# else
-#   if defined(__GNUC__) && defined(GCC_HASCLASSVISIBILITY)
-#     define SWIGEXPORT __attribute__ ((visibility("default")))
-#   else
-#     define SWIGEXPORT
-#   endif
-# endif
-#endif
-
-/* calling conventions for Windows */
-#ifndef SWIGSTDCALL
-# if defined(_WIN32) || defined(__WIN32__) || defined(__CYGWIN__)
-#   define SWIGSTDCALL __stdcall
-# else
-#   define SWIGSTDCALL
-# endif
-#endif
-
-/* Deal with Microsoft's attempt at deprecating C standard runtime functions */
-#if !defined(SWIG_NO_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER) && !defined(_CRT_SECURE_NO_DEPRECATE)
-# define _CRT_SECURE_NO_DEPRECATE
-#endif
-
-/* Deal with Microsoft's attempt at deprecating methods in the standard C++ library */
-#if !defined(SWIG_NO_SCL_SECURE_NO_DEPRECATE) && defined(_MSC_VER) && !defined(_SCL_SECURE_NO_DEPRECATE)
-# define _SCL_SECURE_NO_DEPRECATE
-#endif
-
-/* Deal with Apple's deprecated 'AssertMacros.h' from Carbon-framework */
-#if defined(__APPLE__) && !defined(__ASSERT_MACROS_DEFINE_VERSIONS_WITHOUT_UNDERSCORES)
-# define __ASSERT_MACROS_DEFINE_VERSIONS_WITHOUT_UNDERSCORES 0
-#endif
-
-/* Intel's compiler complains if a variable which was never initialised is
- * cast to void, which is a common idiom which we use to indicate that we
- * are aware a variable isn't used.  So we just silence that warning.
- * See: https://github.com/swig/swig/issues/192 for more discussion.
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#ifdef __INTEL_COMPILER
-# pragma warning disable 592
-#endif
 
-
-/* Fix for jlong on some versions of gcc on Windows */
-#if defined(__GNUC__) && !defined(__INTEL_COMPILER)
-  typedef long long __int64;
-#endif
-
-/* Fix for jlong on 64-bit x86 Solaris */
-#if defined(__x86_64)
-# ifdef _LP64
-#   undef _LP64
-# endif
-#endif
+// The native methods of org.libbitcoin.consensus.Consensus, written against
+// JNI rather than generated, so that transactions and scripts are read in place
+// from direct ByteBuffers (GetDirectBufferAddress) without being copied, and so
+// that a batch of transactions crosses the JNI boundary once. Build against an
+// installed libbitcoin-consensus as the bitcoin-consensus-jni library, with the
+// JDK's include and include/<platform> directories on the include path.
 
 #include <jni.h>
-#include <stdlib.h>
-#include <string.h>
-
-
-/* Support for throwing Java exceptions */
-typedef enum {
-  SWIG_JavaOutOfMemoryError = 1, 
-  SWIG_JavaIOException, 
-  SWIG_JavaRuntimeException, 
-  SWIG_JavaIndexOutOfBoundsException,
-  SWIG_JavaArithmeticException,
-  SWIG_JavaIllegalArgumentException,
-  SWIG_JavaNullPointerException,
-  SWIG_JavaDirectorPureVirtual,
-  SWIG_JavaUnknownError
-} SWIG_JavaExceptionCodes;
-
-typedef struct {
-  SWIG_JavaExceptionCodes code;
-  const char *java_exception;
-} SWIG_JavaExceptions_t;
-
-
-static void SWIGUNUSED SWIG_JavaThrowException(JNIEnv *jenv, SWIG_JavaExceptionCodes code, const char *msg) {
-  jclass excep;
-  static const SWIG_JavaExceptions_t java_exceptions[] = {
-    { SWIG_JavaOutOfMemoryError, "java/lang/OutOfMemoryError" },
-    { SWIG_JavaIOException, "java/io/IOException" },
-    { SWIG_JavaRuntimeException, "java/lang/RuntimeException" },
-    { SWIG_JavaIndexOutOfBoundsException, "java/lang/IndexOutOfBoundsException" },
-    { SWIG_JavaArithmeticException, "java/lang/ArithmeticException" },
-    { SWIG_JavaIllegalArgumentException, "java/lang/IllegalArgumentException" },
-    { SWIG_JavaNullPointerException, "java/lang/NullPointerException" },
-    { SWIG_JavaDirectorPureVirtual, "java/lang/RuntimeException" },
-    { SWIG_JavaUnknownError,  "java/lang/UnknownError" },
-    { (SWIG_JavaExceptionCodes)0,  "java/lang/UnknownError" }
-  };
-  const SWIG_JavaExceptions_t *except_ptr = java_exceptions;
-
-  while (except_ptr->code != code && except_ptr->code)
-    except_ptr++;
-
-  jenv->ExceptionClear();
-  excep = jenv->FindClass(except_ptr->java_exception);
-  if (excep)
-    jenv->ThrowNew(excep, msg);
-}
-
-
-/* Contract support */
-
-#define SWIG_contract_assert(nullreturn, expr, msg) if (!(expr)) {SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, msg); return nullreturn; } else
-
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
 #include <bitcoin/consensus.hpp>
 
+using namespace libbitcoin::consensus;
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-SWIGEXPORT jstring JNICALL Java_consensusJNI_LIBBITCOIN_1CONSENSUS_1VERSION_1get(JNIEnv *jenv, jclass jcls) {
-  jstring jresult = 0 ;
-  char *result = 0 ;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (char *)("3.3.0");
-  if (result) jresult = jenv->NewStringUTF((const char *)result);
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_LIBBITCOIN_1CONSENSUS_1MAJOR_1VERSION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (int)(3);
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_LIBBITCOIN_1CONSENSUS_1MINOR_1VERSION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (int)(3);
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_LIBBITCOIN_1CONSENSUS_1PATCH_1VERSION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (int)(0);
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1result_1eval_1false_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_result_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_result_type)libbitcoin::consensus::verify_result_eval_false;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1none_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_none;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1p2sh_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_p2sh;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1strictenc_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_strictenc;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1dersig_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_dersig;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1low_1s_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_low_s;
-  jresult = (jint)result; 
-  return jresult;
-}
-
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1nulldummy_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_nulldummy;
-  jresult = (jint)result; 
-  return jresult;
-}
-
+// The number of layout elements of a transaction and of each of its prevouts.
+static constexpr jint transaction_layout = 3;
+static constexpr jint prevout_layout = 3;
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1sigpushonly_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_sigpushonly;
-  jresult = (jint)result; 
-  return jresult;
+static void throw_new(JNIEnv* env, const char* type, const char* message)
+{
+    const auto type_class = env->FindClass(type);
+    if (type_class != nullptr)
+        env->ThrowNew(type_class, message);
 }
 
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1minimaldata_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_minimaldata;
-  jresult = (jint)result; 
-  return jresult;
+static void throw_argument(JNIEnv* env, const char* message)
+{
+    throw_new(env, "java/lang/IllegalArgumentException", message);
 }
 
+// The bytes [offset, offset + size) of a direct buffer, or nullptr with a
+// pending exception. The address is stable, direct buffers are not moved.
+static const uint8_t* address(JNIEnv* env, jobject buffer, jlong offset,
+    jlong size)
+{
+    if (buffer == nullptr)
+    {
+        throw_new(env, "java/lang/NullPointerException", "buffer");
+        return nullptr;
+    }
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1discourage_1upgradable_1nops_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_discourage_upgradable_nops;
-  jresult = (jint)result; 
-  return jresult;
-}
+    const auto base = static_cast<const uint8_t*>(
+        env->GetDirectBufferAddress(buffer));
+    const auto capacity = env->GetDirectBufferCapacity(buffer);
+    if (base == nullptr || capacity < 0)
+    {
+        throw_argument(env, "buffer must be direct");
+        return nullptr;
+    }
 
+    if (offset < 0 || size < 0 || offset > capacity - size)
+    {
+        throw_argument(env, "buffer range out of bounds");
+        return nullptr;
+    }
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1cleanstack_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_cleanstack;
-  jresult = (jint)result; 
-  return jresult;
+    return base + offset;
 }
 
+// The transactions and prevouts of a batch layout, referencing the buffers.
+static bool read_layout(JNIEnv* env,
+    std::vector<transaction_reference>& transactions,
+    std::vector<output_reference>& prevouts, jobject transactions_buffer,
+    jobject scripts_buffer, const jlong* layout, jint layout_size)
+{
+    std::vector<size_t> starts(transactions.size());
+    jint position = 0;
+
+    for (size_t index = 0; index < transactions.size(); ++index)
+    {
+        if (layout_size - position < transaction_layout)
+        {
+            throw_argument(env, "batch layout truncated");
+            return false;
+        }
+
+        const auto offset = layout[position++];
+        const auto size = layout[position++];
+        const auto count = layout[position++];
+        const auto data = address(env, transactions_buffer, offset, size);
+        if (data == nullptr)
+            return false;
+
+        if (count < 0 || count > (layout_size - position) / prevout_layout)
+        {
+            throw_argument(env, "batch layout truncated");
+            return false;
+        }
+
+        starts[index] = prevouts.size();
+        transactions[index] =
+        {
+            data, static_cast<size_t>(size), nullptr,
+            static_cast<size_t>(count)
+        };
+
+        for (jlong prevout = 0; prevout < count; ++prevout)
+        {
+            const auto script_offset = layout[position++];
+            const auto script_size = layout[position++];
+            const auto value = layout[position++];
+            const auto script = address(env, scripts_buffer, script_offset,
+                script_size);
+            if (script == nullptr)
+                return false;
+
+            prevouts.push_back({ script, static_cast<size_t>(script_size),
+                static_cast<uint64_t>(value) });
+        }
+    }
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1checklocktimeverify_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_checklocktimeverify;
-  jresult = (jint)result; 
-  return jresult;
-}
-
+    // Prevouts are referenced once the vector is no longer reallocated.
+    for (size_t index = 0; index < transactions.size(); ++index)
+        transactions[index].prevouts = prevouts.data() + starts[index];
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1checksequenceverify_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_checksequenceverify;
-  jresult = (jint)result; 
-  return jresult;
+    return true;
 }
 
+extern "C" {
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1witness_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_witness;
-  jresult = (jint)result; 
-  return jresult;
+JNIEXPORT jint JNICALL Java_org_libbitcoin_consensus_Consensus_verifyScript(
+    JNIEnv* env, jclass, jobject transaction_buffer, jint transaction_offset,
+    jint transaction_size, jobject script_buffer, jint script_offset,
+    jint script_size, jlong value, jint input_index, jint flags)
+{
+    const auto transaction = address(env, transaction_buffer,
+        transaction_offset, transaction_size);
+    if (transaction == nullptr)
+        return verify_result_eval_false;
+
+    const auto script = address(env, script_buffer, script_offset,
+        script_size);
+    if (script == nullptr)
+        return verify_result_eval_false;
+
+    const output_reference prevout
+    {
+        script, static_cast<size_t>(script_size), static_cast<uint64_t>(value)
+    };
+
+    return verify_script(transaction, static_cast<size_t>(transaction_size),
+        prevout, static_cast<uint32_t>(input_index),
+        static_cast<uint32_t>(flags));
 }
 
+JNIEXPORT jint JNICALL
+Java_org_libbitcoin_consensus_Consensus_verifyTransactions(JNIEnv* env,
+    jclass, jintArray results_array, jobject transactions_buffer,
+    jobject scripts_buffer, jlongArray layout_array, jint layout_size,
+    jint count, jint flags, jint threads)
+{
+    if (count <= 0)
+        return verify_result_eval_true;
+
+    std::vector<transaction_reference> transactions;
+    std::vector<output_reference> prevouts;
+    std::vector<verify_result> results;
+    std::vector<jint> codes;
+
+    try
+    {
+        transactions.resize(static_cast<size_t>(count));
+        prevouts.reserve(static_cast<size_t>(layout_size / prevout_layout));
+        results.resize(static_cast<size_t>(count));
+        codes.resize(static_cast<size_t>(count));
+    }
+    catch (const std::bad_alloc&)
+    {
+        throw_new(env, "java/lang/OutOfMemoryError", "batch");
+        return verify_result_eval_false;
+    }
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1discourage_1upgradable_1witness_1program_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_discourage_upgradable_witness_program;
-  jresult = (jint)result; 
-  return jresult;
-}
-
+    if (layout_size < 0 || env->GetArrayLength(layout_array) < layout_size ||
+        env->GetArrayLength(results_array) < count)
+    {
+        throw_argument(env, "batch arrays out of bounds");
+        return verify_result_eval_false;
+    }
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1minimal_1if_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_minimal_if;
-  jresult = (jint)result; 
-  return jresult;
-}
+    // The layout is small relative to the data and may be copied by the VM.
+    const auto layout = env->GetLongArrayElements(layout_array, nullptr);
+    if (layout == nullptr)
+        return verify_result_eval_false;
 
+    const auto read = read_layout(env, transactions, prevouts,
+        transactions_buffer, scripts_buffer, layout, layout_size);
+    env->ReleaseLongArrayElements(layout_array, layout, JNI_ABORT);
+    if (!read)
+        return verify_result_eval_false;
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1null_1fail_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_null_fail;
-  jresult = (jint)result; 
-  return jresult;
-}
+    const auto result = verify_transactions(results.data(),
+        transactions.data(), transactions.size(), static_cast<uint32_t>(flags),
+        static_cast<size_t>(threads));
 
+    for (size_t index = 0; index < results.size(); ++index)
+        codes[index] = results[index];
 
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1flags_1witness_1public_1key_1compressed_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  libbitcoin::consensus::verify_flags_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  result = (libbitcoin::consensus::verify_flags_type)libbitcoin::consensus::verify_flags_witness_public_key_compressed;
-  jresult = (jint)result; 
-  return jresult;
+    env->SetIntArrayRegion(results_array, 0, count, codes.data());
+    return result;
 }
 
-
-SWIGEXPORT jint JNICALL Java_consensusJNI_verify_1script(JNIEnv *jenv, jclass jcls, jlong jarg1, jlong jarg2, jlong jarg3, jlong jarg4, jobject jarg5, jlong jarg6, jlong jarg7) {
-  jint jresult = 0 ;
-  unsigned char *arg1 = (unsigned char *) 0 ;
-  size_t arg2 ;
-  unsigned char *arg3 = (unsigned char *) 0 ;
-  size_t arg4 ;
-  unsigned long long arg5 ;
-  unsigned int arg6 ;
-  unsigned int arg7 ;
-  libbitcoin::consensus::verify_result_type result;
-  
-  (void)jenv;
-  (void)jcls;
-  arg1 = *(unsigned char **)&jarg1; 
-  arg2 = (size_t)jarg2; 
-  arg3 = *(unsigned char **)&jarg3; 
-  arg4 = (size_t)jarg4; 
-  {
-    jclass clazz;
-    jmethodID mid;
-    jbyteArray ba;
-    jbyte* bae;
-    jsize sz;
-    int i;
-    
-    if (!jarg5) {
-      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "BigInteger null");
-      return 0;
-    }
-    clazz = jenv->GetObjectClass(jarg5);
-    mid = jenv->GetMethodID(clazz, "toByteArray", "()[B");
-    ba = (jbyteArray)jenv->CallObjectMethod(jarg5, mid);
-    bae = jenv->GetByteArrayElements(ba, 0);
-    sz = jenv->GetArrayLength(ba);
-    arg5 = 0;
-    for(i=0; i<sz; i++) {
-      arg5 = (arg5 << 8) | (unsigned long long)(unsigned char)bae[i];
+JNIEXPORT jint JNICALL Java_org_libbitcoin_consensus_Consensus_constant(
+    JNIEnv* env, jclass, jstring name)
+{
+#define BCK_JAVA_CONSTANT(name) { #name, name }
+    static const struct { const char* name; jint value; } constants[] =
+    {
+    // verify_result
+    BCK_JAVA_CONSTANT(verify_result_eval_false),
+    BCK_JAVA_CONSTANT(verify_result_eval_true),
+    BCK_JAVA_CONSTANT(verify_result_script_size),
+    BCK_JAVA_CONSTANT(verify_result_push_size),
+    BCK_JAVA_CONSTANT(verify_result_op_count),
+    BCK_JAVA_CONSTANT(verify_result_stack_size),
+    BCK_JAVA_CONSTANT(verify_result_sig_count),
+    BCK_JAVA_CONSTANT(verify_result_pubkey_count),
+    BCK_JAVA_CONSTANT(verify_result_verify),
+    BCK_JAVA_CONSTANT(verify_result_equalverify),
+    BCK_JAVA_CONSTANT(verify_result_checkmultisigverify),
+    BCK_JAVA_CONSTANT(verify_result_checksigverify),
+    BCK_JAVA_CONSTANT(verify_result_numequalverify),
+    BCK_JAVA_CONSTANT(verify_result_bad_opcode),
+    BCK_JAVA_CONSTANT(verify_result_disabled_opcode),
+    BCK_JAVA_CONSTANT(verify_result_invalid_stack_operation),
+    BCK_JAVA_CONSTANT(verify_result_invalid_altstack_operation),
+    BCK_JAVA_CONSTANT(verify_result_unbalanced_conditional),
+    BCK_JAVA_CONSTANT(verify_result_sig_hashtype),
+    BCK_JAVA_CONSTANT(verify_result_sig_der),
+    BCK_JAVA_CONSTANT(verify_result_minimaldata),
+    BCK_JAVA_CONSTANT(verify_result_sig_pushonly),
+    BCK_JAVA_CONSTANT(verify_result_sig_high_s),
+    BCK_JAVA_CONSTANT(verify_result_sig_nulldummy),
+    BCK_JAVA_CONSTANT(verify_result_pubkeytype),
+    BCK_JAVA_CONSTANT(verify_result_cleanstack),
+    BCK_JAVA_CONSTANT(verify_result_minimalif),
+    BCK_JAVA_CONSTANT(verify_result_sig_nullfail),
+    BCK_JAVA_CONSTANT(verify_result_discourage_upgradable_nops),
+    BCK_JAVA_CONSTANT(verify_result_discourage_upgradable_witness_program),
+    BCK_JAVA_CONSTANT(verify_result_op_return),
+    BCK_JAVA_CONSTANT(verify_result_unknown_error),
+    BCK_JAVA_CONSTANT(verify_result_witness_program_wrong_length),
+    BCK_JAVA_CONSTANT(verify_result_witness_program_empty_witness),
+    BCK_JAVA_CONSTANT(verify_result_witness_program_mismatch),
+    BCK_JAVA_CONSTANT(verify_result_witness_malleated),
+    BCK_JAVA_CONSTANT(verify_result_witness_malleated_p2sh),
+    BCK_JAVA_CONSTANT(verify_result_witness_unexpected),
+    BCK_JAVA_CONSTANT(verify_result_witness_pubkeytype),
+    BCK_JAVA_CONSTANT(verify_result_tx_invalid),
+    BCK_JAVA_CONSTANT(verify_result_tx_size_invalid),
+    BCK_JAVA_CONSTANT(verify_result_tx_input_invalid),
+    BCK_JAVA_CONSTANT(verify_result_negative_locktime),
+    BCK_JAVA_CONSTANT(verify_result_unsatisfied_locktime),
+    BCK_JAVA_CONSTANT(verify_value_overflow),
+    BCK_JAVA_CONSTANT(verify_evaluation_throws),
+    BCK_JAVA_CONSTANT(verify_result_block_invalid),
+    BCK_JAVA_CONSTANT(verify_result_block_prevouts_invalid),
+    BCK_JAVA_CONSTANT(verify_result_tx_inputs_empty),
+    BCK_JAVA_CONSTANT(verify_result_tx_outputs_empty),
+    BCK_JAVA_CONSTANT(verify_result_tx_oversize),
+    BCK_JAVA_CONSTANT(verify_result_tx_output_value_invalid),
+    BCK_JAVA_CONSTANT(verify_result_tx_outputs_value_overflow),
+    BCK_JAVA_CONSTANT(verify_result_tx_inputs_duplicate),
+    BCK_JAVA_CONSTANT(verify_result_tx_coinbase_script_size),
+    BCK_JAVA_CONSTANT(verify_result_tx_prevout_null),
+    BCK_JAVA_CONSTANT(verify_result_tx_not_final),
+    BCK_JAVA_CONSTANT(verify_result_tx_sequence_locked),
+    BCK_JAVA_CONSTANT(verify_result_tx_confirmations_invalid),
+    BCK_JAVA_CONSTANT(verify_result_block_merkle_mutated),
+    BCK_JAVA_CONSTANT(verify_result_block_merkle_mismatch),
+    BCK_JAVA_CONSTANT(verify_result_block_witness_nonce_size),
+    BCK_JAVA_CONSTANT(verify_result_block_witness_mismatch),
+    BCK_JAVA_CONSTANT(verify_result_block_witness_uncommitted),
+    BCK_JAVA_CONSTANT(verify_result_block_witness_unexpected),
+    BCK_JAVA_CONSTANT(verify_result_cancelled),
+
+    // verify_flags
+    BCK_JAVA_CONSTANT(verify_flags_none),
+    BCK_JAVA_CONSTANT(verify_flags_p2sh),
+    BCK_JAVA_CONSTANT(verify_flags_strictenc),
+    BCK_JAVA_CONSTANT(verify_flags_dersig),
+    BCK_JAVA_CONSTANT(verify_flags_low_s),
+    BCK_JAVA_CONSTANT(verify_flags_nulldummy),
+    BCK_JAVA_CONSTANT(verify_flags_sigpushonly),
+    BCK_JAVA_CONSTANT(verify_flags_minimaldata),
+    BCK_JAVA_CONSTANT(verify_flags_discourage_upgradable_nops),
+    BCK_JAVA_CONSTANT(verify_flags_cleanstack),
+    BCK_JAVA_CONSTANT(verify_flags_checklocktimeverify),
+    BCK_JAVA_CONSTANT(verify_flags_checksequenceverify),
+    BCK_JAVA_CONSTANT(verify_flags_witness),
+    BCK_JAVA_CONSTANT(verify_flags_discourage_upgradable_witness_program),
+    BCK_JAVA_CONSTANT(verify_flags_minimal_if),
+    BCK_JAVA_CONSTANT(verify_flags_null_fail),
+    BCK_JAVA_CONSTANT(verify_flags_witness_public_key_compressed),
+    BCK_JAVA_CONSTANT(verify_flags_all),
+    };
+#undef BCK_JAVA_CONSTANT
+
+    const auto text = env->GetStringUTFChars(name, nullptr);
+    if (text == nullptr)
+        return 0;
+
+    for (const auto& constant: constants)
+    {
+        if (std::strcmp(constant.name, text) == 0)
+        {
+            env->ReleaseStringUTFChars(name, text);
+            return constant.value;
+        }
     }
-    jenv->ReleaseByteArrayElements(ba, bae, 0);
-  }
-  arg6 = (unsigned int)jarg6; 
-  arg7 = (unsigned int)jarg7; 
-  result = (libbitcoin::consensus::verify_result_type)libbitcoin::consensus::verify_script((unsigned char const *)arg1,arg2,(unsigned char const *)arg3,arg4,arg5,arg6,arg7);
-  jresult = (jint)result; 
-  return jresult;
-}
 
+    env->ReleaseStringUTFChars(name, text);
+    throw_argument(env, "unknown constant");
+    return 0;
+}
 
-#ifdef __cplusplus
+JNIEXPORT jstring JNICALL Java_org_libbitcoin_consensus_Consensus_version(
+    JNIEnv* env, jclass)
+{
+    return env->NewStringUTF(LIBBITCOIN_CONSENSUS_VERSION);
 }
-#endif
 
+} // extern "C"
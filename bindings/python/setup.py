@@ -0,0 +1,22 @@
+###############################################################################
+#  Copyright (c) 2014-2023 libbitcoin-consensus developers (see COPYING).
+###############################################################################
+# Build the consensus Python binding against an installed libbitcoin-consensus:
+#     python setup.py build_ext
+# Set CPPFLAGS and LDFLAGS to locate a library that is not installed.
+
+from setuptools import Extension, setup
+
+setup(
+    name="libbitcoin-consensus",
+    version="4.0.0",
+    description="Bitcoin consensus script verification (libbitcoin-consensus)",
+    package_dir={"": "proxy"},
+    py_modules=["consensus"],
+    ext_modules=[
+        Extension(
+            "_consensus",
+            sources=["wrap/consensus.cpp"],
+            libraries=["bitcoin-consensus"],
+            extra_compile_args=["-std=c++17"])
+    ])
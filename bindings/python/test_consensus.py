@@ -0,0 +1,83 @@
+###############################################################################
+#  Copyright (c) 2014-2023 libbitcoin-consensus developers (see COPYING).
+###############################################################################
+# Test the consensus Python binding, once built (see setup.py):
+#     python setup.py build_ext --inplace
+#     PYTHONPATH=proxy python -m unittest test_consensus
+
+import unittest
+
+import consensus
+
+# Test case derived from:
+# github.com/libbitcoin/libbitcoin-explorer/wiki/How-to-Spend-Bitcoin
+TX = bytes.fromhex(
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e"
+    "7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc"
+    "1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d1"
+    "59b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfa"
+    "d66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b604"
+    "8de8dd4d9f1c88ac00000000")
+PREVOUT_SCRIPT = bytes.fromhex(
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac")
+WRONG_PREVOUT_SCRIPT = bytes.fromhex(
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac")
+
+FLAGS = consensus.verify_flags_p2sh
+
+# Each buffer type is read in place.
+BUFFERS = (bytes, bytearray, memoryview)
+
+
+class TestConsensus(unittest.TestCase):
+    def test_verify_script_valid_true(self):
+        for buffer in BUFFERS:
+            with self.subTest(buffer=buffer.__name__):
+                result = consensus.verify_script(
+                    buffer(TX), buffer(PREVOUT_SCRIPT), 0, 0, FLAGS)
+                self.assertEqual(result, consensus.verify_result_eval_true)
+
+    def test_verify_script_wrong_prevout_equalverify(self):
+        for buffer in BUFFERS:
+            with self.subTest(buffer=buffer.__name__):
+                result = consensus.verify_script(
+                    buffer(TX), buffer(WRONG_PREVOUT_SCRIPT), 0, 0, FLAGS)
+                self.assertEqual(result,
+                    consensus.verify_result_equalverify)
+
+    def test_verify_transaction_valid_true(self):
+        for buffer in BUFFERS:
+            with self.subTest(buffer=buffer.__name__):
+                result = consensus.verify_transaction(
+                    buffer(TX), [(buffer(PREVOUT_SCRIPT), 0)], FLAGS)
+                self.assertEqual(result, consensus.verify_result_eval_true)
+
+    def test_verify_transaction_wrong_prevout_equalverify(self):
+        for buffer in BUFFERS:
+            with self.subTest(buffer=buffer.__name__):
+                result = consensus.verify_transaction(
+                    buffer(TX), [(buffer(WRONG_PREVOUT_SCRIPT), 0)], FLAGS)
+                self.assertEqual(result,
+                    consensus.verify_result_equalverify)
+
+    def test_verify_transactions_mixed_buffers_results(self):
+        transactions = [
+            (buffer(TX), [(buffer(script), 0)])
+            for buffer in BUFFERS
+            for script in (PREVOUT_SCRIPT, WRONG_PREVOUT_SCRIPT)]
+
+        for threads in (0, 1):
+            with self.subTest(threads=threads):
+                results = consensus.verify_transactions(
+                    transactions, FLAGS, threads=threads)
+                self.assertEqual(results, [
+                    consensus.verify_result_eval_true,
+                    consensus.verify_result_equalverify] * len(BUFFERS))
+
+    def test_verify_script_not_buffer_type_error(self):
+        with self.assertRaises(TypeError):
+            consensus.verify_script("text", PREVOUT_SCRIPT, 0, 0, FLAGS)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CONSENSUS_H
+#define LIBBITCOIN_CONSENSUS_H
+
+/**
+ * C API users: Include only this header. It declares a C ABI, parallel to the
+ * C++ interface of consensus.hpp, for foreign function interfaces. Arguments
+ * are flat structs and pointer and length pairs of memory borrowed from the
+ * caller for the duration of the call, results are written to caller owned
+ * structs. Calls do not allocate at the boundary.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/version.hpp>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Result codes, the values of libbitcoin::consensus::verify_result.
+ */
+typedef enum bck_verify_result
+{
+    // Logical result
+    bck_verify_result_eval_false = 0,
+    bck_verify_result_eval_true,
+
+    // Max size errors
+    bck_verify_result_script_size,
+    bck_verify_result_push_size,
+    bck_verify_result_op_count,
+    bck_verify_result_stack_size,
+    bck_verify_result_sig_count,
+    bck_verify_result_pubkey_count,
+
+    // Failed verify operations
+    bck_verify_result_verify,
+    bck_verify_result_equalverify,
+    bck_verify_result_checkmultisigverify,
+    bck_verify_result_checksigverify,
+    bck_verify_result_numequalverify,
+
+    // Logical/Format/Canonical errors
+    bck_verify_result_bad_opcode,
+    bck_verify_result_disabled_opcode,
+    bck_verify_result_invalid_stack_operation,
+    bck_verify_result_invalid_altstack_operation,
+    bck_verify_result_unbalanced_conditional,
+
+    // BIP62 errors
+    bck_verify_result_sig_hashtype,
+    bck_verify_result_sig_der,
+    bck_verify_result_minimaldata,
+    bck_verify_result_sig_pushonly,
+    bck_verify_result_sig_high_s,
+    bck_verify_result_sig_nulldummy,
+    bck_verify_result_pubkeytype,
+    bck_verify_result_cleanstack,
+    bck_verify_result_minimalif,
+    bck_verify_result_sig_nullfail,
+
+    // Softfork safeness
+    bck_verify_result_discourage_upgradable_nops,
+    bck_verify_result_discourage_upgradable_witness_program,
+
+    // Other
+    bck_verify_result_op_return,
+    bck_verify_result_unknown_error,
+
+    // Segregated witness
+    bck_verify_result_witness_program_wrong_length,
+    bck_verify_result_witness_program_empty_witness,
+    bck_verify_result_witness_program_mismatch,
+    bck_verify_result_witness_malleated,
+    bck_verify_result_witness_malleated_p2sh,
+    bck_verify_result_witness_unexpected,
+    bck_verify_result_witness_pubkeytype,
+
+    // augmention codes for tx deserialization
+    bck_verify_result_tx_invalid,
+    bck_verify_result_tx_size_invalid,
+    bck_verify_result_tx_input_invalid,
+
+    // BIP65/BIP112 (shared codes)
+    bck_verify_result_negative_locktime,
+    bck_verify_result_unsatisfied_locktime,
+
+    // Deserialization errors
+    bck_verify_value_overflow,
+    bck_verify_evaluation_throws,
+
+    // Block deserialization
+    bck_verify_result_block_invalid,
+    bck_verify_result_block_prevouts_invalid,
+
+    // Transaction checks
+    bck_verify_result_tx_inputs_empty,
+    bck_verify_result_tx_outputs_empty,
+    bck_verify_result_tx_oversize,
+    bck_verify_result_tx_output_value_invalid,
+    bck_verify_result_tx_outputs_value_overflow,
+    bck_verify_result_tx_inputs_duplicate,
+    bck_verify_result_tx_coinbase_script_size,
+    bck_verify_result_tx_prevout_null,
+
+    // Transaction locks
+    bck_verify_result_tx_not_final,
+    bck_verify_result_tx_sequence_locked,
+    bck_verify_result_tx_confirmations_invalid,
+
+    // Block merkle trees
+    bck_verify_result_block_merkle_mutated,
+    bck_verify_result_block_merkle_mismatch,
+    bck_verify_result_block_witness_nonce_size,
+    bck_verify_result_block_witness_mismatch,
+    bck_verify_result_block_witness_uncommitted,
+    bck_verify_result_block_witness_unexpected,
+
+    // Batch verification
+    bck_verify_result_cancelled
+} bck_verify_result;
+
+/**
+ * Flags, the values of libbitcoin::consensus::verify_flags.
+ */
+typedef enum bck_verify_flags
+{
+    bck_verify_flags_none = 0,
+    bck_verify_flags_p2sh = (1U << 0),
+    bck_verify_flags_strictenc = (1U << 1),
+    bck_verify_flags_dersig = (1U << 2),
+    bck_verify_flags_low_s = (1U << 3),
+    bck_verify_flags_nulldummy = (1U << 4),
+    bck_verify_flags_sigpushonly = (1U << 5),
+    bck_verify_flags_minimaldata = (1U << 6),
+    bck_verify_flags_discourage_upgradable_nops = (1U << 7),
+    bck_verify_flags_cleanstack = (1U << 8),
+    bck_verify_flags_checklocktimeverify = (1U << 9),
+    bck_verify_flags_checksequenceverify = (1U << 10),
+    bck_verify_flags_witness = (1U << 11),
+    bck_verify_flags_discourage_upgradable_witness_program = (1U << 12),
+    bck_verify_flags_minimal_if = (1U << 13),
+    bck_verify_flags_null_fail = (1U << 14),
+    bck_verify_flags_witness_public_key_compressed = (1U << 15),
+    bck_verify_flags_all = 0x7fff
+} bck_verify_flags;
+
+/**
+ * A previous output, its script is borrowed from the caller.
+ */
+typedef struct bck_output
+{
+    const uint8_t* script;
+    size_t script_size;
+    uint64_t value;
+} bck_output;
+
+/**
+ * A serialized transaction and the outputs spent by its inputs, in order,
+ * borrowed from the caller.
+ */
+typedef struct bck_transaction
+{
+    const uint8_t* transaction;
+    size_t transaction_size;
+    const bck_output* prevouts;
+    size_t prevouts_size;
+} bck_transaction;
+
+/**
+ * The result of verifying a transaction. The input is that of a script
+ * failure, it is zero for failures of the transaction as a whole.
+ */
+typedef struct bck_result
+{
+    int32_t code;
+    uint32_t input;
+} bck_result;
+
+/**
+ * The library version (LIBBITCOIN_CONSENSUS_VERSION), for a caller to check
+ * that it has loaded the library that it was built against.
+ */
+BCK_API const char* bck_version(void);
+
+/**
+ * Verify that the transaction input correctly spends the previous output,
+ * considering any additional constraints specified by flags.
+ * @param[in]  transaction       The serialized transaction.
+ * @param[in]  transaction_size  The byte length of the transaction.
+ * @param[in]  prevout           The output spent by the input.
+ * @param[in]  input_index       The zero-based index of the input.
+ * @param[in]  flags             Verification constraint flags.
+ * @returns                      A bck_verify_result code.
+ */
+BCK_API int32_t bck_verify_script(const uint8_t* transaction,
+    size_t transaction_size, const bck_output* prevout, uint32_t input_index,
+    uint32_t flags);
+
+/**
+ * Verify that all inputs of the transaction correctly spend the previous
+ * outputs, considering any additional constraints specified by flags. The
+ * inputs are verified in parallel on the library's default verification pool.
+ * @param[out] result       Receives the result, may be null.
+ * @param[in]  transaction  The transaction and the outputs that it spends.
+ * @param[in]  flags        Verification constraint flags.
+ * @returns                 The bck_verify_result code of the first failure.
+ */
+BCK_API int32_t bck_verify_transaction(bck_result* result,
+    const bck_transaction* transaction, uint32_t flags);
+
+/**
+ * Verify each of the transactions as bck_verify_transaction, with their
+ * inputs verified in parallel on the library's default verification pool.
+ * The calling thread verifies alongside its workers.
+ * @param[out] results       Receives the result of each transaction.
+ * @param[in]  transactions  The transactions and the outputs that they spend.
+ * @param[in]  count         The number of transactions (and results).
+ * @param[in]  flags         Verification constraint flags.
+ * @param[in]  threads       One to verify on the calling thread alone,
+ *                           otherwise the default pool is used.
+ * @returns                  The code of the first failure, in transaction
+ *                           order, or bck_verify_result_eval_true.
+ */
+BCK_API int32_t bck_verify_transactions(bck_result* results,
+    const bck_transaction* transactions, size_t count, uint32_t flags,
+    size_t threads);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -19,8 +19,12 @@
 #ifndef LIBBITCOIN_CONSENSUS_EXPORT_HPP
 #define LIBBITCOIN_CONSENSUS_EXPORT_HPP
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <bitcoin/consensus/define.hpp>
 #include <bitcoin/consensus/version.hpp>
@@ -99,7 +103,37 @@ typedef enum verify_result
 
     // Deserialization errors
     verify_value_overflow,
-    verify_evaluation_throws
+    verify_evaluation_throws,
+
+    // Block deserialization
+    verify_result_block_invalid,
+    verify_result_block_prevouts_invalid,
+
+    // Transaction checks
+    verify_result_tx_inputs_empty,
+    verify_result_tx_outputs_empty,
+    verify_result_tx_oversize,
+    verify_result_tx_output_value_invalid,
+    verify_result_tx_outputs_value_overflow,
+    verify_result_tx_inputs_duplicate,
+    verify_result_tx_coinbase_script_size,
+    verify_result_tx_prevout_null,
+
+    // Transaction locks
+    verify_result_tx_not_final,
+    verify_result_tx_sequence_locked,
+    verify_result_tx_confirmations_invalid,
+
+    // Block merkle trees
+    verify_result_block_merkle_mutated,
+    verify_result_block_merkle_mismatch,
+    verify_result_block_witness_nonce_size,
+    verify_result_block_witness_mismatch,
+    verify_result_block_witness_uncommitted,
+    verify_result_block_witness_unexpected,
+
+    // Batch verification
+    verify_result_cancelled
 } verify_result;
 
 /**
@@ -232,6 +266,559 @@ typedef struct output
 } output;
 typedef std::vector<output> outputs;
 
+/**
+ * The confirmation of a previous output: the height of its block and the
+ * median time past of the block preceding that block.
+ */
+typedef struct confirmation
+{
+    uint32_t height;
+    int64_t median_time_past;
+} confirmation;
+typedef std::vector<confirmation> confirmations;
+
+/**
+ * A transaction hash (txid or wtxid), in internal byte order.
+ */
+typedef std::array<uint8_t, 32> hash_digest;
+typedef std::vector<hash_digest> hash_list;
+
+/**
+ * A previous output, referenced by the hash (in internal byte order) and
+ * output index of its transaction.
+ */
+typedef struct outpoint
+{
+    std::array<uint8_t, 32> hash;
+    uint32_t index;
+} outpoint;
+
+/**
+ * A previous output held by the caller, its script is referenced, not copied.
+ */
+typedef struct output_reference
+{
+    const uint8_t* script;
+    size_t script_size;
+    uint64_t value;
+} output_reference;
+
+/**
+ * A transaction held by the caller and the outputs spent by its inputs, in
+ * order. The transaction and outputs are referenced, not copied.
+ */
+typedef struct transaction_reference
+{
+    const uint8_t* transaction;
+    size_t transaction_size;
+    const output_reference* prevouts;
+    size_t prevouts_size;
+} transaction_reference;
+
+/**
+ * A serialized block held by the caller and the outputs spent by its
+ * non-coinbase inputs, in block order. The block and outputs are referenced,
+ * not copied.
+ */
+typedef struct block_reference
+{
+    const uint8_t* block;
+    size_t block_size;
+    const output_reference* prevouts;
+    size_t prevouts_size;
+} block_reference;
+
+/**
+ * The expected work of verifying a transaction, estimated from its scripts
+ * without evaluating them. Signatures are assumed present for each check.
+ */
+typedef struct transaction_cost
+{
+    /**
+     * Signature checks, one per public key of an accurately counted
+     * multisig, of the scripts evaluated (redeem and witness scripts).
+     */
+    uint64_t signature_checks;
+
+    /**
+     * Bytes hashed to produce the signature hashes. Each legacy signature
+     * hash serializes the whole transaction, so that this grows with the
+     * square of its size.
+     */
+    uint64_t sighash_bytes;
+
+    /**
+     * Validation weight consumed by tapscript signature checks (BIP342).
+     * Taproot spends are estimated as they are validated by the network,
+     * whether or not verification evaluates them.
+     */
+    uint64_t validation_weight;
+} transaction_cost;
+
+/**
+ * Supplies previous outputs as verification requires them, so that they
+ * need not be copied into outputs in advance. Outputs are requested once for
+ * each input, in block order. Referenced scripts must remain valid until the
+ * verification call returns. Exceptions thrown by the provider fail
+ * verification with verify_evaluation_throws.
+ */
+class BCK_API prevout_provider
+{
+public:
+    virtual ~prevout_provider();
+
+    /**
+     * Hint of the outputs that will be requested, in order, so that their
+     * lookup may proceed while earlier inputs are verified. Ignored by default.
+     * @param[in]  outpoints  The outpoints, valid only for the call.
+     * @param[in]  count      The number of outpoints.
+     */
+    virtual void prefetch(const outpoint* outpoints, size_t count);
+
+    /**
+     * Obtain the outputs spent by the inputs of a transaction. Calls get for
+     * each by default. The outputs need only remain valid until the next call.
+     * @param[out] out        The outputs, one for each outpoint.
+     * @param[in]  outpoints  The outpoints of the transaction's inputs.
+     * @param[in]  count      The number of outpoints.
+     * @returns               False if any output is not available.
+     */
+    virtual bool get_batch(output_reference* out, const outpoint* outpoints,
+        size_t count);
+
+    /**
+     * Obtain an output.
+     * @param[out] out    The output.
+     * @param[in]  point  The outpoint of the output.
+     * @returns           False if the output is not available.
+     */
+    virtual bool get(output_reference& out, const outpoint& point) = 0;
+};
+
+/**
+ * Storage retained across verifications, so that a thread verifying many
+ * scripts reuses the capacity of its transaction parse, script copies and
+ * evaluation stacks instead of allocating them for each call. A context is
+ * not thread safe, each verifying thread should keep its own.
+ */
+class BCK_API verification_context
+{
+public:
+    verification_context();
+    ~verification_context();
+
+    verification_context(const verification_context&) = delete;
+    verification_context& operator=(const verification_context&) = delete;
+
+    /**
+     * The retained storage, which is defined only within the library.
+     */
+    struct implementation;
+
+    /**
+     * The number of signatures verified through the context.
+     */
+    uint64_t signature_checks() const noexcept;
+
+private:
+    friend implementation& get_implementation(
+        verification_context& context) noexcept;
+
+    std::unique_ptr<implementation> implementation_;
+};
+
+/**
+ * Settings of a verification pool.
+ */
+typedef struct pool_settings
+{
+    /**
+     * The number of worker threads, zero for one per hardware thread.
+     */
+    size_t threads;
+
+    /**
+     * Processors to pin workers to, in turn, empty for no affinity. Affinity
+     * is applied where the platform supports it.
+     */
+    std::vector<size_t> processors;
+
+    /**
+     * Deal inputs to workers in block order, otherwise in decreasing order of
+     * expected cost (signature checks and signature hash bytes), so that the
+     * most expensive inputs do not start last and extend the batch.
+     */
+    bool in_order;
+
+    /**
+     * Group workers by NUMA node, one node in turn per worker, each pinned to
+     * the processors of its node (in place of processors). A worker's arena
+     * is allocated on its node, and the items of a batch are dealt to the
+     * workers of the node that holds the transactions, stealing from the
+     * same node first. The topology is read where the platform supports it,
+     * otherwise there is a single node.
+     */
+    bool numa;
+
+    /**
+     * Idle workers poll for work rather than block, and the submitter polls
+     * for the completion of its batch, trading processor time for the
+     * latency of waking a thread.
+     */
+    bool spin;
+} pool_settings;
+
+/**
+ * Work counters of a pool worker, cumulative since the pool was started.
+ */
+typedef struct worker_statistics
+{
+    /**
+     * Tasks (transaction parses and input verifications) run.
+     */
+    uint64_t tasks;
+
+    /**
+     * Tasks taken from the deques of other workers.
+     */
+    uint64_t steals;
+
+    /**
+     * Nanoseconds spent waiting for work.
+     */
+    uint64_t idle_nanoseconds;
+} worker_statistics;
+
+/**
+ * The priority classes of pool work. Workers take the inputs of a higher
+ * lane before any of a lower lane, so that block verification preempts
+ * mempool verification at the granularity of an input.
+ */
+typedef enum verify_lane
+{
+    verify_lane_block,
+    verify_lane_mempool,
+    verify_lanes
+} verify_lane;
+
+/**
+ * Work counters of a pool lane, cumulative since the pool was started.
+ */
+typedef struct lane_statistics
+{
+    /**
+     * Batches (transaction parses or input verifications) completed.
+     */
+    uint64_t batches;
+
+    /**
+     * Tasks submitted.
+     */
+    uint64_t tasks;
+
+    /**
+     * Tasks waiting to be run.
+     */
+    uint64_t queued;
+
+    /**
+     * Nanoseconds from the submission to the completion of each batch,
+     * summed and the greatest.
+     */
+    uint64_t latency_nanoseconds;
+    uint64_t max_latency_nanoseconds;
+} lane_statistics;
+
+/**
+ * A flag that stops the batches that share it. Verification checks it
+ * before each input and, if the batch requests it, between opcodes. A token
+ * is thread safe and remains cancelled until reset.
+ */
+class BCK_API cancellation
+{
+public:
+    cancellation() noexcept;
+
+    cancellation(const cancellation&) = delete;
+    cancellation& operator=(const cancellation&) = delete;
+
+    /**
+     * Stop the batches that share the token.
+     */
+    void cancel() noexcept;
+
+    /**
+     * Allow the token to be shared by subsequent batches.
+     */
+    void reset() noexcept;
+
+    bool cancelled() const noexcept;
+
+    /**
+     * The flag, as read by verification.
+     */
+    const std::atomic<bool>& get() const noexcept;
+
+private:
+    std::atomic<bool> cancelled_;
+};
+
+/**
+ * Settings of a batch verification.
+ */
+typedef struct batch_settings
+{
+    /**
+     * A token that stops the batch, optional.
+     */
+    cancellation* cancel;
+
+    /**
+     * Stop the batch at its first failure, cancelling the token if any.
+     */
+    bool fail_fast;
+
+    /**
+     * Check the token between opcodes, so that long scripts stop within
+     * their evaluation, not only before each input.
+     */
+    bool opcodes;
+
+    /**
+     * The priority of the batch.
+     */
+    verify_lane lane;
+} batch_settings;
+
+/**
+ * Threads that verify the inputs of transactions, each with its own deque of
+ * tasks and verification context. A batch is dealt across the deques and a
+ * worker that exhausts its own deque steals from the others, so that workers
+ * left with cheap inputs take over the remaining work of those with costly
+ * ones. Threads submitting work verify alongside the workers. Each deque
+ * holds a queue for each lane, and workers take from the highest lane that
+ * has work after each task. A pool is thread safe and may be shared by any
+ * number of submitting threads.
+ */
+class BCK_API verification_pool
+{
+public:
+    /**
+     * Start a pool of one worker per hardware thread, without affinity.
+     */
+    verification_pool();
+
+    /**
+     * Start a pool of the configured workers. Workers that cannot be started
+     * are omitted, work then proceeds on those that have started.
+     */
+    explicit verification_pool(const pool_settings& settings);
+
+    /**
+     * Stop the workers, once submitted work has completed.
+     */
+    ~verification_pool();
+
+    verification_pool(const verification_pool&) = delete;
+    verification_pool& operator=(const verification_pool&) = delete;
+
+    /**
+     * The workers, which are defined only within the library.
+     */
+    struct implementation;
+
+    /**
+     * The number of started workers.
+     */
+    size_t threads() const noexcept;
+
+    /**
+     * The counters of each worker.
+     */
+    std::vector<worker_statistics> statistics() const;
+
+    /**
+     * The counters of the lane.
+     */
+    lane_statistics statistics(verify_lane lane) const noexcept;
+
+private:
+    friend implementation& get_implementation(
+        verification_pool& pool) noexcept;
+
+    std::unique_ptr<implementation> implementation_;
+};
+
+/**
+ * The pool of the library, of one worker per hardware thread, started on
+ * first use. Batch calls that do not specify a pool dispatch to it.
+ */
+BCK_API verification_pool& default_pool();
+
+/**
+ * Settings of a block pipeline.
+ */
+typedef struct pipeline_settings
+{
+    /**
+     * Threads that parse and check blocks, zero for one.
+     */
+    size_t parse_threads;
+
+    /**
+     * Threads that precompute the signature hashes of blocks, zero for one.
+     */
+    size_t precompute_threads;
+
+    /**
+     * Workers of the pool that verifies the inputs of a block, alongside the
+     * verify stage thread, zero for one per hardware thread.
+     */
+    size_t verify_threads;
+
+    /**
+     * Blocks that may wait for each stage, zero for one.
+     */
+    size_t queue_depth;
+
+    /**
+     * Deal the inputs of each block in block order, otherwise in decreasing
+     * order of expected cost, as pool_settings::in_order.
+     */
+    bool in_order;
+} pipeline_settings;
+
+/**
+ * Work counters of a pipeline stage, cumulative since the pipeline started.
+ * Throughput is items over busy time. A stage that is often blocked is
+ * faster than its successor, one that is often starved is slower than its
+ * predecessor.
+ */
+typedef struct stage_statistics
+{
+    /**
+     * Blocks that have left the stage.
+     */
+    uint64_t blocks;
+
+    /**
+     * Transactions (parse and precompute) or inputs (verify) processed.
+     */
+    uint64_t items;
+
+    /**
+     * Nanoseconds of the stage's threads spent processing blocks.
+     */
+    uint64_t busy_nanoseconds;
+
+    /**
+     * Nanoseconds of the stage's threads spent waiting for a block.
+     */
+    uint64_t starved_nanoseconds;
+
+    /**
+     * Nanoseconds of the stage's threads spent waiting for the next stage to
+     * accept a block (backpressure).
+     */
+    uint64_t blocked_nanoseconds;
+
+    /**
+     * Blocks waiting for the stage.
+     */
+    size_t queued;
+} stage_statistics;
+
+/**
+ * Work counters of a pipeline and its stages.
+ */
+typedef struct pipeline_statistics
+{
+    stage_statistics parse;
+    stage_statistics precompute;
+    stage_statistics verify;
+
+    /**
+     * Nanoseconds that submit waited for the parse stage to accept a block.
+     */
+    uint64_t submit_blocked_nanoseconds;
+
+    /**
+     * Signatures verified in the inputs of blocks that have left the verify
+     * stage.
+     */
+    uint64_t signature_checks;
+
+    /**
+     * Calls to the completion handler that threw. The exceptions are caught
+     * and the blocks counted as completed, so that drain returns.
+     */
+    uint64_t handler_exceptions;
+} pipeline_statistics;
+
+/**
+ * Verifies blocks in three stages connected by bounded queues: blocks are
+ * parsed and checked, then their signature hashes are precomputed, then
+ * their inputs are verified on a pool. While a block is verified its
+ * successors are parsed and precomputed. Each block's result is as that of
+ * verify_block, the first failure in block order.
+ */
+class BCK_API block_pipeline
+{
+public:
+    /**
+     * Receives the sequence of each block, as returned by submit, and its
+     * result. Called on the verify stage thread, in verification order,
+     * which is that of submission if the parse and precompute stages have
+     * one thread each. The handler should not throw and must not block on
+     * drain. An exception thrown by the handler is caught and counted in
+     * the statistics' handler_exceptions, and the block is still completed.
+     */
+    typedef std::function<void(uint64_t sequence, verify_result result)>
+        handler;
+
+    /**
+     * Start the stages.
+     * @throws  std::system_error if a stage thread cannot be started.
+     */
+    block_pipeline(const pipeline_settings& settings, handler complete);
+
+    /**
+     * Stop the stages, once submitted blocks have completed.
+     */
+    ~block_pipeline();
+
+    block_pipeline(const block_pipeline&) = delete;
+    block_pipeline& operator=(const block_pipeline&) = delete;
+
+    /**
+     * Submit a block for verification, waiting while the parse stage's queue
+     * is full. The referenced data must not be modified or released until
+     * the block's result is handled. Thread safe.
+     * @param[in]  block  The block and the outputs that it spends.
+     * @param[in]  flags  Verification constraint flags.
+     * @returns           The sequence of the block, from zero.
+     */
+    uint64_t submit(const block_reference& block, uint32_t flags);
+
+    /**
+     * Wait until all submitted blocks have been handled.
+     */
+    void drain();
+
+    /**
+     * The counters of the pipeline.
+     */
+    pipeline_statistics statistics() const;
+
+    /**
+     * The stages, which are defined only within the library.
+     */
+    struct implementation;
+
+private:
+    std::unique_ptr<implementation> implementation_;
+};
+
 // TODO: this is ready for test.
 #ifdef UNTESTED
 /**
@@ -259,6 +846,14 @@ BCK_API verify_result verify_script(const chunk& transaction,
  BCK_API verify_result verify_script(const chunk& transaction,
     const output& prevout, uint32_t input_index, uint32_t flags) noexcept;
 
+/**
+ * As verify_script, reusing the storage of the context.
+ * @param[in]  context      The calling thread's verification context.
+ */
+BCK_API verify_result verify_script(verification_context& context,
+    const chunk& transaction, const output& prevout, uint32_t input_index,
+    uint32_t flags) noexcept;
+
  /**
  * Verify that the unsigned input correctly spends the previous output,
  * considering any additional constraints specified by flags. This is useful
@@ -272,6 +867,296 @@ BCK_API verify_result verify_script(const chunk& transaction,
  BCK_API verify_result verify_unsigned_script(const output& prevout,
      const chunk& input_script, const stack& witness, uint32_t flags) noexcept;
 
+/**
+ * As verify_unsigned_script, reusing the storage of the context.
+ * @param[in]  context       The calling thread's verification context.
+ */
+BCK_API verify_result verify_unsigned_script(verification_context& context,
+    const output& prevout, const chunk& input_script, const stack& witness,
+    uint32_t flags) noexcept;
+
+/**
+ * As verify_script, the transaction and previous output being referenced in
+ * place rather than copied.
+ * @param[in]  transaction       The serialized transaction.
+ * @param[in]  transaction_size  The size of the serialized transaction.
+ */
+BCK_API verify_result verify_script(const uint8_t* transaction,
+    size_t transaction_size, const output_reference& prevout,
+    uint32_t input_index, uint32_t flags) noexcept;
+
+/**
+ * As verify_script with a referenced transaction, reusing the storage of the
+ * context.
+ * @param[in]  context      The calling thread's verification context.
+ */
+BCK_API verify_result verify_script(verification_context& context,
+    const uint8_t* transaction, size_t transaction_size,
+    const output_reference& prevout, uint32_t input_index,
+    uint32_t flags) noexcept;
+
+/**
+ * Verify that all inputs of the transaction correctly spend the corresponding
+ * previous outputs, considering any additional constraints specified by flags.
+ * The transaction is parsed once and the signature hashes of its inputs share
+ * its precomputed hashes. The inputs are verified in parallel on the default
+ * pool, the calling thread verifying alongside its workers. The first
+ * failure is returned.
+ * @param[in]  transaction  The transaction and the outputs that it spends.
+ * @param[in]  flags        Verification constraint flags.
+ * @returns                 A script verification result code.
+ */
+BCK_API verify_result verify_transaction(
+    const transaction_reference& transaction, uint32_t flags) noexcept;
+
+/**
+ * As verify_transaction, on the calling thread alone, reusing the storage of
+ * the context.
+ * @param[in]  context      The calling thread's verification context.
+ */
+BCK_API verify_result verify_transaction(verification_context& context,
+    const transaction_reference& transaction, uint32_t flags) noexcept;
+
+/**
+ * As verify_transaction, with the inputs of the transaction verified in
+ * parallel on the pool. The calling thread verifies alongside the workers.
+ * @param[in]  pool         The pool to verify on.
+ */
+BCK_API verify_result verify_transaction(verification_pool& pool,
+    const transaction_reference& transaction, uint32_t flags) noexcept;
+
+/**
+ * Verify each of the transactions as verify_transaction, with all of their
+ * inputs verified in parallel on the pool. The calling thread verifies
+ * alongside the workers and the call returns once all transactions are
+ * verified. The referenced data must not be modified during the call.
+ * @param[in]  pool          The pool to verify on.
+ * @param[out] results       Receives the result for each transaction.
+ * @param[in]  transactions  The transactions and the outputs that they spend.
+ * @param[in]  count         The number of transactions.
+ * @param[in]  flags         Verification constraint flags.
+ * @returns                  The result of the first transaction that fails,
+ *                           or verify_result_eval_true if none fail.
+ */
+BCK_API verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, const transaction_reference* transactions,
+    size_t count, uint32_t flags) noexcept;
+
+/**
+ * As verify_transactions on a pool, stopped by cancellation or, if fail
+ * fast, by the first failure. Transactions that are stopped before their
+ * verification completes, without a failure, result in
+ * verify_result_cancelled. The failure found first in time is then not
+ * necessarily the first in order.
+ * @param[in]  settings      The cancellation of the batch.
+ * @returns                  The result of the first transaction that fails,
+ *                           else verify_result_cancelled if any is stopped,
+ *                           else verify_result_eval_true.
+ */
+BCK_API verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, const transaction_reference* transactions,
+    size_t count, uint32_t flags, const batch_settings& settings) noexcept;
+
+/**
+ * As verify_transactions on a pool.
+ * @param[in]  threads       One to verify on the calling thread alone,
+ *                           otherwise the default pool is used.
+ */
+BCK_API verify_result verify_transactions(verify_result* results,
+    const transaction_reference* transactions, size_t count, uint32_t flags,
+    size_t threads) noexcept;
+
+/**
+ * Verify that all inputs of the serialized block correctly spend the
+ * corresponding previous outputs, considering any additional constraints
+ * specified by flags. Transactions are parsed and checked in place, then
+ * their inputs are verified in parallel on the default pool, the calling
+ * thread verifying alongside its workers. The first failure in block order
+ * is returned. The header and coinbase input are not validated.
+ * @param[in]  block     The serialized block (header, tx count, transactions).
+ * @param[in]  prevouts  The outputs spent by the block's non-coinbase inputs,
+ *                       in block order.
+ * @param[in]  flags     Verification constraint flags.
+ * @returns              A script verification result code.
+ */
+BCK_API verify_result verify_block(const chunk& block, const outputs& prevouts,
+    uint32_t flags) noexcept;
+
+/**
+ * As verify_block, with the block and its spent outputs referenced, not
+ * copied. The referenced data must not be modified during the call.
+ * @param[in]  block     The block and the outputs that it spends.
+ */
+BCK_API verify_result verify_block(const block_reference& block,
+    uint32_t flags) noexcept;
+
+/**
+ * As verify_block with a referenced block, verified on the pool.
+ * @param[in]  pool      The pool to verify on.
+ */
+BCK_API verify_result verify_block(verification_pool& pool,
+    const block_reference& block, uint32_t flags) noexcept;
+
+/**
+ * As verify_block, on the calling thread alone, with transactions verified
+ * as they are read from the block and reusing the storage of the context.
+ * @param[in]  context   The calling thread's verification context.
+ */
+BCK_API verify_result verify_block(verification_context& context,
+    const chunk& block, const outputs& prevouts, uint32_t flags) noexcept;
+
+/**
+ * As verify_block with a referenced block, on the calling thread alone,
+ * reusing the storage of the context. The block is verified in place.
+ * @param[in]  context   The calling thread's verification context.
+ */
+BCK_API verify_result verify_block(verification_context& context,
+    const block_reference& block, uint32_t flags) noexcept;
+
+/**
+ * As verify_block, obtaining the spent outputs from the provider. All of the
+ * block's outpoints are passed to prefetch before verification begins, then
+ * the outputs of each transaction are obtained by get_batch as it is reached.
+ * Unlike other verify_block overloads this verifies on the calling thread
+ * alone: the provider's lookups overlap the verification of earlier
+ * transactions, and its outputs need not remain valid beyond the next
+ * get_batch, whereas the pool requires all of them at once. To verify a
+ * provided block on a pool, obtain its outputs and pass a block_reference.
+ * @param[in]  provider  The source of the outputs spent by the block.
+ */
+BCK_API verify_result verify_block(const chunk& block,
+    prevout_provider& provider, uint32_t flags) noexcept;
+
+/**
+ * As verify_block with a provider, reusing the storage of the context.
+ * @param[in]  context   The calling thread's verification context.
+ */
+BCK_API verify_result verify_block(verification_context& context,
+    const chunk& block, prevout_provider& provider, uint32_t flags) noexcept;
+
+/**
+ * Extract the outpoints spent by a serialized transaction, so that their
+ * lookup may begin before it is verified. Scripts are skipped and nothing
+ * beyond the inputs is read, so success does not imply that the transaction
+ * is valid. Does not allocate.
+ * @param[out] out          Receives the outpoints of up to capacity inputs.
+ * @param[in]  capacity     The number of outpoints that out can hold.
+ * @param[out] inputs       The number of inputs, which may exceed capacity.
+ * @param[out] witness      True if the transaction is witness serialized.
+ * @param[in]  transaction  The serialized transaction.
+ * @returns                 False if the inputs do not deserialize.
+ */
+BCK_API bool extract_outpoints(outpoint* out, size_t capacity, size_t& inputs,
+    bool& witness, const chunk& transaction) noexcept;
+
+/**
+ * Check the rules of the transaction that do not depend on its context:
+ * inputs and outputs are present, its size and output values are within
+ * limits, no input is duplicated, and the coinbase script size is valid.
+ * This is cheap relative to script verification, which it may precede.
+ * verify_block applies it to each transaction of the block.
+ * @param[in]  transaction  The transaction to check.
+ * @returns                 A transaction check result code.
+ */
+BCK_API verify_result check_transaction(const chunk& transaction) noexcept;
+
+/**
+ * As check_transaction, reusing the storage of the context.
+ * @param[in]  context      The calling thread's verification context.
+ */
+BCK_API verify_result check_transaction(verification_context& context,
+    const chunk& transaction) noexcept;
+
+/**
+ * Check that the transaction is final in a block (its lock time is satisfied
+ * or disabled) and, if flags include verify_flags_checksequenceverify, that
+ * its relative lock times (BIP68) are satisfied.
+ * @param[in]  transaction    The transaction to check.
+ * @param[in]  confirmed      The confirmation of the output spent by each
+ *                            input, in order, required only for BIP68.
+ * @param[in]  height         The height of the block.
+ * @param[in]  time           The lock time cutoff of the block, the median
+ *                            time past of its predecessor once BIP113 is
+ *                            active (as it is with BIP68), else its time.
+ * @param[in]  flags          Verification constraint flags.
+ * @returns                   A transaction check result code.
+ */
+BCK_API verify_result check_locks(const chunk& transaction,
+    const confirmations& confirmed, uint32_t height, int64_t time,
+    uint32_t flags) noexcept;
+
+/**
+ * As check_locks, reusing the storage of the context.
+ * @param[in]  context        The calling thread's verification context.
+ */
+BCK_API verify_result check_locks(verification_context& context,
+    const chunk& transaction, const confirmations& confirmed,
+    uint32_t height, int64_t time, uint32_t flags) noexcept;
+
+/**
+ * Estimate the cost of verifying the transaction, without verifying it, so
+ * that expensive transactions may be deprioritized before they are verified.
+ * @param[out] out          The estimated cost.
+ * @param[in]  transaction  The transaction and the outputs it spends.
+ * @param[in]  flags        Verification constraint flags.
+ * @returns                 verify_result_eval_true, or a transaction parse
+ *                          or input count failure.
+ */
+BCK_API verify_result estimate_cost(transaction_cost& out,
+    const transaction_reference& transaction, uint32_t flags) noexcept;
+
+/**
+ * As estimate_cost, reusing the storage of the context.
+ * @param[in]  context      The calling thread's verification context.
+ */
+BCK_API verify_result estimate_cost(verification_context& context,
+    transaction_cost& out, const transaction_reference& transaction,
+    uint32_t flags) noexcept;
+
+/**
+ * Compute the merkle root of the hashes. Each level of the tree is hashed in
+ * a single pass of the widest available multi-way double-SHA256 transform
+ * (SHA-NI 2-way, AVX2 8-way or SSE4.1 4-way, as detected at load).
+ * @param[out] out      The merkle root.
+ * @param[out] mutated  True if any level has identical adjacent hashes, so
+ *                      that another list of hashes has the same root
+ *                      (CVE-2012-2459).
+ * @param[in]  hashes   The txids (or wtxids) of a block's transactions.
+ * @returns             False if hashes is empty.
+ */
+BCK_API bool merkle_root(hash_digest& out, bool& mutated,
+    const hash_list& hashes) noexcept;
+
+/**
+ * Verify the witness commitment (BIP141) of a block's coinbase against the
+ * witness merkle root of the block.
+ * @param[in]  coinbase  The block's coinbase transaction.
+ * @param[in]  wtxids    The wtxids of the block's transactions, in order. The
+ *                       first is ignored, that of the coinbase being null.
+ * @returns              A block merkle result code, witness_uncommitted if
+ *                       the coinbase has no commitment.
+ */
+BCK_API verify_result verify_witness_commitment(const chunk& coinbase,
+    const hash_list& wtxids) noexcept;
+
+/**
+ * Verify the merkle root of the serialized block's header against its
+ * transactions and, if flags include verify_flags_witness, the witness
+ * commitment of its coinbase (a block without one may not have witnesses).
+ * Transaction hashes are computed as the block is parsed in place.
+ * @param[in]  block     The serialized block (header, tx count, transactions).
+ * @param[in]  flags     Verification constraint flags.
+ * @returns              A block merkle result code.
+ */
+BCK_API verify_result verify_merkle(const chunk& block, uint32_t flags) noexcept;
+
+/**
+ * As verify_merkle, reusing the storage of the context.
+ * @param[in]  context   The calling thread's verification context.
+ */
+BCK_API verify_result verify_merkle(verification_context& context,
+    const chunk& block, uint32_t flags) noexcept;
+
 } // namespace consensus
 } // namespace libbitcoin
 
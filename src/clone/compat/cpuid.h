@@ -20,5 +20,20 @@ void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32
 #endif
 }
 
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define HAVE_GETCPUID
+
+#include <intrin.h>
+
+void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
+{
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    a = info[0];
+    b = info[1];
+    c = info[2];
+    d = info[3];
+}
+
 #endif // defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
 #endif // BITCOIN_COMPAT_CPUID_H
@@ -0,0 +1,192 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/cost.h>
+
+#include <primitives/transaction_view.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+
+namespace {
+
+bool GetOp(const unsigned char*& pc, const unsigned char* end, opcodetype& opcode, Span<const unsigned char>* data)
+{
+    CScriptBase::const_iterator it(pc);
+    const auto result = GetScriptOp(it, CScriptBase::const_iterator(end), opcode, data);
+    pc = &*it;
+    return result;
+}
+
+/** The last push of a push-only script, as the P2SH redeem script. */
+bool GetLastPush(Span<const unsigned char> script, Span<const unsigned char>& out)
+{
+    const unsigned char* pc = script.data();
+    const unsigned char* const end = script.data() + script.size();
+    out = {};
+
+    while (pc < end) {
+        opcodetype opcode;
+        if (!GetOp(pc, end, opcode, &out) || opcode > OP_16)
+            return false;
+    }
+
+    return true;
+}
+
+bool IsPayToScriptHash(Span<const unsigned char> script)
+{
+    return script.size() == 23 && script[0] == OP_HASH160 &&
+        script[1] == 0x14 && script[22] == OP_EQUAL;
+}
+
+bool IsWitnessProgram(Span<const unsigned char> script, int& version, Span<const unsigned char>& program)
+{
+    if (script.size() < 4 || script.size() > 42)
+        return false;
+    if (script[0] != OP_0 && (script[0] < OP_1 || script[0] > OP_16))
+        return false;
+    if (size_t(script[1] + 2) != script.size())
+        return false;
+
+    version = CScript::DecodeOP_N(opcodetype(script[0]));
+    program = script.subspan(2);
+    return true;
+}
+
+/** Tapscript signature checks, those of CHECKSIG(VERIFY) and CHECKSIGADD. */
+unsigned int GetTapscriptSigOpCount(Span<const unsigned char> script)
+{
+    unsigned int n = 0;
+    const unsigned char* pc = script.data();
+    const unsigned char* const end = script.data() + script.size();
+
+    while (pc < end) {
+        opcodetype opcode;
+        if (!GetOp(pc, end, opcode, nullptr))
+            break;
+        if (opcode == OP_CHECKSIG || opcode == OP_CHECKSIGVERIFY || opcode == OP_CHECKSIGADD)
+            n++;
+    }
+
+    return n;
+}
+
+/** The cost of a witness program spend, as WitnessSigOps with script paths. */
+void AddWitnessCost(InputCost& cost, int version, Span<const unsigned char> program, const CWitnessView& witness)
+{
+    // The last two stack items (the witness or leaf script and the control
+    // block), the annex excluded.
+    Span<const unsigned char> last, second;
+    size_t items = 0;
+    for (const auto item : witness) {
+        second = last;
+        last = item;
+        items++;
+    }
+
+    if (version == 0) {
+        if (program.size() == WITNESS_V0_KEYHASH_SIZE) {
+            cost.sigops += 1;
+            cost.sighash_bytes += WITNESS_V0_SIGHASH_BYTES + 25;
+            cost.script_bytes += 25;
+        } else if (program.size() == WITNESS_V0_SCRIPTHASH_SIZE && items > 0) {
+            const uint64_t sigops = GetSigOpCount(last, true);
+            cost.sigops += sigops;
+            cost.sighash_bytes += sigops * (WITNESS_V0_SIGHASH_BYTES + last.size());
+            cost.script_bytes += last.size();
+        }
+    } else if (version == 1 && program.size() == WITNESS_V1_TAPROOT_SIZE) {
+        if (items >= 2 && !last.empty() && last[0] == ANNEX_TAG) {
+            last = second;
+            items--;
+        }
+
+        if (items == 1) {
+            cost.sigops += 1;
+            cost.sighash_bytes += TAPROOT_SIGHASH_BYTES;
+        } else if (items >= 2) {
+            // The leaf script precedes the control block, an annex aside.
+            size_t position = 0;
+            Span<const unsigned char> leaf;
+            for (const auto item : witness) {
+                if (position++ == items - 2) {
+                    leaf = item;
+                    break;
+                }
+            }
+
+            // Only tapscript leaves are defined, others succeed unevaluated.
+            if (last.empty() || (last[0] & TAPROOT_LEAF_MASK) != TAPROOT_LEAF_TAPSCRIPT)
+                return;
+
+            const uint64_t sigops = GetTapscriptSigOpCount(leaf);
+            cost.sigops += sigops;
+            cost.sighash_bytes += sigops * TAPROOT_SIGHASH_BYTES;
+            cost.script_bytes += leaf.size() + last.size();
+            cost.validation_weight += sigops * VALIDATION_WEIGHT_PER_SIGOP_PASSED;
+        }
+    }
+}
+
+} // namespace
+
+unsigned int GetSigOpCount(Span<const unsigned char> script, bool accurate)
+{
+    unsigned int n = 0;
+    const unsigned char* pc = script.data();
+    const unsigned char* const end = script.data() + script.size();
+    opcodetype lastOpcode = OP_INVALIDOPCODE;
+
+    while (pc < end) {
+        opcodetype opcode;
+        if (!GetOp(pc, end, opcode, nullptr))
+            break;
+        if (opcode == OP_CHECKSIG || opcode == OP_CHECKSIGVERIFY)
+            n++;
+        else if (opcode == OP_CHECKMULTISIG || opcode == OP_CHECKMULTISIGVERIFY) {
+            if (accurate && lastOpcode >= OP_1 && lastOpcode <= OP_16)
+                n += CScript::DecodeOP_N(lastOpcode);
+            else
+                n += MAX_PUBKEYS_PER_MULTISIG;
+        }
+        lastOpcode = opcode;
+    }
+
+    return n;
+}
+
+InputCost GetInputCost(const CTransactionView& tx, unsigned int input, Span<const unsigned char> script_pubkey, unsigned int flags)
+{
+    InputCost cost;
+    const auto in = tx.vin[input];
+    const bool witness = (flags & SCRIPT_VERIFY_WITNESS) != 0;
+    int version;
+    Span<const unsigned char> program;
+
+    // A native witness program evaluates no legacy script.
+    if (witness && IsWitnessProgram(script_pubkey, version, program)) {
+        AddWitnessCost(cost, version, program, in.scriptWitness);
+        return cost;
+    }
+
+    // The legacy script evaluated for signatures, the redeem script of P2SH.
+    Span<const unsigned char> script = script_pubkey;
+    Span<const unsigned char> redeem;
+    if ((flags & SCRIPT_VERIFY_P2SH) != 0 && IsPayToScriptHash(script_pubkey) && GetLastPush(in.scriptSig, redeem)) {
+        if (witness && IsWitnessProgram(redeem, version, program)) {
+            cost.script_bytes += in.scriptSig.size() + script_pubkey.size();
+            AddWitnessCost(cost, version, program, in.scriptWitness);
+            return cost;
+        }
+        script = redeem;
+    }
+
+    // Each legacy signature hash serializes the transaction, without
+    // witnesses, with the scriptCode in place of the input's scriptSig.
+    const uint64_t sigops = GetSigOpCount(script, true);
+    cost.sigops = sigops;
+    cost.sighash_bytes = sigops * (tx.GetStrippedSize() - in.scriptSig.size() + script.size());
+    cost.script_bytes = in.scriptSig.size() + script_pubkey.size() + (script.data() == script_pubkey.data() ? 0 : script.size());
+    return cost;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CONSENSUS_COST_H
+#define BITCOIN_CONSENSUS_COST_H
+
+#include <span.h>
+
+#include <cstddef>
+#include <cstdint>
+
+class CTransactionView;
+
+/**
+ * The cost of a signature check, in bytes of double-SHA256 of comparable
+ * time, so that signature checks and signature hashing share a unit.
+ */
+static constexpr uint64_t SIGNATURE_CHECK_COST{16384};
+
+/** The BIP143 signature hash preimage, excluding its scriptCode. */
+static constexpr uint64_t WITNESS_V0_SIGHASH_BYTES{156};
+
+/** The largest BIP341 signature hash preimage, for a script path spend. */
+static constexpr uint64_t TAPROOT_SIGHASH_BYTES{206};
+
+/** The expected work of verifying an input, estimated without evaluating it. */
+struct InputCost
+{
+    //! Signature checks, as counted by GetSigOpCount(true) for the script
+    //! that is evaluated, or one per public key of a CHECKMULTISIG.
+    uint64_t sigops = 0;
+
+    //! Bytes hashed for the signature hashes of the input's signature
+    //! checks. Legacy hashing serializes the transaction for each signature,
+    //! so that these are quadratic in transaction size.
+    uint64_t sighash_bytes = 0;
+
+    //! Bytes of the scripts evaluated.
+    uint64_t script_bytes = 0;
+
+    //! Validation weight consumed by the signature checks of a tapscript,
+    //! against its budget of VALIDATION_WEIGHT_OFFSET plus the witness size.
+    uint64_t validation_weight = 0;
+
+    /** A single measure for ordering inputs by expected verification time. */
+    uint64_t Units() const noexcept
+    {
+        return sigops * SIGNATURE_CHECK_COST + sighash_bytes + script_bytes;
+    }
+};
+
+/** CScript::GetSigOpCount over the script, read in place. */
+unsigned int GetSigOpCount(Span<const unsigned char> script, bool accurate);
+
+/**
+ * Estimate the cost of verifying the input against the script of the output
+ * that it spends, under the script verification flags. Scripts are read in
+ * place, the estimate does not allocate.
+ */
+InputCost GetInputCost(const CTransactionView& tx, unsigned int input,
+    Span<const unsigned char> script_pubkey, unsigned int flags);
+
+#endif // BITCOIN_CONSENSUS_COST_H
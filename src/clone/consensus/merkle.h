@@ -0,0 +1,35 @@
+// Copyright (c) 2015-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CONSENSUS_MERKLE_H
+#define BITCOIN_CONSENSUS_MERKLE_H
+
+#include <uint256.h>
+
+#include <vector>
+
+class CTransactionView;
+
+/**
+ * Compute the merkle root of the hashes, which are overwritten by the levels
+ * of the tree (so that a retained vector does not reallocate). Each level is
+ * hashed by a single SHA256D64 call, in the widest available multi-way
+ * transform. If mutated is provided it is set if any level has identical
+ * adjacent hashes (CVE-2012-2459).
+ */
+uint256 ComputeMerkleRoot(std::vector<uint256>& hashes, bool* mutated = nullptr);
+
+/** The witness commitment output of a coinbase, see BIP 141. */
+static constexpr size_t MINIMUM_WITNESS_COMMITMENT{38};
+
+/** Index marker for when no witness commitment is present in a coinbase transaction. */
+static constexpr int NO_WITNESS_COMMITMENT{-1};
+
+/**
+ * Compute at which vout of the coinbase transaction the witness commitment
+ * occurs, or NO_WITNESS_COMMITMENT if not found.
+ */
+int GetWitnessCommitmentIndex(const CTransactionView& coinbase);
+
+#endif // BITCOIN_CONSENSUS_MERKLE_H
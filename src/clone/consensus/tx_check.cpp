@@ -0,0 +1,120 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/tx_check.h>
+
+#include <amount.h>
+#include <consensus/consensus.h>
+#include <crypto/common.h>
+#include <primitives/transaction_view.h>
+
+#include <random>
+
+namespace {
+
+uint64_t RandomSalt()
+{
+    std::random_device device;
+    return (uint64_t{device()} << 32) | device();
+}
+
+// Drawn once, as sets are constructed for each block verified.
+uint64_t ProcessSalt()
+{
+    static const uint64_t salt = RandomSalt();
+    return salt;
+}
+
+} // namespace
+
+OutpointSet::OutpointSet() : m_salt(ProcessSalt())
+{
+}
+
+void OutpointSet::Reset(size_t count)
+{
+    // At most half full, so that probe sequences remain short.
+    size_t slots = 16;
+    while (slots < 2 * count)
+        slots *= 2;
+
+    m_outpoints.clear();
+    m_outpoints.reserve(count);
+    m_slots.assign(slots, 0);
+}
+
+size_t OutpointSet::Hash(const COutPoint& outpoint) const noexcept
+{
+    uint64_t hash = m_salt ^ outpoint.n;
+    for (size_t word = 0; word < sizeof(uint256) / sizeof(uint64_t); ++word) {
+        hash = (hash ^ ReadLE64(outpoint.hash.begin() + word * sizeof(uint64_t))) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool OutpointSet::Insert(const COutPoint& outpoint)
+{
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = Hash(outpoint) & mask;; slot = (slot + 1) & mask) {
+        if (m_slots[slot] == 0) {
+            m_outpoints.push_back(outpoint);
+            m_slots[slot] = static_cast<uint32_t>(m_outpoints.size());
+            return true;
+        }
+        if (m_outpoints[m_slots[slot] - 1] == outpoint)
+            return false;
+    }
+}
+
+TxCheckResult CheckTransaction(const CTransactionView& tx, OutpointSet& outpoints)
+{
+    // Basic checks that don't depend on any context
+    if (tx.vin.empty())
+        return TxCheckResult::VIN_EMPTY;
+    if (tx.vout.empty())
+        return TxCheckResult::VOUT_EMPTY;
+    // Size limits (this doesn't take the witness into account, as that hasn't been checked for malleability)
+    if (tx.GetStrippedSize() * WITNESS_SCALE_FACTOR > MAX_BLOCK_WEIGHT)
+        return TxCheckResult::OVERSIZE;
+
+    // Check for negative or overflow output values (see CVE-2010-5139)
+    CAmount nValueOut = 0;
+    for (const auto txout : tx.vout)
+    {
+        if (txout.nValue < 0)
+            return TxCheckResult::VOUT_NEGATIVE;
+        if (txout.nValue > MAX_MONEY)
+            return TxCheckResult::VOUT_TOOLARGE;
+        nValueOut += txout.nValue;
+        if (!MoneyRange(nValueOut))
+            return TxCheckResult::TXOUTTOTAL_TOOLARGE;
+    }
+
+    // Check for duplicate inputs (see CVE-2018-17144)
+    // While Consensus::CheckTxInputs does check if all inputs of a tx are available, and UpdateCoins marks all inputs
+    // of a tx as spent, it does not check if the tx has duplicate inputs.
+    // Failure to run this check will result in either a crash or an inflation bug, depending on the implementation of
+    // the underlying coins database.
+    outpoints.Reset(tx.vin.size());
+    for (const auto txin : tx.vin) {
+        if (!outpoints.Insert(txin.prevout))
+            return TxCheckResult::INPUTS_DUPLICATE;
+    }
+
+    if (tx.IsCoinBase())
+    {
+        const auto script_size = tx.vin[0].scriptSig.size();
+        if (script_size < 2 || script_size > 100)
+            return TxCheckResult::CB_LENGTH;
+    }
+    else
+    {
+        for (const auto txin : tx.vin)
+            if (txin.prevout.IsNull())
+                return TxCheckResult::PREVOUT_NULL;
+    }
+
+    return TxCheckResult::OK;
+}
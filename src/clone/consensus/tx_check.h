@@ -0,0 +1,72 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CONSENSUS_TX_CHECK_H
+#define BITCOIN_CONSENSUS_TX_CHECK_H
+
+/**
+ * Context-independent transaction checking code that can be called outside the
+ * bitcoin server and doesn't depend on chain or mempool state. Transaction
+ * verification code that does call server functions or depend on server state
+ * belongs in tx_verify.h/cpp instead.
+ */
+
+#include <primitives/transaction.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CTransactionView;
+
+/** The context-free rule failed by a transaction, named by its reject reason. */
+enum class TxCheckResult
+{
+    OK,
+    VIN_EMPTY,              //!< bad-txns-vin-empty
+    VOUT_EMPTY,             //!< bad-txns-vout-empty
+    OVERSIZE,               //!< bad-txns-oversize
+    VOUT_NEGATIVE,          //!< bad-txns-vout-negative
+    VOUT_TOOLARGE,          //!< bad-txns-vout-toolarge
+    TXOUTTOTAL_TOOLARGE,    //!< bad-txns-txouttotal-toolarge
+    INPUTS_DUPLICATE,       //!< bad-txns-inputs-duplicate
+    CB_LENGTH,              //!< bad-cb-length
+    PREVOUT_NULL,           //!< bad-txns-prevout-null
+};
+
+/**
+ * A set of the outpoints spent by a transaction, for duplicate detection.
+ *
+ * Outpoints are open addressed in a table whose capacity is retained, so that
+ * once sized for the largest transaction checked the set does not allocate.
+ * Hashing is salted with a random value drawn once per process and shared by
+ * every set, so that colliding outpoints cannot be chosen in advance to
+ * degrade lookups.
+ */
+class OutpointSet
+{
+public:
+    OutpointSet();
+
+    /** Empty the set, sized to hold count outpoints. */
+    void Reset(size_t count);
+
+    /** Insert the outpoint, returning false if it is already present. */
+    bool Insert(const COutPoint& outpoint);
+
+private:
+    size_t Hash(const COutPoint& outpoint) const noexcept;
+
+    const uint64_t m_salt;
+    std::vector<COutPoint> m_outpoints;
+    std::vector<uint32_t> m_slots;  //!< Index of an outpoint plus one, or zero if empty.
+};
+
+/**
+ * Check the rules of a transaction that do not depend on its context (as
+ * CheckTransaction of Bitcoin Core), using outpoints to detect duplicates.
+ */
+TxCheckResult CheckTransaction(const CTransactionView& tx, OutpointSet& outpoints);
+
+#endif // BITCOIN_CONSENSUS_TX_CHECK_H
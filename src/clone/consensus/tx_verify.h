@@ -0,0 +1,46 @@
+// Copyright (c) 2017-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CONSENSUS_TX_VERIFY_H
+#define BITCOIN_CONSENSUS_TX_VERIFY_H
+
+#include <span.h>
+
+#include <stdint.h>
+#include <utility>
+
+class CTransactionView;
+
+/**
+ * The confirmation of an output spent by a transaction. This takes the place
+ * of the block index, from which Bitcoin Core obtains the same values.
+ */
+struct CoinConfirmation
+{
+    int nHeight;                //!< Height of the block that confirmed the output.
+    int64_t nMedianTimePast;    //!< Median time past of the block preceding that block.
+};
+
+/** Transaction validation functions */
+
+/**
+ * Check if transaction is final and can be included in a block with the
+ * specified height and time. Consensus critical.
+ */
+bool IsFinalTx(const CTransactionView& tx, int nBlockHeight, int64_t nBlockTime);
+
+/**
+ * Calculates the block height and previous block's median time past at
+ * which the transaction will be considered final in the context of BIP 68.
+ * Here coins provides the confirmation of the output spent by each input.
+ */
+std::pair<int, int64_t> CalculateSequenceLocks(const CTransactionView& tx, int flags, Span<const CoinConfirmation> coins);
+
+/**
+ * Check if the sequence locks are satisfied in a block of the given height,
+ * whose predecessor has the given median time past.
+ */
+bool EvaluateSequenceLocks(int nBlockHeight, int64_t nMedianTimePast, std::pair<int, int64_t> lockPair);
+
+#endif // BITCOIN_CONSENSUS_TX_VERIFY_H
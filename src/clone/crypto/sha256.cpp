@@ -547,13 +547,17 @@ bool SelfTest() {
     return true;
 }
 
-#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+#if defined(HAVE_GETCPUID)
 /** Check whether the OS has enabled AVX registers. */
 bool AVXEnabled()
 {
+#if defined(_MSC_VER)
+    return (_xgetbv(0) & 6) == 6;
+#else
     uint32_t a, d;
     __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
     return (a & 6) == 6;
+#endif
 }
 #endif
 } // namespace
@@ -562,7 +566,7 @@ bool AVXEnabled()
 std::string SHA256AutoDetect()
 {
     std::string ret = "standard";
-#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+#if defined(HAVE_GETCPUID)
     bool have_sse4 = false;
     bool have_xsave = false;
     bool have_avx = false;
@@ -604,7 +608,7 @@ std::string SHA256AutoDetect()
 #endif
 
     if (have_sse4) {
-#if defined(__x86_64__) || defined(__amd64__)
+#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__))
         Transform = sha256_sse4::Transform;
         TransformD64 = TransformD64Wrapper<sha256_sse4::Transform>;
         ret = "sse4(1way)";
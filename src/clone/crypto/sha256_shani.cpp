@@ -0,0 +1,198 @@
+// Copyright (c) 2018-2019 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// Based on https://github.com/noloader/SHA-Intrinsics/blob/master/sha256-x86.c,
+// Written and placed in public domain by Jeffrey Walton.
+// Based on code from Intel, and by Sean Gulley for the miTLS project.
+
+#ifdef ENABLE_SHANI
+
+#include <stddef.h>
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace {
+
+alignas(16) const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul,
+    0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul,
+    0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
+    0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul,
+    0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul,
+    0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul,
+    0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul,
+    0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
+    0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+/** Byte order of each 32-bit word reversed. */
+__m128i inline Mask() { return _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull); }
+
+/** The words of the initial hash value, in ABEF and CDGH order. */
+__m128i inline InitABEF() { return _mm_set_epi32(0x6a09e667ul, 0xbb67ae85ul, 0x510e527ful, 0x9b05688cul); }
+__m128i inline InitCDGH() { return _mm_set_epi32(0x3c6ef372ul, 0xa54ff53aul, 0x1f83d9abul, 0x5be0cd19ul); }
+
+/** Four rounds, with the four message words of the quad. */
+void inline QuadRound(__m128i& abef, __m128i& cdgh, __m128i msg, int quad)
+{
+    msg = _mm_add_epi32(msg, _mm_load_si128(reinterpret_cast<const __m128i*>(K + 4 * quad)));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(msg, 0x0e));
+}
+
+/** The next four message words, from the previous sixteen. */
+__m128i inline Schedule(__m128i m0, __m128i m1, __m128i m2, __m128i m3)
+{
+    const __m128i msg = _mm_add_epi32(_mm_sha256msg1_epu32(m0, m1), _mm_alignr_epi8(m3, m2, 4));
+    return _mm_sha256msg2_epu32(msg, m3);
+}
+
+/** Compress the sixteen message words (four quads) into the state. */
+void inline Compress(__m128i& abef, __m128i& cdgh, const __m128i* block)
+{
+    const __m128i abef_save = abef;
+    const __m128i cdgh_save = cdgh;
+
+    __m128i m[4] = {block[0], block[1], block[2], block[3]};
+    for (int quad = 0; quad < 16; ++quad) {
+        if (quad >= 4) m[quad & 3] = Schedule(m[quad & 3], m[(quad + 1) & 3], m[(quad + 2) & 3], m[(quad + 3) & 3]);
+        QuadRound(abef, cdgh, m[quad & 3], quad);
+    }
+
+    abef = _mm_add_epi32(abef, abef_save);
+    cdgh = _mm_add_epi32(cdgh, cdgh_save);
+}
+
+/** As Compress, over two independent states, interleaved. */
+void inline Compress2(__m128i& abef_a, __m128i& cdgh_a, const __m128i* block_a, __m128i& abef_b, __m128i& cdgh_b, const __m128i* block_b)
+{
+    const __m128i abef_a_save = abef_a, cdgh_a_save = cdgh_a;
+    const __m128i abef_b_save = abef_b, cdgh_b_save = cdgh_b;
+
+    __m128i a[4] = {block_a[0], block_a[1], block_a[2], block_a[3]};
+    __m128i b[4] = {block_b[0], block_b[1], block_b[2], block_b[3]};
+    for (int quad = 0; quad < 16; ++quad) {
+        if (quad >= 4) {
+            a[quad & 3] = Schedule(a[quad & 3], a[(quad + 1) & 3], a[(quad + 2) & 3], a[(quad + 3) & 3]);
+            b[quad & 3] = Schedule(b[quad & 3], b[(quad + 1) & 3], b[(quad + 2) & 3], b[(quad + 3) & 3]);
+        }
+        QuadRound(abef_a, cdgh_a, a[quad & 3], quad);
+        QuadRound(abef_b, cdgh_b, b[quad & 3], quad);
+    }
+
+    abef_a = _mm_add_epi32(abef_a, abef_a_save);
+    cdgh_a = _mm_add_epi32(cdgh_a, cdgh_a_save);
+    abef_b = _mm_add_epi32(abef_b, abef_b_save);
+    cdgh_b = _mm_add_epi32(cdgh_b, cdgh_b_save);
+}
+
+/** Convert an ABEF/CDGH state to words in order (ABCD, EFGH). */
+void inline Unshuffle(__m128i& abef, __m128i& cdgh)
+{
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    abef = _mm_blend_epi16(feba, dchg, 0xf0);
+    cdgh = _mm_alignr_epi8(dchg, feba, 8);
+}
+
+/** Convert words in order (ABCD, EFGH) to an ABEF/CDGH state. */
+void inline Shuffle(__m128i& abcd, __m128i& efgh)
+{
+    const __m128i cdab = _mm_shuffle_epi32(abcd, 0xb1);
+    const __m128i hgfe = _mm_shuffle_epi32(efgh, 0x1b);
+    abcd = _mm_alignr_epi8(cdab, hgfe, 8);
+    efgh = _mm_blend_epi16(hgfe, cdab, 0xf0);
+}
+
+/** Read a 64-byte block as sixteen big-endian message words. */
+void inline Read(__m128i* block, const unsigned char* in)
+{
+    for (int i = 0; i < 4; ++i) block[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), Mask());
+}
+
+/** The padding block of a 64-byte message. */
+void inline Padding64(__m128i* block)
+{
+    block[0] = _mm_set_epi32(0, 0, 0, 0x80000000ul);
+    block[1] = _mm_setzero_si128();
+    block[2] = _mm_setzero_si128();
+    block[3] = _mm_set_epi32(0x200ul, 0, 0, 0);
+}
+
+/** The block of a 32-byte message (the state of the first hash), padded. */
+void inline Padded32(__m128i* block, __m128i abef, __m128i cdgh)
+{
+    Unshuffle(abef, cdgh);
+    block[0] = abef;
+    block[1] = cdgh;
+    block[2] = _mm_set_epi32(0, 0, 0, 0x80000000ul);
+    block[3] = _mm_set_epi32(0x100ul, 0, 0, 0);
+}
+
+/** Write the state as a big-endian 32-byte hash. */
+void inline Write(unsigned char* out, __m128i abef, __m128i cdgh)
+{
+    Unshuffle(abef, cdgh);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(abef, Mask()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_shuffle_epi8(cdgh, Mask()));
+}
+
+}
+
+namespace sha256_shani {
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    __m128i abef = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    __m128i cdgh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 4));
+    Shuffle(abef, cdgh);
+
+    __m128i block[4];
+    while (blocks--) {
+        Read(block, chunk);
+        Compress(abef, cdgh, block);
+        chunk += 64;
+    }
+
+    Unshuffle(abef, cdgh);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(s), abef);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(s + 4), cdgh);
+}
+}
+
+namespace sha256d64_shani {
+void Transform_2way(unsigned char* out, const unsigned char* in)
+{
+    __m128i abef_a = InitABEF(), cdgh_a = InitCDGH();
+    __m128i abef_b = InitABEF(), cdgh_b = InitCDGH();
+    __m128i block_a[4], block_b[4];
+
+    // Transform the 64-byte inputs.
+    Read(block_a, in);
+    Read(block_b, in + 64);
+    Compress2(abef_a, cdgh_a, block_a, abef_b, cdgh_b, block_b);
+
+    // Transform their padding.
+    Padding64(block_a);
+    Compress2(abef_a, cdgh_a, block_a, abef_b, cdgh_b, block_a);
+
+    // Transform the 32-byte first hashes with their padding.
+    Padded32(block_a, abef_a, cdgh_a);
+    Padded32(block_b, abef_b, cdgh_b);
+    abef_a = abef_b = InitABEF();
+    cdgh_a = cdgh_b = InitCDGH();
+    Compress2(abef_a, cdgh_a, block_a, abef_b, cdgh_b, block_b);
+
+    Write(out, abef_a, cdgh_a);
+    Write(out + 32, abef_b, cdgh_b);
+}
+}
+
+#endif
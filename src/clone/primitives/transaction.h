@@ -12,6 +12,8 @@
 #include <serialize.h>
 #include <uint256.h>
 
+#include <atomic>
+#include <thread>
 #include <tuple>
 
 /**
@@ -253,6 +255,49 @@ inline void SerializeTransaction(const TxType& tx, Stream& s) {
 }
 
 
+/** A hash computed upon first access, safe for concurrent access.
+ *
+ * Concurrent first accesses may each compute the hash, the first to complete
+ * publishes it and the others wait for publication (not for computation).
+ */
+class LazyHash
+{
+public:
+    LazyHash() = default;
+    explicit LazyHash(const uint256& hash) : m_hash(hash), m_state(READY) {}
+    LazyHash(const LazyHash& other)
+    {
+        if (other.m_state.load(std::memory_order_acquire) == READY) {
+            m_hash = other.m_hash;
+            m_state.store(READY, std::memory_order_relaxed);
+        }
+    }
+    LazyHash& operator=(const LazyHash&) = delete;
+
+    template <typename Compute>
+    const uint256& Get(Compute compute) const
+    {
+        if (m_state.load(std::memory_order_acquire) != READY) {
+            const uint256 hash = compute();
+            uint8_t expected = EMPTY;
+            if (m_state.compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+                m_hash = hash;
+                m_state.store(READY, std::memory_order_release);
+            } else {
+                while (m_state.load(std::memory_order_acquire) != READY)
+                    std::this_thread::yield();
+            }
+        }
+        return m_hash;
+    }
+
+private:
+    enum : uint8_t { EMPTY, WRITING, READY };
+
+    mutable uint256 m_hash;
+    mutable std::atomic<uint8_t> m_state{EMPTY};
+};
+
 /** The basic transaction that is broadcasted on the network and contained in
  * blocks.  A transaction can contain multiple inputs and outputs.
  */
@@ -279,9 +324,9 @@ public:
     const uint32_t nLockTime;
 
 private:
-    /** Memory only. */
-    const uint256 hash;
-    const uint256 m_witness_hash;
+    /** Memory only, computed upon first access as script verification does not require them. */
+    const LazyHash hash;
+    const LazyHash m_witness_hash;
 
     uint256 ComputeHash() const;
     uint256 ComputeWitnessHash() const;
@@ -308,8 +353,8 @@ public:
         return vin.empty() && vout.empty();
     }
 
-    const uint256& GetHash() const { return hash; }
-    const uint256& GetWitnessHash() const { return m_witness_hash; };
+    const uint256& GetHash() const { return hash.Get([this] { return ComputeHash(); }); }
+    const uint256& GetWitnessHash() const { return m_witness_hash.Get([this] { return ComputeWitnessHash(); }); };
 
     // Return sum of txouts.
     CAmount GetValueOut() const;
@@ -328,12 +373,12 @@ public:
 
     friend bool operator==(const CTransaction& a, const CTransaction& b)
     {
-        return a.hash == b.hash;
+        return a.GetHash() == b.GetHash();
     }
 
     friend bool operator!=(const CTransaction& a, const CTransaction& b)
     {
-        return a.hash != b.hash;
+        return a.GetHash() != b.GetHash();
     }
 
     std::string ToString() const;
@@ -0,0 +1,281 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/transaction_view.h>
+
+#include <crypto/common.h>
+#include <hash.h>
+#include <serialize.h>
+
+#include <algorithm>
+#include <ios>
+#include <limits>
+
+namespace {
+
+/** Bounds checked reading of the serialization, failing as deserialization does. */
+class ViewReader
+{
+public:
+    explicit ViewReader(Span<const unsigned char> bytes) noexcept : m_bytes(bytes), m_pos(0) {}
+
+    uint32_t Pos() const noexcept { return static_cast<uint32_t>(m_pos); }
+
+    const unsigned char* Skip(size_t size)
+    {
+        if (size > m_bytes.size() - m_pos)
+            throw std::ios_base::failure("end of data");
+        const unsigned char* data = m_bytes.data() + m_pos;
+        m_pos += size;
+        return data;
+    }
+
+    uint8_t ReadUInt8() { return *Skip(1); }
+    uint32_t ReadUInt32() { return ReadLE32(Skip(4)); }
+
+    /** As ReadCompactSize, range checked to MAX_SIZE. */
+    uint32_t ReadSize()
+    {
+        const uint8_t size = ReadUInt8();
+        uint64_t value = size;
+        if (size == 253) {
+            value = ReadLE16(Skip(2));
+            if (value < 253)
+                throw std::ios_base::failure("non-canonical ReadCompactSize()");
+        } else if (size == 254) {
+            value = ReadLE32(Skip(4));
+            if (value < 0x10000u)
+                throw std::ios_base::failure("non-canonical ReadCompactSize()");
+        } else if (size == 255) {
+            value = ReadLE64(Skip(8));
+            if (value < 0x100000000ULL)
+                throw std::ios_base::failure("non-canonical ReadCompactSize()");
+        }
+        if (value > MAX_SIZE)
+            throw std::ios_base::failure("ReadCompactSize(): size too large");
+        return static_cast<uint32_t>(value);
+    }
+
+private:
+    const Span<const unsigned char> m_bytes;
+    size_t m_pos;
+};
+
+/** Counts and positions of the parsed elements, which size the offset table. */
+struct ViewLayout
+{
+    size_t inputs = 0;
+    size_t outputs = 0;
+    uint32_t body_begin = 0;
+    uint32_t witness_begin = 0;
+    uint32_t locktime_begin = 0;
+    uint32_t size = 0;
+};
+
+/**
+ * Parse the serialization, as UnserializeTransaction (allowing witnesses). The
+ * offset table is populated if provided, it is otherwise sized by a first pass
+ * that obtains the layout.
+ */
+ViewLayout ParseView(Span<const unsigned char> bytes, uint32_t* table)
+{
+    constexpr size_t INPUT_WORDS = CTransactionView::INPUT_WORDS;
+    constexpr size_t OUTPUT_WORDS = CTransactionView::OUTPUT_WORDS;
+
+    ViewReader reader(bytes);
+    ViewLayout layout;
+    uint32_t* inputs = table;
+    uint32_t* outputs = nullptr;
+
+    const auto parse_inputs = [&]() {
+        layout.inputs = reader.ReadSize();
+        for (size_t input = 0; input < layout.inputs; ++input) {
+            const uint32_t prevout = reader.Pos();
+            reader.Skip(sizeof(uint256) + sizeof(uint32_t));
+            const uint32_t script_size = reader.ReadSize();
+            const uint32_t script = reader.Pos();
+            reader.Skip(script_size);
+            const uint32_t sequence = reader.ReadUInt32();
+            if (table) {
+                uint32_t* entry = inputs + input * INPUT_WORDS;
+                entry[0] = prevout;
+                entry[1] = script;
+                entry[2] = script_size;
+                entry[3] = sequence;
+                entry[4] = 0;
+                entry[5] = 0;
+            }
+        }
+    };
+
+    const auto parse_outputs = [&]() {
+        layout.outputs = reader.ReadSize();
+        outputs = table ? inputs + layout.inputs * INPUT_WORDS : nullptr;
+        for (size_t output = 0; output < layout.outputs; ++output) {
+            const uint32_t begin = reader.Pos();
+            reader.Skip(sizeof(CAmount));
+            const uint32_t script_size = reader.ReadSize();
+            const uint32_t script = reader.Pos();
+            reader.Skip(script_size);
+            if (table) {
+                uint32_t* entry = outputs + output * OUTPUT_WORDS;
+                entry[0] = begin;
+                entry[1] = script;
+                entry[2] = script_size;
+            }
+        }
+    };
+
+    reader.Skip(sizeof(int32_t));
+    layout.body_begin = reader.Pos();
+    parse_inputs();
+
+    uint8_t flags = 0;
+    if (layout.inputs == 0) {
+        // A dummy or an empty vin.
+        flags = reader.ReadUInt8();
+        if (flags != 0) {
+            layout.body_begin = reader.Pos();
+            parse_inputs();
+            parse_outputs();
+        }
+    } else {
+        parse_outputs();
+    }
+
+    if (flags & 1) {
+        flags ^= 1;
+        layout.witness_begin = reader.Pos();
+        bool witness = false;
+        for (size_t input = 0; input < layout.inputs; ++input) {
+            const uint32_t count = reader.ReadSize();
+            if (table) {
+                inputs[input * INPUT_WORDS + 4] = reader.Pos();
+                inputs[input * INPUT_WORDS + 5] = count;
+            }
+            for (size_t item = 0; item < count; ++item)
+                reader.Skip(reader.ReadSize());
+            witness |= count != 0;
+        }
+        if (!witness)
+            throw std::ios_base::failure("Superfluous witness record");
+    }
+
+    if (flags)
+        throw std::ios_base::failure("Unknown transaction optional data");
+
+    layout.locktime_begin = reader.Pos();
+    reader.ReadUInt32();
+    layout.size = reader.Pos();
+    return layout;
+}
+
+/** Decode a compact size already validated by ViewReader::ReadSize. */
+uint32_t DecodeSize(const unsigned char*& data) noexcept
+{
+    const uint8_t size = *data++;
+    if (size == 253) {
+        data += 2;
+        return ReadLE16(data - 2);
+    }
+    if (size == 254) {
+        data += 4;
+        return ReadLE32(data - 4);
+    }
+    return size;
+}
+
+} // namespace
+
+CWitnessView::const_iterator::value_type CWitnessView::const_iterator::operator*() const noexcept
+{
+    const unsigned char* data = m_item;
+    const uint32_t size = DecodeSize(data);
+    return {data, size};
+}
+
+CWitnessView::const_iterator& CWitnessView::const_iterator::operator++() noexcept
+{
+    const uint32_t size = DecodeSize(m_item);
+    m_item += size;
+    ++m_pos;
+    return *this;
+}
+
+CScriptWitness CWitnessView::ToWitness() const
+{
+    CScriptWitness witness;
+    witness.stack.reserve(m_count);
+    for (const auto item : *this)
+        witness.stack.emplace_back(item.begin(), item.end());
+    return witness;
+}
+
+CTxInView CTransactionView::Inputs::operator[](size_t pos) const
+{
+    const uint32_t* entry = m_tx.Input(pos);
+    const unsigned char* base = m_tx.m_bytes.data();
+    COutPoint prevout;
+    std::copy(base + entry[0], base + entry[0] + sizeof(uint256), prevout.hash.begin());
+    prevout.n = ReadLE32(base + entry[0] + sizeof(uint256));
+    return {prevout, entry[3], {base + entry[1], entry[2]}, {base + entry[4], entry[5]}};
+}
+
+CTxOutView CTransactionView::Outputs::operator[](size_t pos) const
+{
+    const uint32_t* entry = m_tx.Output(pos);
+    const unsigned char* base = m_tx.m_bytes.data();
+    const auto value = static_cast<CAmount>(ReadLE64(base + entry[0]));
+    return {value, {base + entry[1], entry[2]}, {base + entry[0], entry[1] + entry[2] - entry[0]}};
+}
+
+CTransactionView::CTransactionView() noexcept
+  : vin(*this), vout(*this)
+{
+}
+
+CTransactionView::CTransactionView(Span<const unsigned char> bytes)
+  : vin(*this), vout(*this)
+{
+    Parse(bytes);
+}
+
+void CTransactionView::Parse(Span<const unsigned char> bytes)
+{
+    if (bytes.size() > std::numeric_limits<uint32_t>::max())
+        throw std::ios_base::failure("Transaction size exceeds limit");
+
+    const ViewLayout layout = ParseView(bytes, nullptr);
+    m_table.resize(layout.inputs * INPUT_WORDS + layout.outputs * OUTPUT_WORDS);
+    ParseView(bytes, m_table.data());
+
+    m_bytes = bytes.first(layout.size);
+    m_inputs = layout.inputs;
+    m_outputs = layout.outputs;
+    m_body_begin = layout.body_begin;
+    m_witness_begin = layout.witness_begin;
+    m_locktime_begin = layout.locktime_begin;
+    nVersion = static_cast<int32_t>(ReadLE32(bytes.data()));
+    nLockTime = ReadLE32(bytes.data() + m_locktime_begin);
+}
+
+uint256 CTransactionView::GetHash() const
+{
+    // The serialization without witnesses: version, inputs, outputs, lock time.
+    const uint32_t body_end = HasWitness() ? m_witness_begin : m_locktime_begin;
+    uint256 hash;
+    CHash256()
+        .Write(m_bytes.first(sizeof(int32_t)))
+        .Write(m_bytes.subspan(m_body_begin, body_end - m_body_begin))
+        .Write(m_bytes.subspan(m_locktime_begin))
+        .Finalize(hash);
+    return hash;
+}
+
+uint256 CTransactionView::GetWitnessHash() const
+{
+    uint256 hash;
+    CHash256().Write(m_bytes).Finalize(hash);
+    return hash;
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_PRIMITIVES_TRANSACTION_VIEW_H
+#define BITCOIN_PRIMITIVES_TRANSACTION_VIEW_H
+
+#include <amount.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/** Random access iterator over a view range whose elements are produced by value. */
+template <typename Range>
+class ViewIterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename Range::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef value_type reference;
+
+    ViewIterator(const Range* range, size_t pos) noexcept : m_range(range), m_pos(pos) {}
+
+    value_type operator*() const { return (*m_range)[m_pos]; }
+    ViewIterator& operator++() noexcept { ++m_pos; return *this; }
+    ViewIterator operator++(int) noexcept { ViewIterator copy(*this); ++m_pos; return copy; }
+    difference_type operator-(const ViewIterator& other) const noexcept { return difference_type(m_pos) - difference_type(other.m_pos); }
+    friend bool operator==(const ViewIterator& a, const ViewIterator& b) noexcept { return a.m_pos == b.m_pos; }
+    friend bool operator!=(const ViewIterator& a, const ViewIterator& b) noexcept { return a.m_pos != b.m_pos; }
+
+private:
+    const Range* m_range;
+    size_t m_pos;
+};
+
+/**
+ * The witness stack of an input of a CTransactionView. Items are decoded as
+ * the stack is iterated, their encoding having been validated by the view.
+ */
+class CWitnessView
+{
+public:
+    typedef Span<const unsigned char> value_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Span<const unsigned char> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        const_iterator(const unsigned char* item, size_t pos) noexcept : m_item(item), m_pos(pos) {}
+
+        value_type operator*() const noexcept;
+        const_iterator& operator++() noexcept;
+        const_iterator operator++(int) noexcept { const_iterator copy(*this); ++*this; return copy; }
+        friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept { return a.m_pos == b.m_pos; }
+        friend bool operator!=(const const_iterator& a, const const_iterator& b) noexcept { return a.m_pos != b.m_pos; }
+
+    private:
+        const unsigned char* m_item;
+        size_t m_pos;
+    };
+
+    CWitnessView(const unsigned char* items, size_t count) noexcept : m_items(items), m_count(count) {}
+
+    size_t size() const noexcept { return m_count; }
+    bool IsNull() const noexcept { return m_count == 0; }
+    const_iterator begin() const noexcept { return {m_items, 0}; }
+    const_iterator end() const noexcept { return {nullptr, m_count}; }
+
+    /** Copy the stack, for use where a CScriptWitness is required. */
+    CScriptWitness ToWitness() const;
+
+private:
+    const unsigned char* m_items;
+    size_t m_count;
+};
+
+/** An input of a CTransactionView, referencing the serialized transaction. */
+class CTxInView
+{
+public:
+    COutPoint prevout;
+    uint32_t nSequence;
+    Span<const unsigned char> scriptSig;
+    CWitnessView scriptWitness;
+};
+
+/** An output of a CTransactionView, which serializes as its original bytes. */
+class CTxOutView
+{
+public:
+    CAmount nValue;
+    Span<const unsigned char> scriptPubKey;
+    Span<const unsigned char> serialized;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s.write((const char*)serialized.data(), serialized.size());
+    }
+};
+
+/**
+ * A read-only transaction over its serialization, avoiding the per input and
+ * per output allocations of deserializing a CTransaction.
+ *
+ * The bytes are parsed once, as by CTransaction deserialization (including its
+ * failures, which throw std::ios_base::failure), into a table of offsets held
+ * in a single allocation. Scripts and witness items are exposed as spans into
+ * the bytes, which are referenced, not copied, and must outlive the view.
+ *
+ * Witnesses are validated but only their positions are recorded, so that the
+ * items of an input are not visited again unless its witness is iterated.
+ *
+ * The members mirror those of CTransaction that are read by signature hashing
+ * and lock time checks, so that PrecomputedTransactionData, SignatureHash and
+ * GenericTransactionSignatureChecker apply to the view directly.
+ */
+class CTransactionView
+{
+public:
+    //! Offset table entry sizes, in words. Inputs are followed by outputs.
+    static constexpr size_t INPUT_WORDS = 6;
+    static constexpr size_t OUTPUT_WORDS = 3;
+
+    class Inputs
+    {
+    public:
+        typedef CTxInView value_type;
+        typedef ViewIterator<Inputs> const_iterator;
+
+        explicit Inputs(const CTransactionView& tx) noexcept : m_tx(tx) {}
+
+        size_t size() const noexcept { return m_tx.m_inputs; }
+        bool empty() const noexcept { return m_tx.m_inputs == 0; }
+        value_type operator[](size_t pos) const;
+        const_iterator begin() const noexcept { return {this, 0}; }
+        const_iterator end() const noexcept { return {this, size()}; }
+
+    private:
+        const CTransactionView& m_tx;
+    };
+
+    class Outputs
+    {
+    public:
+        typedef CTxOutView value_type;
+        typedef ViewIterator<Outputs> const_iterator;
+
+        explicit Outputs(const CTransactionView& tx) noexcept : m_tx(tx) {}
+
+        size_t size() const noexcept { return m_tx.m_outputs; }
+        bool empty() const noexcept { return m_tx.m_outputs == 0; }
+        value_type operator[](size_t pos) const;
+        const_iterator begin() const noexcept { return {this, 0}; }
+        const_iterator end() const noexcept { return {this, size()}; }
+
+    private:
+        const CTransactionView& m_tx;
+    };
+
+    /** An empty view, to be assigned by Parse. */
+    CTransactionView() noexcept;
+
+    /**
+     * Parse a transaction from the front of bytes, which may extend beyond it
+     * (see GetSerializeSize).
+     */
+    explicit CTransactionView(Span<const unsigned char> bytes);
+    CTransactionView(const CTransactionView&) = delete;
+    CTransactionView& operator=(const CTransactionView&) = delete;
+
+    /**
+     * View another transaction, reusing the offset table. If the bytes do not
+     * parse the view is unchanged.
+     */
+    void Parse(Span<const unsigned char> bytes);
+
+    const Inputs vin;
+    const Outputs vout;
+    int32_t nVersion = 0;
+    uint32_t nLockTime = 0;
+
+    /** The serialized transaction, a prefix of the bytes parsed. */
+    Span<const unsigned char> Bytes() const noexcept { return m_bytes; }
+    size_t GetSerializeSize() const noexcept { return m_bytes.size(); }
+
+    /** The serialized size without witnesses. */
+    size_t GetStrippedSize() const noexcept
+    {
+        const uint32_t body_end = HasWitness() ? m_witness_begin : m_locktime_begin;
+        return sizeof(int32_t) + (body_end - m_body_begin) + (m_bytes.size() - m_locktime_begin);
+    }
+
+    bool IsCoinBase() const { return vin.size() == 1 && vin[0].prevout.IsNull(); }
+    bool HasWitness() const noexcept { return m_witness_begin != 0; }
+    uint256 GetHash() const;
+    uint256 GetWitnessHash() const;
+
+private:
+    const uint32_t* Input(size_t pos) const noexcept { return m_table.data() + pos * INPUT_WORDS; }
+    const uint32_t* Output(size_t pos) const noexcept { return m_table.data() + m_inputs * INPUT_WORDS + pos * OUTPUT_WORDS; }
+
+    Span<const unsigned char> m_bytes;
+    std::vector<uint32_t> m_table;
+    size_t m_inputs = 0;
+    size_t m_outputs = 0;
+    uint32_t m_body_begin = 0;      //!< Offset of the inputs.
+    uint32_t m_witness_begin = 0;   //!< Offset of the witnesses, or zero if none.
+    uint32_t m_locktime_begin = 0;  //!< Offset of the lock time.
+};
+
+#endif // BITCOIN_PRIMITIVES_TRANSACTION_VIEW_H
@@ -0,0 +1,175 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <script/decoded.h>
+
+#include <algorithm>
+#include <cstring>
+
+bool IsDisabledOpcode(opcodetype opcode)
+{
+    return opcode == OP_CAT ||
+        opcode == OP_SUBSTR ||
+        opcode == OP_LEFT ||
+        opcode == OP_RIGHT ||
+        opcode == OP_INVERT ||
+        opcode == OP_AND ||
+        opcode == OP_OR ||
+        opcode == OP_XOR ||
+        opcode == OP_2MUL ||
+        opcode == OP_2DIV ||
+        opcode == OP_MUL ||
+        opcode == OP_DIV ||
+        opcode == OP_MOD ||
+        opcode == OP_LSHIFT ||
+        opcode == OP_RSHIFT;
+}
+
+/** Whether an instruction may cause failure when not executed. */
+static bool IsUnskippable(opcodetype opcode, size_t size)
+{
+    return size > MAX_SCRIPT_ELEMENT_SIZE || IsDisabledOpcode(opcode) ||
+        opcode == OP_VERIF || opcode == OP_VERNOTIF || opcode == OP_CODESEPARATOR;
+}
+
+DecodedScript::DecodedScript(const CScript& script) : m_script(script), m_fail_index(DecodedOp::NO_JUMP), m_separator_index(DecodedOp::NO_JUMP), m_valid(true), m_op_success(false)
+{
+    // Running totals of unskippable and counted instructions, by instruction index.
+    prevector<INLINE_OPS + 1, uint32_t> unskippable, counted;
+    unskippable.push_back(0);
+    counted.push_back(0);
+
+    // Indices of the OP_IF, OP_NOTIF or OP_ELSE that begin each open branch.
+    prevector<16, uint32_t> open;
+
+    const auto link = [&](uint32_t from, uint32_t to) {
+        if (unskippable[to] == unskippable[from + 1]) {
+            m_ops[from].jump = to;
+            m_ops[from].counted = counted[to] - counted[from + 1];
+        }
+    };
+
+    CScript::const_iterator pc = script.begin();
+    while (pc < script.end()) {
+        const uint32_t position = pc - script.begin();
+        opcodetype opcode;
+        Span<const unsigned char> data;
+        if (!GetScriptOp(pc, script.end(), opcode, &data)) {
+            m_valid = false;
+            break;
+        }
+
+        const uint32_t index = m_ops.size();
+        DecodedOp op;
+        op.opcode = opcode;
+        op.begin = data.empty() ? position : static_cast<uint32_t>(data.data() - script.data());
+        op.size = data.size();
+        op.end = pc - script.begin();
+        op.jump = DecodedOp::NO_JUMP;
+        op.counted = 0;
+        op.ordinal = counted.back() + (opcode > OP_16 ? 1 : 0);
+        op.minimal = opcode > OP_PUSHDATA4 || CheckMinimalPush(data, opcode);
+        m_ops.push_back(op);
+
+        m_op_success = m_op_success || IsOpSuccess(opcode);
+        unskippable.push_back(unskippable.back() + (IsUnskippable(opcode, data.size()) ? 1 : 0));
+        counted.push_back(op.ordinal);
+
+        if (m_fail_index == DecodedOp::NO_JUMP && (data.size() > MAX_SCRIPT_ELEMENT_SIZE || IsDisabledOpcode(opcode)))
+            m_fail_index = index;
+        if (m_separator_index == DecodedOp::NO_JUMP && opcode == OP_CODESEPARATOR)
+            m_separator_index = index;
+
+        if (opcode == OP_IF || opcode == OP_NOTIF) {
+            open.push_back(index);
+        } else if (opcode == OP_ELSE && !open.empty()) {
+            link(open.back(), index);
+            open.back() = index;
+        } else if (opcode == OP_ENDIF && !open.empty()) {
+            link(open.back(), index);
+            open.pop_back();
+        }
+    }
+
+    m_fail_index = std::min<uint32_t>(m_fail_index, m_ops.size());
+    m_separator_index = std::min<uint32_t>(m_separator_index, m_ops.size());
+}
+
+size_t CachedScript::Usage() const noexcept
+{
+    return sizeof(CachedScript) + m_script.allocated_memory() + m_decoded.Instructions().allocated_memory();
+}
+
+DecodedScriptCache::DecodedScriptCache(size_t max_bytes) : m_shard_bytes(max_bytes / SHARDS)
+{
+}
+
+static bool Equal(const CScript& script, Span<const unsigned char> data)
+{
+    return script.size() == data.size() && (data.empty() || std::memcmp(script.data(), data.data(), data.size()) == 0);
+}
+
+std::shared_ptr<const CachedScript> DecodedScriptCache::Get(const uint256& key, Span<const unsigned char> script)
+{
+    if (script.size() > MAX_CACHED_SCRIPT_SIZE)
+        return std::make_shared<const CachedScript>(script);
+
+    Shard& shard = m_shards[key.GetUint64(1) % SHARDS];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it != shard.entries.end() && Equal(it->second->Script(), script))
+            return it->second;
+    }
+
+    // Decode outside of the lock, a concurrent decoding of the same script is benign.
+    auto entry = std::make_shared<const CachedScript>(script);
+    const size_t usage = entry->Usage();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        if (Equal(it->second->Script(), script))
+            return it->second;
+
+        // A different script under the same key, replace it.
+        shard.usage -= it->second->Usage();
+        shard.entries.erase(it);
+    }
+
+    // Evict arbitrary entries until the new entry fits.
+    while (!shard.entries.empty() && shard.usage + usage > m_shard_bytes) {
+        shard.usage -= shard.entries.begin()->second->Usage();
+        shard.entries.erase(shard.entries.begin());
+    }
+
+    shard.entries.emplace(key, entry);
+    shard.usage += usage;
+    return entry;
+}
+
+size_t DecodedScriptCache::Size() const
+{
+    size_t size = 0;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size += shard.entries.size();
+    }
+    return size;
+}
+
+void DecodedScriptCache::Clear()
+{
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.usage = 0;
+    }
+}
+
+DecodedScriptCache& GetDecodedScriptCache()
+{
+    static DecodedScriptCache cache(DecodedScriptCache::DEFAULT_MAX_BYTES);
+    return cache;
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SCRIPT_DECODED_H
+#define BITCOIN_SCRIPT_DECODED_H
+
+#include <prevector.h>
+#include <script/script.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/** Opcodes disabled by CVE-2010-5137, which fail even when not executed. */
+bool IsDisabledOpcode(opcodetype opcode);
+
+/** A single decoded instruction, with offsets relative to the script. */
+struct DecodedOp
+{
+    //! No skippable branch follows the instruction.
+    static constexpr uint32_t NO_JUMP = std::numeric_limits<uint32_t>::max();
+
+    opcodetype opcode;
+    uint32_t begin;     //!< Offset of the push data.
+    uint32_t size;      //!< Size of the push data.
+    uint32_t end;       //!< Offset of the following instruction.
+    uint32_t jump;      //!< OP_IF, OP_NOTIF, OP_ELSE: index of the matching OP_ELSE/OP_ENDIF, if the branch may be skipped.
+    uint32_t counted;   //!< Instructions within the skipped branch that count toward MAX_OPS_PER_SCRIPT.
+    uint32_t ordinal;   //!< Instructions up to and including this one that count toward MAX_OPS_PER_SCRIPT.
+    bool minimal;       //!< The push is minimally encoded (see CheckMinimalPush).
+};
+
+/**
+ * A script decoded once into instructions that the interpreter may execute
+ * directly, avoiding repeated GetScriptOp calls.
+ *
+ * If the script does not parse the instructions end at the failure, which
+ * the interpreter reports as SCRIPT_ERR_BAD_OPCODE upon reaching it.
+ *
+ * For each conditional, the index of the instruction that ends its branch is
+ * precomputed when the branch contains nothing that can fail while not
+ * executed (disabled opcodes, oversized pushes, OP_VERIF, OP_VERNOTIF and
+ * OP_CODESEPARATOR). The interpreter may then skip an unexecuted branch,
+ * accounting only for its operation count.
+ *
+ * The script is referenced, not copied, and must outlive the decoding.
+ */
+class DecodedScript
+{
+public:
+    //! Decoding of scripts of up to this many instructions does not allocate.
+    static constexpr unsigned int INLINE_OPS = 24;
+
+    typedef prevector<INLINE_OPS, DecodedOp> Ops;
+
+    explicit DecodedScript(const CScript& script);
+    DecodedScript(const DecodedScript&) = delete;
+    DecodedScript& operator=(const DecodedScript&) = delete;
+
+    const CScript& Script() const noexcept { return m_script; }
+    const Ops& Instructions() const noexcept { return m_ops; }
+
+    /** The script parsed to its end. */
+    bool IsValid() const noexcept { return m_valid; }
+
+    /** An OP_SUCCESSx instruction precedes any parse failure. */
+    bool HasOpSuccess() const noexcept { return m_op_success; }
+
+    /**
+     * Index of the first instruction that fails whether executed or not (an
+     * oversized push or a disabled opcode), or the instruction count if none.
+     */
+    size_t FailIndex() const noexcept { return m_fail_index; }
+
+    /** Index of the first OP_CODESEPARATOR, or the instruction count if none. */
+    size_t SeparatorIndex() const noexcept { return m_separator_index; }
+
+    /** The push data of an instruction. */
+    Span<const unsigned char> Data(const DecodedOp& op) const noexcept
+    {
+        return op.size == 0 ? Span<const unsigned char>() : Span<const unsigned char>(m_script.data() + op.begin, op.size);
+    }
+
+private:
+    const CScript& m_script;
+    Ops m_ops;
+    uint32_t m_fail_index;
+    uint32_t m_separator_index;
+    bool m_valid;
+    bool m_op_success;
+};
+
+/** A script and its decoding, as held by DecodedScriptCache. */
+class CachedScript
+{
+public:
+    explicit CachedScript(Span<const unsigned char> script) : m_script(script.begin(), script.end()), m_decoded(m_script) {}
+    CachedScript(const CachedScript&) = delete;
+    CachedScript& operator=(const CachedScript&) = delete;
+
+    const CScript& Script() const noexcept { return m_script; }
+    const DecodedScript& Decoded() const noexcept { return m_decoded; }
+
+    /** Approximate memory used by the entry. */
+    size_t Usage() const noexcept;
+
+private:
+    const CScript m_script;
+    const DecodedScript m_decoded;
+};
+
+/**
+ * Bounded, thread safe cache of decoded scripts.
+ *
+ * Entries are keyed by a hash that the caller already has at hand (the P2WSH
+ * program, the tapleaf hash, the P2SH script hash), and the script bytes are
+ * compared on lookup. A key therefore need not commit to the script, and the
+ * cache never substitutes for validation of the hash itself. Keys are spread
+ * over independently locked shards, each evicting arbitrary entries when over
+ * its share of the memory budget.
+ */
+class DecodedScriptCache
+{
+public:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t DEFAULT_MAX_BYTES = 16 << 20;
+
+    //! Scripts larger than this are not cached.
+    static constexpr size_t MAX_CACHED_SCRIPT_SIZE = MAX_SCRIPT_SIZE;
+
+    explicit DecodedScriptCache(size_t max_bytes);
+    DecodedScriptCache(const DecodedScriptCache&) = delete;
+    DecodedScriptCache& operator=(const DecodedScriptCache&) = delete;
+
+    /** Obtain the decoding of script, decoding and caching it if not present. */
+    std::shared_ptr<const CachedScript> Get(const uint256& key, Span<const unsigned char> script);
+
+    /** The number of cached scripts. */
+    size_t Size() const;
+
+    /** Remove all entries. */
+    void Clear();
+
+private:
+    struct KeyHasher
+    {
+        size_t operator()(const uint256& key) const noexcept { return static_cast<size_t>(key.GetUint64(0)); }
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<uint256, std::shared_ptr<const CachedScript>, KeyHasher> entries;
+        size_t usage = 0;
+    };
+
+    const size_t m_shard_bytes;
+    Shard m_shards[SHARDS];
+};
+
+/** The process wide cache used by VerifyScript. */
+DecodedScriptCache& GetDecodedScriptCache();
+
+#endif // BITCOIN_SCRIPT_DECODED_H
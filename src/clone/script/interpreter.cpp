@@ -8,10 +8,15 @@
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
+#include <primitives/transaction_view.h>
 #include <pubkey.h>
 #include <script/script.h>
 #include <uint256.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
 typedef std::vector<unsigned char> valtype;
 
 namespace {
@@ -32,7 +37,7 @@ inline bool set_error(ScriptError* ret, const ScriptError serror)
 
 } // namespace
 
-bool CastToBool(const valtype& vch)
+bool CastToBool(Span<const unsigned char> vch)
 {
     for (unsigned int i = 0; i < vch.size(); i++)
     {
@@ -53,14 +58,20 @@ bool CastToBool(const valtype& vch)
  */
 #define stacktop(i)  (stack.at(stack.size()+(i)))
 #define altstacktop(i)  (altstack.at(altstack.size()+(i)))
-static inline void popstack(std::vector<valtype>& stack)
+static inline void popstack(ScriptStack& stack)
 {
     if (stack.empty())
         throw std::runtime_error("popstack(): stack empty");
     stack.pop_back();
 }
 
-bool static IsCompressedOrUncompressedPubKey(const valtype &vchPubKey) {
+static inline void pushnum(ScriptStack& stack, const CScriptNum& bn)
+{
+    unsigned char vch[CScriptNum::MAX_SERIALIZED_SIZE];
+    stack.push_back(Span<const unsigned char>(vch, bn.getvch(vch)));
+}
+
+bool static IsCompressedOrUncompressedPubKey(Span<const unsigned char> vchPubKey) {
     if (vchPubKey.size() < CPubKey::COMPRESSED_SIZE) {
         //  Non-canonical public key: too short
         return false;
@@ -82,7 +93,7 @@ bool static IsCompressedOrUncompressedPubKey(const valtype &vchPubKey) {
     return true;
 }
 
-bool static IsCompressedPubKey(const valtype &vchPubKey) {
+bool static IsCompressedPubKey(Span<const unsigned char> vchPubKey) {
     if (vchPubKey.size() != CPubKey::COMPRESSED_SIZE) {
         //  Non-canonical public key: invalid length for compressed key
         return false;
@@ -104,7 +115,7 @@ bool static IsCompressedPubKey(const valtype &vchPubKey) {
  *
  * This function is consensus-critical since BIP66.
  */
-bool static IsValidSignatureEncoding(const std::vector<unsigned char> &sig) {
+bool static IsValidSignatureEncoding(Span<const unsigned char> sig) {
     // Format: 0x30 [total-length] 0x02 [R-length] [R] 0x02 [S-length] [S] [sighash]
     // * total-length: 1-byte length descriptor of everything that follows,
     //   excluding the sighash byte.
@@ -169,7 +180,7 @@ bool static IsValidSignatureEncoding(const std::vector<unsigned char> &sig) {
     return true;
 }
 
-bool static IsLowDERSignature(const valtype &vchSig, ScriptError* serror) {
+bool static IsLowDERSignature(Span<const unsigned char> vchSig, ScriptError* serror) {
     if (!IsValidSignatureEncoding(vchSig)) {
         return set_error(serror, SCRIPT_ERR_SIG_DER);
     }
@@ -186,7 +197,7 @@ bool static IsLowDERSignature(const valtype &vchSig, ScriptError* serror) {
     return true;
 }
 
-bool static IsDefinedHashtypeSignature(const valtype &vchSig) {
+bool static IsDefinedHashtypeSignature(Span<const unsigned char> vchSig) {
     if (vchSig.size() == 0) {
         return false;
     }
@@ -197,7 +208,7 @@ bool static IsDefinedHashtypeSignature(const valtype &vchSig) {
     return true;
 }
 
-bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned int flags, ScriptError* serror) {
+bool CheckSignatureEncoding(Span<const unsigned char> vchSig, unsigned int flags, ScriptError* serror) {
     // Empty signature. Not strictly DER encoded, but allowed to provide a
     // compact way to provide an invalid signature for use with CHECK(MULTI)SIG
     if (vchSig.size() == 0) {
@@ -214,7 +225,7 @@ bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned i
     return true;
 }
 
-bool static CheckPubKeyEncoding(const valtype &vchPubKey, unsigned int flags, const SigVersion &sigversion, ScriptError* serror) {
+bool static CheckPubKeyEncoding(Span<const unsigned char> vchPubKey, unsigned int flags, const SigVersion &sigversion, ScriptError* serror) {
     if ((flags & SCRIPT_VERIFY_STRICTENC) != 0 && !IsCompressedOrUncompressedPubKey(vchPubKey)) {
         return set_error(serror, SCRIPT_ERR_PUBKEYTYPE);
     }
@@ -225,31 +236,6 @@ bool static CheckPubKeyEncoding(const valtype &vchPubKey, unsigned int flags, co
     return true;
 }
 
-bool static CheckMinimalPush(const valtype& data, opcodetype opcode) {
-    // Excludes OP_1NEGATE, OP_1-16 since they are by definition minimal
-    assert(0 <= opcode && opcode <= OP_PUSHDATA4);
-    if (data.size() == 0) {
-        // Should have used OP_0.
-        return opcode == OP_0;
-    } else if (data.size() == 1 && data[0] >= 1 && data[0] <= 16) {
-        // Should have used OP_1 .. OP_16.
-        return false;
-    } else if (data.size() == 1 && data[0] == 0x81) {
-        // Should have used OP_1NEGATE.
-        return false;
-    } else if (data.size() <= 75) {
-        // Must have used a direct push (opcode indicating number of bytes pushed + those bytes).
-        return opcode == data.size();
-    } else if (data.size() <= 255) {
-        // Must have used OP_PUSHDATA.
-        return opcode == OP_PUSHDATA1;
-    } else if (data.size() <= 65535) {
-        // Must have used OP_PUSHDATA2.
-        return opcode == OP_PUSHDATA2;
-    }
-    return true;
-}
-
 int FindAndDelete(CScript& script, const CScript& b)
 {
     int nFound = 0;
@@ -342,7 +328,7 @@ public:
 };
 }
 
-static bool EvalChecksigPreTapscript(const valtype& vchSig, const valtype& vchPubKey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& fSuccess)
+static bool EvalChecksigPreTapscript(Span<const unsigned char> vchSig, Span<const unsigned char> vchPubKey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& fSuccess)
 {
     assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0);
 
@@ -368,7 +354,7 @@ static bool EvalChecksigPreTapscript(const valtype& vchSig, const valtype& vchPu
     return true;
 }
 
-static bool EvalChecksigTapscript(const valtype& sig, const valtype& pubkey, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
+static bool EvalChecksigTapscript(Span<const unsigned char> sig, Span<const unsigned char> pubkey, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
 {
     assert(sigversion == SigVersion::TAPSCRIPT);
 
@@ -413,7 +399,7 @@ static bool EvalChecksigTapscript(const valtype& sig, const valtype& pubkey, Scr
  * A return value of false means the script fails entirely. When true is returned, the
  * success variable indicates whether the signature check itself succeeded.
  */
-static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
+static bool EvalChecksig(Span<const unsigned char> sig, Span<const unsigned char> pubkey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
 {
     switch (sigversion) {
     case SigVersion::BASE:
@@ -428,7 +414,7 @@ static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::con
     assert(false);
 }
 
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+bool EvalScript(ScriptStack& stack, const DecodedScript& decoded, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
     static const CScriptNum bnZero(0);
     static const CScriptNum bnOne(1);
@@ -441,13 +427,14 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     // sigversion cannot be TAPROOT here, as it admits no script execution.
     assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0 || sigversion == SigVersion::TAPSCRIPT);
 
-    CScript::const_iterator pc = script.begin();
+    const CScript& script = decoded.Script();
+    const DecodedScript::Ops& ops = decoded.Instructions();
     CScript::const_iterator pend = script.end();
     CScript::const_iterator pbegincodehash = script.begin();
     opcodetype opcode;
-    valtype vchPushValue;
+    Span<const unsigned char> vchPushValue;
     ConditionStack vfExec;
-    std::vector<valtype> altstack;
+    ScriptStack altstack(stack.arena());
     set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
     if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && script.size() > MAX_SCRIPT_SIZE) {
         return set_error(serror, SCRIPT_ERR_SCRIPT_SIZE);
@@ -457,17 +444,34 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     uint32_t opcode_pos = 0;
     execdata.m_codeseparator_pos = 0xFFFFFFFFUL;
     execdata.m_codeseparator_pos_init = true;
+    const std::atomic<bool>* const cancelled = checker.Cancellation();
+
+    // Advance over an unexecuted branch that cannot fail (see DecodedScript).
+    const auto skip_branch = [&](size_t& index, const DecodedOp& op) {
+        // An initial stack over the limit fails after this instruction.
+        if (vfExec.all_true() || op.jump == DecodedOp::NO_JUMP || stack.size() + altstack.size() > MAX_STACK_SIZE)
+            return true;
+        if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && (nOpCount += op.counted) > MAX_OPS_PER_SCRIPT)
+            return set_error(serror, SCRIPT_ERR_OP_COUNT);
+        opcode_pos += op.jump - index - 1;
+        index = op.jump - 1;
+        return true;
+    };
 
     try
     {
-        for (; pc < pend; ++opcode_pos) {
+        for (size_t index = 0; index < ops.size(); ++index, ++opcode_pos) {
+            if (cancelled && cancelled->load(std::memory_order_relaxed))
+                return set_error(serror, SCRIPT_ERR_CANCELLED);
+
             bool fExec = vfExec.all_true();
 
             //
             // Read instruction
             //
-            if (!script.GetOp(pc, opcode, vchPushValue))
-                return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
+            const DecodedOp& op = ops[index];
+            opcode = op.opcode;
+            vchPushValue = decoded.Data(op);
             if (vchPushValue.size() > MAX_SCRIPT_ELEMENT_SIZE)
                 return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
 
@@ -478,21 +482,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 }
             }
 
-            if (opcode == OP_CAT ||
-                opcode == OP_SUBSTR ||
-                opcode == OP_LEFT ||
-                opcode == OP_RIGHT ||
-                opcode == OP_INVERT ||
-                opcode == OP_AND ||
-                opcode == OP_OR ||
-                opcode == OP_XOR ||
-                opcode == OP_2MUL ||
-                opcode == OP_2DIV ||
-                opcode == OP_MUL ||
-                opcode == OP_DIV ||
-                opcode == OP_MOD ||
-                opcode == OP_LSHIFT ||
-                opcode == OP_RSHIFT)
+            if (IsDisabledOpcode(opcode))
                 return set_error(serror, SCRIPT_ERR_DISABLED_OPCODE); // Disabled opcodes (CVE-2010-5137).
 
             // With SCRIPT_VERIFY_CONST_SCRIPTCODE, OP_CODESEPARATOR in non-segwit script is rejected even in an unexecuted branch
@@ -500,7 +490,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 return set_error(serror, SCRIPT_ERR_OP_CODESEPARATOR);
 
             if (fExec && 0 <= opcode && opcode <= OP_PUSHDATA4) {
-                if (fRequireMinimal && !CheckMinimalPush(vchPushValue, opcode)) {
+                if (fRequireMinimal && !op.minimal) {
                     return set_error(serror, SCRIPT_ERR_MINIMALDATA);
                 }
                 stack.push_back(vchPushValue);
@@ -530,7 +520,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     // ( -- value)
                     CScriptNum bn((int)opcode - (int)(OP_1 - 1));
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                     // The result of these opcodes should always be the minimal way to push the data
                     // they push, so no need for a CheckMinimalPush here.
                 }
@@ -633,7 +623,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     {
                         if (stack.size() < 1)
                             return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
-                        valtype& vch = stacktop(-1);
+                        const StackElement& vch = stacktop(-1);
                         // Tapscript requires minimal IF/NOTIF inputs as a consensus rule.
                         if (sigversion == SigVersion::TAPSCRIPT) {
                             // The input argument to the OP_IF and OP_NOTIF opcodes must be either
@@ -655,6 +645,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                         popstack(stack);
                     }
                     vfExec.push_back(fValue);
+                    if (!skip_branch(index, op))
+                        return false;
                 }
                 break;
 
@@ -663,6 +655,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (vfExec.empty())
                         return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
                     vfExec.toggle_top();
+                    if (!skip_branch(index, op))
+                        return false;
                 }
                 break;
 
@@ -702,7 +696,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    altstack.push_back(stacktop(-1));
+                    altstack.push_back(std::move(stacktop(-1)));
                     popstack(stack);
                 }
                 break;
@@ -711,7 +705,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     if (altstack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_ALTSTACK_OPERATION);
-                    stack.push_back(altstacktop(-1));
+                    stack.push_back(std::move(altstacktop(-1)));
                     popstack(altstack);
                 }
                 break;
@@ -731,10 +725,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-2);
-                    valtype vch2 = stacktop(-1);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    StackElement vch1 = stacktop(-2);
+                    StackElement vch2 = stacktop(-1);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
                 }
                 break;
 
@@ -743,12 +737,12 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 -- x1 x2 x3 x1 x2 x3)
                     if (stack.size() < 3)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-3);
-                    valtype vch2 = stacktop(-2);
-                    valtype vch3 = stacktop(-1);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
-                    stack.push_back(vch3);
+                    StackElement vch1 = stacktop(-3);
+                    StackElement vch2 = stacktop(-2);
+                    StackElement vch3 = stacktop(-1);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
+                    stack.push_back(std::move(vch3));
                 }
                 break;
 
@@ -757,10 +751,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 -- x1 x2 x3 x4 x1 x2)
                     if (stack.size() < 4)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-4);
-                    valtype vch2 = stacktop(-3);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    StackElement vch1 = stacktop(-4);
+                    StackElement vch2 = stacktop(-3);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
                 }
                 break;
 
@@ -769,11 +763,11 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 x5 x6 -- x3 x4 x5 x6 x1 x2)
                     if (stack.size() < 6)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-6);
-                    valtype vch2 = stacktop(-5);
+                    StackElement vch1 = stacktop(-6);
+                    StackElement vch2 = stacktop(-5);
                     stack.erase(stack.end()-6, stack.end()-4);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
                 }
                 break;
 
@@ -792,9 +786,9 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x - 0 | x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
+                    StackElement vch = stacktop(-1);
                     if (CastToBool(vch))
-                        stack.push_back(vch);
+                        stack.push_back(std::move(vch));
                 }
                 break;
 
@@ -802,7 +796,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     // -- stacksize
                     CScriptNum bn(stack.size());
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -820,8 +814,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x -- x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    stack.push_back(vch);
+                    StackElement vch = stacktop(-1);
+                    stack.push_back(std::move(vch));
                 }
                 break;
 
@@ -839,8 +833,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-2);
-                    stack.push_back(vch);
+                    StackElement vch = stacktop(-2);
+                    stack.push_back(std::move(vch));
                 }
                 break;
 
@@ -855,10 +849,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     popstack(stack);
                     if (n < 0 || n >= (int)stack.size())
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-n-1);
+                    StackElement vch = stacktop(-n-1);
                     if (opcode == OP_ROLL)
                         stack.erase(stack.end()-n-1);
-                    stack.push_back(vch);
+                    stack.push_back(std::move(vch));
                 }
                 break;
 
@@ -888,8 +882,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    stack.insert(stack.end()-2, vch);
+                    StackElement vch = stacktop(-1);
+                    stack.insert(stack.end()-2, std::move(vch));
                 }
                 break;
 
@@ -900,7 +894,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
                     CScriptNum bn(stacktop(-1).size());
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -915,8 +909,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 - bool)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype& vch1 = stacktop(-2);
-                    valtype& vch2 = stacktop(-1);
+                    const StackElement& vch1 = stacktop(-2);
+                    const StackElement& vch2 = stacktop(-1);
                     bool fEqual = (vch1 == vch2);
                     // OP_NOTEQUAL is disabled because it would be too easy to say
                     // something like n != 1 and have some wiseguy pass in 1 with extra
@@ -962,7 +956,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     default:            assert(!"invalid opcode"); break;
                     }
                     popstack(stack);
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -1011,7 +1005,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     }
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
 
                     if (opcode == OP_NUMEQUALVERIFY)
                     {
@@ -1052,20 +1046,21 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (in -- hash)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype& vch = stacktop(-1);
-                    valtype vchHash((opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32);
+                    const StackElement& vch = stacktop(-1);
+                    unsigned char vchHash[CSHA256::OUTPUT_SIZE];
+                    const Span<unsigned char> hash(vchHash, (opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32);
                     if (opcode == OP_RIPEMD160)
-                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(hash.data());
                     else if (opcode == OP_SHA1)
-                        CSHA1().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA1().Write(vch.data(), vch.size()).Finalize(hash.data());
                     else if (opcode == OP_SHA256)
-                        CSHA256().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA256().Write(vch.data(), vch.size()).Finalize(hash.data());
                     else if (opcode == OP_HASH160)
-                        CHash160().Write(vch).Finalize(vchHash);
+                        CHash160().Write(vch).Finalize(hash);
                     else if (opcode == OP_HASH256)
-                        CHash256().Write(vch).Finalize(vchHash);
+                        CHash256().Write(vch).Finalize(hash);
                     popstack(stack);
-                    stack.push_back(vchHash);
+                    stack.push_back(hash);
                 }
                 break;
 
@@ -1075,7 +1070,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // script, even in an unexecuted branch (this is checked above the opcode case statement).
 
                     // Hash starts after the code separator
-                    pbegincodehash = pc;
+                    pbegincodehash = script.begin() + op.end;
                     execdata.m_codeseparator_pos = opcode_pos;
                 }
                 break;
@@ -1087,8 +1082,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
 
-                    valtype& vchSig    = stacktop(-2);
-                    valtype& vchPubKey = stacktop(-1);
+                    const StackElement& vchSig    = stacktop(-2);
+                    const StackElement& vchPubKey = stacktop(-1);
 
                     bool fSuccess = true;
                     if (!EvalChecksig(vchSig, vchPubKey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, fSuccess)) return false;
@@ -1113,16 +1108,16 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (sig num pubkey -- num)
                     if (stack.size() < 3) return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
 
-                    const valtype& sig = stacktop(-3);
+                    const StackElement& sig = stacktop(-3);
                     const CScriptNum num(stacktop(-2), fRequireMinimal);
-                    const valtype& pubkey = stacktop(-1);
+                    const StackElement& pubkey = stacktop(-1);
 
                     bool success = true;
                     if (!EvalChecksig(sig, pubkey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, success)) return false;
                     popstack(stack);
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back((num + (success ? 1 : 0)).getvch());
+                    pushnum(stack, num + (success ? 1 : 0));
                 }
                 break;
 
@@ -1165,7 +1160,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // Drop the signature in pre-segwit scripts but not segwit scripts
                     for (int k = 0; k < nSigsCount; k++)
                     {
-                        valtype& vchSig = stacktop(-isig-k);
+                        const StackElement& vchSig = stacktop(-isig-k);
                         if (sigversion == SigVersion::BASE) {
                             int found = FindAndDelete(scriptCode, CScript() << vchSig);
                             if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
@@ -1176,8 +1171,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     bool fSuccess = true;
                     while (fSuccess && nSigsCount > 0)
                     {
-                        valtype& vchSig    = stacktop(-isig);
-                        valtype& vchPubKey = stacktop(-ikey);
+                        const StackElement& vchSig    = stacktop(-isig);
+                        const StackElement& vchPubKey = stacktop(-ikey);
 
                         // Note how this makes the exact order of pubkey/signature evaluation
                         // distinguishable by CHECKMULTISIG NOT if the STRICTENC flag is set.
@@ -1246,6 +1241,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
             if (stack.size() + altstack.size() > MAX_STACK_SIZE)
                 return set_error(serror, SCRIPT_ERR_STACK_SIZE);
         }
+
+        // Decoding ended at an unparseable instruction.
+        if (!decoded.IsValid())
+            return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
     }
     catch (...)
     {
@@ -1258,183 +1257,2034 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     return set_success(serror);
 }
 
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
+bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
-    ScriptExecutionData execdata;
-    return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
+    const DecodedScript decoded(script);
+    return EvalScript(stack, decoded, flags, checker, sigversion, execdata, serror);
 }
 
-namespace {
-
-/**
- * Wrapper that serializes like CTransaction, but with the modifications
- *  required for the signature hash done in-place
- */
-template <class T>
-class CTransactionSignatureSerializer
-{
-private:
-    const T& txTo;             //!< reference to the spending transaction (the one being serialized)
-    const CScript& scriptCode; //!< output script being consumed
-    const unsigned int nIn;    //!< input index of txTo being signed
-    const bool fAnyoneCanPay;  //!< whether the hashtype has the SIGHASH_ANYONECANPAY flag set
-    const bool fHashSingle;    //!< whether the hashtype is SIGHASH_SINGLE
-    const bool fHashNone;      //!< whether the hashtype is SIGHASH_NONE
-
-public:
-    CTransactionSignatureSerializer(const T& txToIn, const CScript& scriptCodeIn, unsigned int nInIn, int nHashTypeIn) :
-        txTo(txToIn), scriptCode(scriptCodeIn), nIn(nInIn),
-        fAnyoneCanPay(!!(nHashTypeIn & SIGHASH_ANYONECANPAY)),
-        fHashSingle((nHashTypeIn & 0x1f) == SIGHASH_SINGLE),
-        fHashNone((nHashTypeIn & 0x1f) == SIGHASH_NONE) {}
-
-    /** Serialize the passed scriptCode, skipping OP_CODESEPARATORs */
-    template<typename S>
-    void SerializeScriptCode(S &s) const {
-        CScript::const_iterator it = scriptCode.begin();
-        CScript::const_iterator itBegin = it;
-        opcodetype opcode;
-        unsigned int nCodeSeparators = 0;
-        while (scriptCode.GetOp(it, opcode)) {
-            if (opcode == OP_CODESEPARATOR)
-                nCodeSeparators++;
-        }
-        ::WriteCompactSize(s, scriptCode.size() - nCodeSeparators);
-        it = itBegin;
-        while (scriptCode.GetOp(it, opcode)) {
-            if (opcode == OP_CODESEPARATOR) {
-                s.write((char*)&itBegin[0], it-itBegin-1);
-                itBegin = it;
-            }
-        }
-        if (itBegin != scriptCode.end())
-            s.write((char*)&itBegin[0], it-itBegin);
-    }
-
-    /** Serialize an input of txTo */
-    template<typename S>
-    void SerializeInput(S &s, unsigned int nInput) const {
-        // In case of SIGHASH_ANYONECANPAY, only the input being signed is serialized
-        if (fAnyoneCanPay)
-            nInput = nIn;
-        // Serialize the prevout
-        ::Serialize(s, txTo.vin[nInput].prevout);
-        // Serialize the script
-        if (nInput != nIn)
-            // Blank out other inputs' signatures
-            ::Serialize(s, CScript());
-        else
-            SerializeScriptCode(s);
-        // Serialize the nSequence
-        if (nInput != nIn && (fHashSingle || fHashNone))
-            // let the others update at will
-            ::Serialize(s, (int)0);
-        else
-            ::Serialize(s, txTo.vin[nInput].nSequence);
-    }
-
-    /** Serialize an output of txTo */
-    template<typename S>
-    void SerializeOutput(S &s, unsigned int nOutput) const {
-        if (fHashSingle && nOutput != nIn)
-            // Do not lock-in the txout payee at other indices as txin
-            ::Serialize(s, CTxOut());
-        else
-            ::Serialize(s, txTo.vout[nOutput]);
-    }
-
-    /** Serialize txTo */
-    template<typename S>
-    void Serialize(S &s) const {
-        // Serialize nVersion
-        ::Serialize(s, txTo.nVersion);
-        // Serialize vin
-        unsigned int nInputs = fAnyoneCanPay ? 1 : txTo.vin.size();
-        ::WriteCompactSize(s, nInputs);
-        for (unsigned int nInput = 0; nInput < nInputs; nInput++)
-             SerializeInput(s, nInput);
-        // Serialize vout
-        unsigned int nOutputs = fHashNone ? 0 : (fHashSingle ? nIn+1 : txTo.vout.size());
-        ::WriteCompactSize(s, nOutputs);
-        for (unsigned int nOutput = 0; nOutput < nOutputs; nOutput++)
-             SerializeOutput(s, nOutput);
-        // Serialize nLockTime
-        ::Serialize(s, txTo.nLockTime);
-    }
-};
-
-/** Compute the (single) SHA256 of the concatenation of all prevouts of a tx. */
-template <class T>
-uint256 GetPrevoutsSHA256(const T& txTo)
+bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
 {
-    CHashWriter ss(SER_GETHASH, 0);
-    for (const auto& txin : txTo.vin) {
-        ss << txin.prevout;
-    }
-    return ss.GetSHA256();
+    ScriptExecutionData execdata;
+    return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
 }
 
-/** Compute the (single) SHA256 of the concatenation of all nSequences of a tx. */
-template <class T>
-uint256 GetSequencesSHA256(const T& txTo)
+// The opcode switch as it read each instruction from the script bytes, before
+// scripts were decoded ahead of execution. It is not used by verification.
+bool EvalScriptReference(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
-    CHashWriter ss(SER_GETHASH, 0);
-    for (const auto& txin : txTo.vin) {
-        ss << txin.nSequence;
-    }
-    return ss.GetSHA256();
-}
+    static const CScriptNum bnZero(0);
+    static const CScriptNum bnOne(1);
+    // static const CScriptNum bnFalse(0);
+    // static const CScriptNum bnTrue(1);
+    static const valtype vchFalse(0);
+    // static const valtype vchZero(0);
+    static const valtype vchTrue(1, 1);
 
-/** Compute the (single) SHA256 of the concatenation of all txouts of a tx. */
-template <class T>
-uint256 GetOutputsSHA256(const T& txTo)
-{
-    CHashWriter ss(SER_GETHASH, 0);
-    for (const auto& txout : txTo.vout) {
-        ss << txout;
-    }
-    return ss.GetSHA256();
-}
+    // sigversion cannot be TAPROOT here, as it admits no script execution.
+    assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0 || sigversion == SigVersion::TAPSCRIPT);
 
-/** Compute the (single) SHA256 of the concatenation of all amounts spent by a tx. */
-uint256 GetSpentAmountsSHA256(const std::vector<CTxOut>& outputs_spent)
-{
-    CHashWriter ss(SER_GETHASH, 0);
-    for (const auto& txout : outputs_spent) {
-        ss << txout.nValue;
+    CScript::const_iterator pc = script.begin();
+    CScript::const_iterator pend = script.end();
+    CScript::const_iterator pbegincodehash = script.begin();
+    opcodetype opcode;
+    Span<const unsigned char> vchPushValue;
+    ConditionStack vfExec;
+    ScriptStack altstack(stack.arena());
+    set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
+    if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && script.size() > MAX_SCRIPT_SIZE) {
+        return set_error(serror, SCRIPT_ERR_SCRIPT_SIZE);
     }
-    return ss.GetSHA256();
-}
+    int nOpCount = 0;
+    bool fRequireMinimal = (flags & SCRIPT_VERIFY_MINIMALDATA) != 0;
+    uint32_t opcode_pos = 0;
+    execdata.m_codeseparator_pos = 0xFFFFFFFFUL;
+    execdata.m_codeseparator_pos_init = true;
 
-/** Compute the (single) SHA256 of the concatenation of all scriptPubKeys spent by a tx. */
-uint256 GetSpentScriptsSHA256(const std::vector<CTxOut>& outputs_spent)
-{
-    CHashWriter ss(SER_GETHASH, 0);
-    for (const auto& txout : outputs_spent) {
-        ss << txout.scriptPubKey;
-    }
-    return ss.GetSHA256();
-}
+    try
+    {
+        for (; pc < pend; ++opcode_pos) {
+            bool fExec = vfExec.all_true();
 
+            //
+            // Read instruction
+            //
+            if (!script.GetOp(pc, opcode, vchPushValue))
+                return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
+            if (vchPushValue.size() > MAX_SCRIPT_ELEMENT_SIZE)
+                return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
 
-} // namespace
+            if (sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) {
+                // Note how OP_RESERVED does not count towards the opcode limit.
+                if (opcode > OP_16 && ++nOpCount > MAX_OPS_PER_SCRIPT) {
+                    return set_error(serror, SCRIPT_ERR_OP_COUNT);
+                }
+            }
 
-template <class T>
-void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent_outputs)
-{
-    assert(!m_spent_outputs_ready);
+            if (opcode == OP_CAT ||
+                opcode == OP_SUBSTR ||
+                opcode == OP_LEFT ||
+                opcode == OP_RIGHT ||
+                opcode == OP_INVERT ||
+                opcode == OP_AND ||
+                opcode == OP_OR ||
+                opcode == OP_XOR ||
+                opcode == OP_2MUL ||
+                opcode == OP_2DIV ||
+                opcode == OP_MUL ||
+                opcode == OP_DIV ||
+                opcode == OP_MOD ||
+                opcode == OP_LSHIFT ||
+                opcode == OP_RSHIFT)
+                return set_error(serror, SCRIPT_ERR_DISABLED_OPCODE); // Disabled opcodes (CVE-2010-5137).
 
-    m_spent_outputs = std::move(spent_outputs);
-    if (!m_spent_outputs.empty()) {
-        assert(m_spent_outputs.size() == txTo.vin.size());
-        m_spent_outputs_ready = true;
-    }
+            // With SCRIPT_VERIFY_CONST_SCRIPTCODE, OP_CODESEPARATOR in non-segwit script is rejected even in an unexecuted branch
+            if (opcode == OP_CODESEPARATOR && sigversion == SigVersion::BASE && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
+                return set_error(serror, SCRIPT_ERR_OP_CODESEPARATOR);
 
-    // Determine which precomputation-impacting features this transaction uses.
-    bool uses_bip143_segwit = false;
-    bool uses_bip341_taproot = false;
-    for (size_t inpos = 0; inpos < txTo.vin.size(); ++inpos) {
-        if (!txTo.vin[inpos].scriptWitness.IsNull()) {
+            if (fExec && 0 <= opcode && opcode <= OP_PUSHDATA4) {
+                if (fRequireMinimal && !CheckMinimalPush(vchPushValue, opcode)) {
+                    return set_error(serror, SCRIPT_ERR_MINIMALDATA);
+                }
+                stack.push_back(vchPushValue);
+            } else if (fExec || (OP_IF <= opcode && opcode <= OP_ENDIF))
+            switch (opcode)
+            {
+                //
+                // Push value
+                //
+                case OP_1NEGATE:
+                case OP_1:
+                case OP_2:
+                case OP_3:
+                case OP_4:
+                case OP_5:
+                case OP_6:
+                case OP_7:
+                case OP_8:
+                case OP_9:
+                case OP_10:
+                case OP_11:
+                case OP_12:
+                case OP_13:
+                case OP_14:
+                case OP_15:
+                case OP_16:
+                {
+                    // ( -- value)
+                    CScriptNum bn((int)opcode - (int)(OP_1 - 1));
+                    pushnum(stack, bn);
+                    // The result of these opcodes should always be the minimal way to push the data
+                    // they push, so no need for a CheckMinimalPush here.
+                }
+                break;
+
+
+                //
+                // Control
+                //
+                case OP_NOP:
+                    break;
+
+                case OP_CHECKLOCKTIMEVERIFY:
+                {
+                    if (!(flags & SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY)) {
+                        // not enabled; treat as a NOP2
+                        break;
+                    }
+
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    // Note that elsewhere numeric opcodes are limited to
+                    // operands in the range -2**31+1 to 2**31-1, however it is
+                    // legal for opcodes to produce results exceeding that
+                    // range. This limitation is implemented by CScriptNum's
+                    // default 4-byte limit.
+                    //
+                    // If we kept to that limit we'd have a year 2038 problem,
+                    // even though the nLockTime field in transactions
+                    // themselves is uint32 which only becomes meaningless
+                    // after the year 2106.
+                    //
+                    // Thus as a special case we tell CScriptNum to accept up
+                    // to 5-byte bignums, which are good until 2**39-1, well
+                    // beyond the 2**32-1 limit of the nLockTime field itself.
+                    const CScriptNum nLockTime(stacktop(-1), fRequireMinimal, 5);
+
+                    // In the rare event that the argument may be < 0 due to
+                    // some arithmetic being done first, you can always use
+                    // 0 MAX CHECKLOCKTIMEVERIFY.
+                    if (nLockTime < 0)
+                        return set_error(serror, SCRIPT_ERR_NEGATIVE_LOCKTIME);
+
+                    // Actually compare the specified lock time with the transaction.
+                    if (!checker.CheckLockTime(nLockTime))
+                        return set_error(serror, SCRIPT_ERR_UNSATISFIED_LOCKTIME);
+
+                    break;
+                }
+
+                case OP_CHECKSEQUENCEVERIFY:
+                {
+                    if (!(flags & SCRIPT_VERIFY_CHECKSEQUENCEVERIFY)) {
+                        // not enabled; treat as a NOP3
+                        break;
+                    }
+
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    // nSequence, like nLockTime, is a 32-bit unsigned integer
+                    // field. See the comment in CHECKLOCKTIMEVERIFY regarding
+                    // 5-byte numeric operands.
+                    const CScriptNum nSequence(stacktop(-1), fRequireMinimal, 5);
+
+                    // In the rare event that the argument may be < 0 due to
+                    // some arithmetic being done first, you can always use
+                    // 0 MAX CHECKSEQUENCEVERIFY.
+                    if (nSequence < 0)
+                        return set_error(serror, SCRIPT_ERR_NEGATIVE_LOCKTIME);
+
+                    // To provide for future soft-fork extensibility, if the
+                    // operand has the disabled lock-time flag set,
+                    // CHECKSEQUENCEVERIFY behaves as a NOP.
+                    if ((nSequence & CTxIn::SEQUENCE_LOCKTIME_DISABLE_FLAG) != 0)
+                        break;
+
+                    // Compare the specified sequence number with the input.
+                    if (!checker.CheckSequence(nSequence))
+                        return set_error(serror, SCRIPT_ERR_UNSATISFIED_LOCKTIME);
+
+                    break;
+                }
+
+                case OP_NOP1: case OP_NOP4: case OP_NOP5:
+                case OP_NOP6: case OP_NOP7: case OP_NOP8: case OP_NOP9: case OP_NOP10:
+                {
+                    if (flags & SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS)
+                        return set_error(serror, SCRIPT_ERR_DISCOURAGE_UPGRADABLE_NOPS);
+                }
+                break;
+
+                case OP_IF:
+                case OP_NOTIF:
+                {
+                    // <expression> if [statements] [else [statements]] endif
+                    bool fValue = false;
+                    if (fExec)
+                    {
+                        if (stack.size() < 1)
+                            return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+                        const StackElement& vch = stacktop(-1);
+                        // Tapscript requires minimal IF/NOTIF inputs as a consensus rule.
+                        if (sigversion == SigVersion::TAPSCRIPT) {
+                            // The input argument to the OP_IF and OP_NOTIF opcodes must be either
+                            // exactly 0 (the empty vector) or exactly 1 (the one-byte vector with value 1).
+                            if (vch.size() > 1 || (vch.size() == 1 && vch[0] != 1)) {
+                                return set_error(serror, SCRIPT_ERR_TAPSCRIPT_MINIMALIF);
+                            }
+                        }
+                        // Under witness v0 rules it is only a policy rule, enabled through SCRIPT_VERIFY_MINIMALIF.
+                        if (sigversion == SigVersion::WITNESS_V0 && (flags & SCRIPT_VERIFY_MINIMALIF)) {
+                            if (vch.size() > 1)
+                                return set_error(serror, SCRIPT_ERR_MINIMALIF);
+                            if (vch.size() == 1 && vch[0] != 1)
+                                return set_error(serror, SCRIPT_ERR_MINIMALIF);
+                        }
+                        fValue = CastToBool(vch);
+                        if (opcode == OP_NOTIF)
+                            fValue = !fValue;
+                        popstack(stack);
+                    }
+                    vfExec.push_back(fValue);
+                }
+                break;
+
+                case OP_ELSE:
+                {
+                    if (vfExec.empty())
+                        return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+                    vfExec.toggle_top();
+                }
+                break;
+
+                case OP_ENDIF:
+                {
+                    if (vfExec.empty())
+                        return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+                    vfExec.pop_back();
+                }
+                break;
+
+                case OP_VERIFY:
+                {
+                    // (true -- ) or
+                    // (false -- false) and return
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    bool fValue = CastToBool(stacktop(-1));
+                    if (fValue)
+                        popstack(stack);
+                    else
+                        return set_error(serror, SCRIPT_ERR_VERIFY);
+                }
+                break;
+
+                case OP_RETURN:
+                {
+                    return set_error(serror, SCRIPT_ERR_OP_RETURN);
+                }
+                break;
+
+
+                //
+                // Stack ops
+                //
+                case OP_TOALTSTACK:
+                {
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    altstack.push_back(std::move(stacktop(-1)));
+                    popstack(stack);
+                }
+                break;
+
+                case OP_FROMALTSTACK:
+                {
+                    if (altstack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_ALTSTACK_OPERATION);
+                    stack.push_back(std::move(altstacktop(-1)));
+                    popstack(altstack);
+                }
+                break;
+
+                case OP_2DROP:
+                {
+                    // (x1 x2 -- )
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    popstack(stack);
+                    popstack(stack);
+                }
+                break;
+
+                case OP_2DUP:
+                {
+                    // (x1 x2 -- x1 x2 x1 x2)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch1 = stacktop(-2);
+                    StackElement vch2 = stacktop(-1);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
+                }
+                break;
+
+                case OP_3DUP:
+                {
+                    // (x1 x2 x3 -- x1 x2 x3 x1 x2 x3)
+                    if (stack.size() < 3)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch1 = stacktop(-3);
+                    StackElement vch2 = stacktop(-2);
+                    StackElement vch3 = stacktop(-1);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
+                    stack.push_back(std::move(vch3));
+                }
+                break;
+
+                case OP_2OVER:
+                {
+                    // (x1 x2 x3 x4 -- x1 x2 x3 x4 x1 x2)
+                    if (stack.size() < 4)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch1 = stacktop(-4);
+                    StackElement vch2 = stacktop(-3);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
+                }
+                break;
+
+                case OP_2ROT:
+                {
+                    // (x1 x2 x3 x4 x5 x6 -- x3 x4 x5 x6 x1 x2)
+                    if (stack.size() < 6)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch1 = stacktop(-6);
+                    StackElement vch2 = stacktop(-5);
+                    stack.erase(stack.end()-6, stack.end()-4);
+                    stack.push_back(std::move(vch1));
+                    stack.push_back(std::move(vch2));
+                }
+                break;
+
+                case OP_2SWAP:
+                {
+                    // (x1 x2 x3 x4 -- x3 x4 x1 x2)
+                    if (stack.size() < 4)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    swap(stacktop(-4), stacktop(-2));
+                    swap(stacktop(-3), stacktop(-1));
+                }
+                break;
+
+                case OP_IFDUP:
+                {
+                    // (x - 0 | x x)
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch = stacktop(-1);
+                    if (CastToBool(vch))
+                        stack.push_back(std::move(vch));
+                }
+                break;
+
+                case OP_DEPTH:
+                {
+                    // -- stacksize
+                    CScriptNum bn(stack.size());
+                    pushnum(stack, bn);
+                }
+                break;
+
+                case OP_DROP:
+                {
+                    // (x -- )
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    popstack(stack);
+                }
+                break;
+
+                case OP_DUP:
+                {
+                    // (x -- x x)
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch = stacktop(-1);
+                    stack.push_back(std::move(vch));
+                }
+                break;
+
+                case OP_NIP:
+                {
+                    // (x1 x2 -- x2)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    stack.erase(stack.end() - 2);
+                }
+                break;
+
+                case OP_OVER:
+                {
+                    // (x1 x2 -- x1 x2 x1)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch = stacktop(-2);
+                    stack.push_back(std::move(vch));
+                }
+                break;
+
+                case OP_PICK:
+                case OP_ROLL:
+                {
+                    // (xn ... x2 x1 x0 n - xn ... x2 x1 x0 xn)
+                    // (xn ... x2 x1 x0 n - ... x2 x1 x0 xn)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    int n = CScriptNum(stacktop(-1), fRequireMinimal).getint();
+                    popstack(stack);
+                    if (n < 0 || n >= (int)stack.size())
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch = stacktop(-n-1);
+                    if (opcode == OP_ROLL)
+                        stack.erase(stack.end()-n-1);
+                    stack.push_back(std::move(vch));
+                }
+                break;
+
+                case OP_ROT:
+                {
+                    // (x1 x2 x3 -- x2 x3 x1)
+                    //  x2 x1 x3  after first swap
+                    //  x2 x3 x1  after second swap
+                    if (stack.size() < 3)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    swap(stacktop(-3), stacktop(-2));
+                    swap(stacktop(-2), stacktop(-1));
+                }
+                break;
+
+                case OP_SWAP:
+                {
+                    // (x1 x2 -- x2 x1)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    swap(stacktop(-2), stacktop(-1));
+                }
+                break;
+
+                case OP_TUCK:
+                {
+                    // (x1 x2 -- x2 x1 x2)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    StackElement vch = stacktop(-1);
+                    stack.insert(stack.end()-2, std::move(vch));
+                }
+                break;
+
+
+                case OP_SIZE:
+                {
+                    // (in -- in size)
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    CScriptNum bn(stacktop(-1).size());
+                    pushnum(stack, bn);
+                }
+                break;
+
+
+                //
+                // Bitwise logic
+                //
+                case OP_EQUAL:
+                case OP_EQUALVERIFY:
+                //case OP_NOTEQUAL: // use OP_NUMNOTEQUAL
+                {
+                    // (x1 x2 - bool)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    const StackElement& vch1 = stacktop(-2);
+                    const StackElement& vch2 = stacktop(-1);
+                    bool fEqual = (vch1 == vch2);
+                    // OP_NOTEQUAL is disabled because it would be too easy to say
+                    // something like n != 1 and have some wiseguy pass in 1 with extra
+                    // zero bytes after it (numerically, 0x01 == 0x0001 == 0x000001)
+                    //if (opcode == OP_NOTEQUAL)
+                    //    fEqual = !fEqual;
+                    popstack(stack);
+                    popstack(stack);
+                    stack.push_back(fEqual ? vchTrue : vchFalse);
+                    if (opcode == OP_EQUALVERIFY)
+                    {
+                        if (fEqual)
+                            popstack(stack);
+                        else
+                            return set_error(serror, SCRIPT_ERR_EQUALVERIFY);
+                    }
+                }
+                break;
+
+
+                //
+                // Numeric
+                //
+                case OP_1ADD:
+                case OP_1SUB:
+                case OP_NEGATE:
+                case OP_ABS:
+                case OP_NOT:
+                case OP_0NOTEQUAL:
+                {
+                    // (in -- out)
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    CScriptNum bn(stacktop(-1), fRequireMinimal);
+                    switch (opcode)
+                    {
+                    case OP_1ADD:       bn += bnOne; break;
+                    case OP_1SUB:       bn -= bnOne; break;
+                    case OP_NEGATE:     bn = -bn; break;
+                    case OP_ABS:        if (bn < bnZero) bn = -bn; break;
+                    case OP_NOT:        bn = (bn == bnZero); break;
+                    case OP_0NOTEQUAL:  bn = (bn != bnZero); break;
+                    default:            assert(!"invalid opcode"); break;
+                    }
+                    popstack(stack);
+                    pushnum(stack, bn);
+                }
+                break;
+
+                case OP_ADD:
+                case OP_SUB:
+                case OP_BOOLAND:
+                case OP_BOOLOR:
+                case OP_NUMEQUAL:
+                case OP_NUMEQUALVERIFY:
+                case OP_NUMNOTEQUAL:
+                case OP_LESSTHAN:
+                case OP_GREATERTHAN:
+                case OP_LESSTHANOREQUAL:
+                case OP_GREATERTHANOREQUAL:
+                case OP_MIN:
+                case OP_MAX:
+                {
+                    // (x1 x2 -- out)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    CScriptNum bn1(stacktop(-2), fRequireMinimal);
+                    CScriptNum bn2(stacktop(-1), fRequireMinimal);
+                    CScriptNum bn(0);
+                    switch (opcode)
+                    {
+                    case OP_ADD:
+                        bn = bn1 + bn2;
+                        break;
+
+                    case OP_SUB:
+                        bn = bn1 - bn2;
+                        break;
+
+                    case OP_BOOLAND:             bn = (bn1 != bnZero && bn2 != bnZero); break;
+                    case OP_BOOLOR:              bn = (bn1 != bnZero || bn2 != bnZero); break;
+                    case OP_NUMEQUAL:            bn = (bn1 == bn2); break;
+                    case OP_NUMEQUALVERIFY:      bn = (bn1 == bn2); break;
+                    case OP_NUMNOTEQUAL:         bn = (bn1 != bn2); break;
+                    case OP_LESSTHAN:            bn = (bn1 < bn2); break;
+                    case OP_GREATERTHAN:         bn = (bn1 > bn2); break;
+                    case OP_LESSTHANOREQUAL:     bn = (bn1 <= bn2); break;
+                    case OP_GREATERTHANOREQUAL:  bn = (bn1 >= bn2); break;
+                    case OP_MIN:                 bn = (bn1 < bn2 ? bn1 : bn2); break;
+                    case OP_MAX:                 bn = (bn1 > bn2 ? bn1 : bn2); break;
+                    default:                     assert(!"invalid opcode"); break;
+                    }
+                    popstack(stack);
+                    popstack(stack);
+                    pushnum(stack, bn);
+
+                    if (opcode == OP_NUMEQUALVERIFY)
+                    {
+                        if (CastToBool(stacktop(-1)))
+                            popstack(stack);
+                        else
+                            return set_error(serror, SCRIPT_ERR_NUMEQUALVERIFY);
+                    }
+                }
+                break;
+
+                case OP_WITHIN:
+                {
+                    // (x min max -- out)
+                    if (stack.size() < 3)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    CScriptNum bn1(stacktop(-3), fRequireMinimal);
+                    CScriptNum bn2(stacktop(-2), fRequireMinimal);
+                    CScriptNum bn3(stacktop(-1), fRequireMinimal);
+                    bool fValue = (bn2 <= bn1 && bn1 < bn3);
+                    popstack(stack);
+                    popstack(stack);
+                    popstack(stack);
+                    stack.push_back(fValue ? vchTrue : vchFalse);
+                }
+                break;
+
+
+                //
+                // Crypto
+                //
+                case OP_RIPEMD160:
+                case OP_SHA1:
+                case OP_SHA256:
+                case OP_HASH160:
+                case OP_HASH256:
+                {
+                    // (in -- hash)
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    const StackElement& vch = stacktop(-1);
+                    unsigned char vchHash[CSHA256::OUTPUT_SIZE];
+                    const Span<unsigned char> hash(vchHash, (opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32);
+                    if (opcode == OP_RIPEMD160)
+                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(hash.data());
+                    else if (opcode == OP_SHA1)
+                        CSHA1().Write(vch.data(), vch.size()).Finalize(hash.data());
+                    else if (opcode == OP_SHA256)
+                        CSHA256().Write(vch.data(), vch.size()).Finalize(hash.data());
+                    else if (opcode == OP_HASH160)
+                        CHash160().Write(vch).Finalize(hash);
+                    else if (opcode == OP_HASH256)
+                        CHash256().Write(vch).Finalize(hash);
+                    popstack(stack);
+                    stack.push_back(hash);
+                }
+                break;
+
+                case OP_CODESEPARATOR:
+                {
+                    // If SCRIPT_VERIFY_CONST_SCRIPTCODE flag is set, use of OP_CODESEPARATOR is rejected in pre-segwit
+                    // script, even in an unexecuted branch (this is checked above the opcode case statement).
+
+                    // Hash starts after the code separator
+                    pbegincodehash = pc;
+                    execdata.m_codeseparator_pos = opcode_pos;
+                }
+                break;
+
+                case OP_CHECKSIG:
+                case OP_CHECKSIGVERIFY:
+                {
+                    // (sig pubkey -- bool)
+                    if (stack.size() < 2)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    const StackElement& vchSig    = stacktop(-2);
+                    const StackElement& vchPubKey = stacktop(-1);
+
+                    bool fSuccess = true;
+                    if (!EvalChecksig(vchSig, vchPubKey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, fSuccess)) return false;
+                    popstack(stack);
+                    popstack(stack);
+                    stack.push_back(fSuccess ? vchTrue : vchFalse);
+                    if (opcode == OP_CHECKSIGVERIFY)
+                    {
+                        if (fSuccess)
+                            popstack(stack);
+                        else
+                            return set_error(serror, SCRIPT_ERR_CHECKSIGVERIFY);
+                    }
+                }
+                break;
+
+                case OP_CHECKSIGADD:
+                {
+                    // OP_CHECKSIGADD is only available in Tapscript
+                    if (sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
+
+                    // (sig num pubkey -- num)
+                    if (stack.size() < 3) return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    const StackElement& sig = stacktop(-3);
+                    const CScriptNum num(stacktop(-2), fRequireMinimal);
+                    const StackElement& pubkey = stacktop(-1);
+
+                    bool success = true;
+                    if (!EvalChecksig(sig, pubkey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, success)) return false;
+                    popstack(stack);
+                    popstack(stack);
+                    popstack(stack);
+                    pushnum(stack, num + (success ? 1 : 0));
+                }
+                break;
+
+                case OP_CHECKMULTISIG:
+                case OP_CHECKMULTISIGVERIFY:
+                {
+                    if (sigversion == SigVersion::TAPSCRIPT) return set_error(serror, SCRIPT_ERR_TAPSCRIPT_CHECKMULTISIG);
+
+                    // ([sig ...] num_of_signatures [pubkey ...] num_of_pubkeys -- bool)
+
+                    int i = 1;
+                    if ((int)stack.size() < i)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    int nKeysCount = CScriptNum(stacktop(-i), fRequireMinimal).getint();
+                    if (nKeysCount < 0 || nKeysCount > MAX_PUBKEYS_PER_MULTISIG)
+                        return set_error(serror, SCRIPT_ERR_PUBKEY_COUNT);
+                    nOpCount += nKeysCount;
+                    if (nOpCount > MAX_OPS_PER_SCRIPT)
+                        return set_error(serror, SCRIPT_ERR_OP_COUNT);
+                    int ikey = ++i;
+                    // ikey2 is the position of last non-signature item in the stack. Top stack item = 1.
+                    // With SCRIPT_VERIFY_NULLFAIL, this is used for cleanup if operation fails.
+                    int ikey2 = nKeysCount + 2;
+                    i += nKeysCount;
+                    if ((int)stack.size() < i)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    int nSigsCount = CScriptNum(stacktop(-i), fRequireMinimal).getint();
+                    if (nSigsCount < 0 || nSigsCount > nKeysCount)
+                        return set_error(serror, SCRIPT_ERR_SIG_COUNT);
+                    int isig = ++i;
+                    i += nSigsCount;
+                    if ((int)stack.size() < i)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+                    // Subset of script starting at the most recent codeseparator
+                    CScript scriptCode(pbegincodehash, pend);
+
+                    // Drop the signature in pre-segwit scripts but not segwit scripts
+                    for (int k = 0; k < nSigsCount; k++)
+                    {
+                        const StackElement& vchSig = stacktop(-isig-k);
+                        if (sigversion == SigVersion::BASE) {
+                            int found = FindAndDelete(scriptCode, CScript() << vchSig);
+                            if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
+                                return set_error(serror, SCRIPT_ERR_SIG_FINDANDDELETE);
+                        }
+                    }
+
+                    bool fSuccess = true;
+                    while (fSuccess && nSigsCount > 0)
+                    {
+                        const StackElement& vchSig    = stacktop(-isig);
+                        const StackElement& vchPubKey = stacktop(-ikey);
+
+                        // Note how this makes the exact order of pubkey/signature evaluation
+                        // distinguishable by CHECKMULTISIG NOT if the STRICTENC flag is set.
+                        // See the script_(in)valid tests for details.
+                        if (!CheckSignatureEncoding(vchSig, flags, serror) || !CheckPubKeyEncoding(vchPubKey, flags, sigversion, serror)) {
+                            // serror is set
+                            return false;
+                        }
+
+                        // Check signature
+                        bool fOk = checker.CheckECDSASignature(vchSig, vchPubKey, scriptCode, sigversion);
+
+                        if (fOk) {
+                            isig++;
+                            nSigsCount--;
+                        }
+                        ikey++;
+                        nKeysCount--;
+
+                        // If there are more signatures left than keys left,
+                        // then too many signatures have failed. Exit early,
+                        // without checking any further signatures.
+                        if (nSigsCount > nKeysCount)
+                            fSuccess = false;
+                    }
+
+                    // Clean up stack of actual arguments
+                    while (i-- > 1) {
+                        // If the operation failed, we require that all signatures must be empty vector
+                        if (!fSuccess && (flags & SCRIPT_VERIFY_NULLFAIL) && !ikey2 && stacktop(-1).size())
+                            return set_error(serror, SCRIPT_ERR_SIG_NULLFAIL);
+                        if (ikey2 > 0)
+                            ikey2--;
+                        popstack(stack);
+                    }
+
+                    // A bug causes CHECKMULTISIG to consume one extra argument
+                    // whose contents were not checked in any way.
+                    //
+                    // Unfortunately this is a potential source of mutability,
+                    // so optionally verify it is exactly equal to zero prior
+                    // to removing it from the stack.
+                    if (stack.size() < 1)
+                        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+                    if ((flags & SCRIPT_VERIFY_NULLDUMMY) && stacktop(-1).size())
+                        return set_error(serror, SCRIPT_ERR_SIG_NULLDUMMY);
+                    popstack(stack);
+
+                    stack.push_back(fSuccess ? vchTrue : vchFalse);
+
+                    if (opcode == OP_CHECKMULTISIGVERIFY)
+                    {
+                        if (fSuccess)
+                            popstack(stack);
+                        else
+                            return set_error(serror, SCRIPT_ERR_CHECKMULTISIGVERIFY);
+                    }
+                }
+                break;
+
+                default:
+                    return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
+            }
+
+            // Size limits
+            if (stack.size() + altstack.size() > MAX_STACK_SIZE)
+                return set_error(serror, SCRIPT_ERR_STACK_SIZE);
+        }
+    }
+    catch (...)
+    {
+        return set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
+    }
+
+    if (!vfExec.empty())
+        return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+
+    return set_success(serror);
+}
+
+namespace {
+
+struct Evaluation;
+
+/** Execute a decoded instruction, returning false with serror set upon failure. */
+typedef bool (*OpHandler)(Evaluation& eval, const DecodedOp& op);
+
+/** Handlers by opcode while executing, and while within an unexecuted branch. */
+struct OpHandlers
+{
+    OpHandler exec[256];
+    OpHandler skip[256];
+};
+
+//! Handlers instantiated with this flag set read flags at runtime.
+constexpr unsigned int RUNTIME_FLAGS = std::numeric_limits<unsigned int>::max();
+
+/** The state of an evaluation by EvalScriptThreaded, shared by its handlers. */
+struct Evaluation
+{
+    Evaluation(ScriptStack& stack_in, const DecodedScript& decoded_in, unsigned int flags_in, const BaseSignatureChecker& checker_in, SigVersion sigversion_in, const OpHandlers& handlers_in, ScriptExecutionData& execdata_in, ScriptError* serror_in)
+        : stack(stack_in), altstack(stack_in.arena()), decoded(decoded_in), flags(flags_in), checker(checker_in), sigversion(sigversion_in),
+          handlers(handlers_in), execdata(execdata_in), serror(serror_in),
+          pbegincodehash(decoded_in.Script().begin()), table(handlers_in.exec)
+    {
+    }
+
+    ScriptStack& stack;
+    ScriptStack altstack;
+    ConditionStack vfExec;
+    const DecodedScript& decoded;
+    const unsigned int flags;
+    const BaseSignatureChecker& checker;
+    const SigVersion sigversion;
+    const OpHandlers& handlers;
+    ScriptExecutionData& execdata;
+    ScriptError* const serror;
+    CScript::const_iterator pbegincodehash;
+
+    //! The handlers for the current execution state.
+    const OpHandler* table;
+
+    //! The current instruction.
+    size_t index = 0;
+    uint32_t opcode_pos = 0;
+
+    //! No instruction before this one can fail regardless of execution.
+    size_t end = 0;
+
+    //! Instructions from which no static check applies (see StaticEnd).
+    size_t limit = 0;
+
+    //! Public keys counted toward MAX_OPS_PER_SCRIPT by OP_CHECKMULTISIG.
+    int nKeysCounted = 0;
+
+    /** The stack grew, fail if over the combined size limit. */
+    bool Grown() const
+    {
+        if (stack.size() + altstack.size() > MAX_STACK_SIZE)
+            return set_error(serror, SCRIPT_ERR_STACK_SIZE);
+        return true;
+    }
+
+    /**
+     * The first instruction from the current that fails regardless of
+     * execution, given the decoded static failures and the operations counted
+     * so far. The ordinal of an instruction accounts for every counted
+     * instruction before it, executed or not, so unexecuted instructions
+     * require no accounting.
+     */
+    size_t StaticEnd() const
+    {
+        if (sigversion == SigVersion::TAPSCRIPT)
+            return limit;
+        const DecodedScript::Ops& ops = decoded.Instructions();
+        const uint32_t budget = MAX_OPS_PER_SCRIPT - nKeysCounted;
+        return std::partition_point(ops.begin() + index, ops.begin() + limit, [=](const DecodedOp& op) {
+            return op.ordinal <= budget;
+        }) - ops.begin();
+    }
+
+    /** A conditional changed the execution state, select handlers and skip an unexecuted branch if possible. */
+    void Branch(const DecodedOp& op)
+    {
+        if (vfExec.all_true()) {
+            table = handlers.exec;
+            return;
+        }
+        table = handlers.skip;
+        if (op.jump != DecodedOp::NO_JUMP) {
+            // Stop short of a static failure within the branch, which is then reported.
+            const size_t target = std::min<size_t>(op.jump, end);
+            opcode_pos += target - index - 1;
+            index = target - 1;
+        }
+    }
+};
+
+/** Whether a flag is set, resolved at compile time unless FLAGS is RUNTIME_FLAGS. */
+template <unsigned int FLAGS>
+inline bool HasFlag(const Evaluation& eval, unsigned int flag)
+{
+    if constexpr (FLAGS == RUNTIME_FLAGS)
+        return (eval.flags & flag) != 0;
+    else
+        return (FLAGS & flag) != 0;
+}
+
+/** The flags, constant unless FLAGS is RUNTIME_FLAGS. */
+template <unsigned int FLAGS>
+inline unsigned int GetFlags(const Evaluation& eval)
+{
+    if constexpr (FLAGS == RUNTIME_FLAGS)
+        return eval.flags;
+    else
+        return FLAGS;
+}
+
+const unsigned char vchTrue[] = { 1 };
+
+inline void pushbool(ScriptStack& stack, bool value)
+{
+    stack.push_back(value ? Span<const unsigned char>(vchTrue) : Span<const unsigned char>());
+}
+
+//
+// Push value
+//
+template <unsigned int FLAGS>
+bool OpPush(Evaluation& eval, const DecodedOp& op)
+{
+    if (HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA) && !op.minimal)
+        return set_error(eval.serror, SCRIPT_ERR_MINIMALDATA);
+    eval.stack.push_back(eval.decoded.Data(op));
+    return eval.Grown();
+}
+
+bool OpPushNumber(Evaluation& eval, const DecodedOp& op)
+{
+    // ( -- value)
+    pushnum(eval.stack, CScriptNum((int)op.opcode - (int)(OP_1 - 1)));
+    return eval.Grown();
+}
+
+//
+// Control
+//
+bool OpNop(Evaluation&, const DecodedOp&)
+{
+    return true;
+}
+
+bool OpBadOpcode(Evaluation& eval, const DecodedOp&)
+{
+    return set_error(eval.serror, SCRIPT_ERR_BAD_OPCODE);
+}
+
+template <unsigned int FLAGS>
+bool OpUpgradableNop(Evaluation& eval, const DecodedOp&)
+{
+    if (HasFlag<FLAGS>(eval, SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS))
+        return set_error(eval.serror, SCRIPT_ERR_DISCOURAGE_UPGRADABLE_NOPS);
+    return true;
+}
+
+template <unsigned int FLAGS>
+bool OpCheckLockTimeVerify(Evaluation& eval, const DecodedOp&)
+{
+    ScriptStack& stack = eval.stack;
+    if (!HasFlag<FLAGS>(eval, SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY)) {
+        // not enabled; treat as a NOP2
+        return true;
+    }
+
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    // See EvalScript regarding 5-byte numeric operands.
+    const CScriptNum nLockTime(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA), 5);
+    if (nLockTime < 0)
+        return set_error(eval.serror, SCRIPT_ERR_NEGATIVE_LOCKTIME);
+    if (!eval.checker.CheckLockTime(nLockTime))
+        return set_error(eval.serror, SCRIPT_ERR_UNSATISFIED_LOCKTIME);
+    return true;
+}
+
+template <unsigned int FLAGS>
+bool OpCheckSequenceVerify(Evaluation& eval, const DecodedOp&)
+{
+    ScriptStack& stack = eval.stack;
+    if (!HasFlag<FLAGS>(eval, SCRIPT_VERIFY_CHECKSEQUENCEVERIFY)) {
+        // not enabled; treat as a NOP3
+        return true;
+    }
+
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    const CScriptNum nSequence(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA), 5);
+    if (nSequence < 0)
+        return set_error(eval.serror, SCRIPT_ERR_NEGATIVE_LOCKTIME);
+
+    // The disabled lock-time flag makes CHECKSEQUENCEVERIFY a NOP.
+    if ((nSequence & CTxIn::SEQUENCE_LOCKTIME_DISABLE_FLAG) != 0)
+        return true;
+    if (!eval.checker.CheckSequence(nSequence))
+        return set_error(eval.serror, SCRIPT_ERR_UNSATISFIED_LOCKTIME);
+    return true;
+}
+
+template <SigVersion SIGVERSION, unsigned int FLAGS, bool NOT>
+bool OpIf(Evaluation& eval, const DecodedOp& op)
+{
+    // <expression> if [statements] [else [statements]] endif
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+    const StackElement& vch = stacktop(-1);
+    if constexpr (SIGVERSION == SigVersion::TAPSCRIPT) {
+        // Tapscript requires minimal IF/NOTIF inputs as a consensus rule.
+        if (vch.size() > 1 || (vch.size() == 1 && vch[0] != 1))
+            return set_error(eval.serror, SCRIPT_ERR_TAPSCRIPT_MINIMALIF);
+    }
+    if constexpr (SIGVERSION == SigVersion::WITNESS_V0) {
+        // Under witness v0 rules it is only a policy rule, enabled through SCRIPT_VERIFY_MINIMALIF.
+        if (HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALIF) && (vch.size() > 1 || (vch.size() == 1 && vch[0] != 1)))
+            return set_error(eval.serror, SCRIPT_ERR_MINIMALIF);
+    }
+    const bool fValue = CastToBool(vch) != NOT;
+    popstack(stack);
+    eval.vfExec.push_back(fValue);
+    eval.Branch(op);
+    return true;
+}
+
+bool OpIfSkipped(Evaluation& eval, const DecodedOp& op)
+{
+    eval.vfExec.push_back(false);
+    eval.Branch(op);
+    return true;
+}
+
+bool OpElse(Evaluation& eval, const DecodedOp& op)
+{
+    if (eval.vfExec.empty())
+        return set_error(eval.serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+    eval.vfExec.toggle_top();
+    eval.Branch(op);
+    return true;
+}
+
+bool OpEndIf(Evaluation& eval, const DecodedOp&)
+{
+    if (eval.vfExec.empty())
+        return set_error(eval.serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+    eval.vfExec.pop_back();
+    eval.table = eval.vfExec.all_true() ? eval.handlers.exec : eval.handlers.skip;
+    return true;
+}
+
+bool OpVerify(Evaluation& eval, const DecodedOp&)
+{
+    // (true -- ) or
+    // (false -- false) and return
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    if (!CastToBool(stacktop(-1)))
+        return set_error(eval.serror, SCRIPT_ERR_VERIFY);
+    popstack(stack);
+    return true;
+}
+
+bool OpReturn(Evaluation& eval, const DecodedOp&)
+{
+    return set_error(eval.serror, SCRIPT_ERR_OP_RETURN);
+}
+
+//
+// Stack ops
+//
+bool OpToAltStack(Evaluation& eval, const DecodedOp&)
+{
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    eval.altstack.push_back(std::move(stacktop(-1)));
+    popstack(stack);
+    return true;
+}
+
+bool OpFromAltStack(Evaluation& eval, const DecodedOp&)
+{
+    ScriptStack& altstack = eval.altstack;
+    if (altstack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_ALTSTACK_OPERATION);
+    eval.stack.push_back(std::move(altstacktop(-1)));
+    popstack(altstack);
+    return true;
+}
+
+bool Op2Drop(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 -- )
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    popstack(stack);
+    popstack(stack);
+    return true;
+}
+
+/** (xn ... x1 -- xn ... x1 xn ... x1), copying COUNT elements from DEPTH below the top. */
+template <int COUNT, int DEPTH>
+bool OpCopy(Evaluation& eval, const DecodedOp&)
+{
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < DEPTH)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    for (int i = 0; i < COUNT; ++i) {
+        // Copy first, as the push may reallocate the stack.
+        StackElement vch = stacktop(-DEPTH);
+        stack.push_back(std::move(vch));
+    }
+    return eval.Grown();
+}
+
+bool Op2Rot(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 x3 x4 x5 x6 -- x3 x4 x5 x6 x1 x2)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 6)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    StackElement vch1 = stacktop(-6);
+    StackElement vch2 = stacktop(-5);
+    stack.erase(stack.end()-6, stack.end()-4);
+    stack.push_back(std::move(vch1));
+    stack.push_back(std::move(vch2));
+    return true;
+}
+
+bool Op2Swap(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 x3 x4 -- x3 x4 x1 x2)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 4)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    swap(stacktop(-4), stacktop(-2));
+    swap(stacktop(-3), stacktop(-1));
+    return true;
+}
+
+bool OpIfDup(Evaluation& eval, const DecodedOp&)
+{
+    // (x - 0 | x x)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    if (!CastToBool(stacktop(-1)))
+        return true;
+    StackElement vch = stacktop(-1);
+    stack.push_back(std::move(vch));
+    return eval.Grown();
+}
+
+bool OpDepth(Evaluation& eval, const DecodedOp&)
+{
+    // -- stacksize
+    pushnum(eval.stack, CScriptNum(eval.stack.size()));
+    return eval.Grown();
+}
+
+bool OpDrop(Evaluation& eval, const DecodedOp&)
+{
+    // (x -- )
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    popstack(stack);
+    return true;
+}
+
+bool OpNip(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 -- x2)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    stack.erase(stack.end() - 2);
+    return true;
+}
+
+template <unsigned int FLAGS, bool ROLL>
+bool OpPick(Evaluation& eval, const DecodedOp&)
+{
+    // (xn ... x2 x1 x0 n - xn ... x2 x1 x0 xn)
+    // (xn ... x2 x1 x0 n - ... x2 x1 x0 xn)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    int n = CScriptNum(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA)).getint();
+    popstack(stack);
+    if (n < 0 || n >= (int)stack.size())
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    StackElement vch = stacktop(-n-1);
+    if constexpr (ROLL)
+        stack.erase(stack.end()-n-1);
+    stack.push_back(std::move(vch));
+    return true;
+}
+
+bool OpRot(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 x3 -- x2 x3 x1)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 3)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    swap(stacktop(-3), stacktop(-2));
+    swap(stacktop(-2), stacktop(-1));
+    return true;
+}
+
+bool OpSwap(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 -- x2 x1)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    swap(stacktop(-2), stacktop(-1));
+    return true;
+}
+
+bool OpTuck(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 -- x2 x1 x2)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    StackElement vch = stacktop(-1);
+    stack.insert(stack.end()-2, std::move(vch));
+    return eval.Grown();
+}
+
+bool OpSize(Evaluation& eval, const DecodedOp&)
+{
+    // (in -- in size)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    pushnum(stack, CScriptNum(stacktop(-1).size()));
+    return eval.Grown();
+}
+
+//
+// Bitwise logic
+//
+template <bool VERIFY>
+bool OpEqual(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 - bool)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    const bool fEqual = (stacktop(-2) == stacktop(-1));
+    popstack(stack);
+    popstack(stack);
+    if constexpr (VERIFY) {
+        if (!fEqual) {
+            pushbool(stack, false);
+            return set_error(eval.serror, SCRIPT_ERR_EQUALVERIFY);
+        }
+    } else {
+        pushbool(stack, fEqual);
+    }
+    return true;
+}
+
+//
+// Numeric
+//
+template <unsigned int FLAGS, opcodetype OPCODE>
+bool OpUnary(Evaluation& eval, const DecodedOp&)
+{
+    // (in -- out)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    CScriptNum bn(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    if constexpr (OPCODE == OP_1ADD)
+        bn += 1;
+    else if constexpr (OPCODE == OP_1SUB)
+        bn -= 1;
+    else if constexpr (OPCODE == OP_NEGATE)
+        bn = -bn;
+    else if constexpr (OPCODE == OP_ABS)
+        bn = bn < 0 ? -bn : bn;
+    else if constexpr (OPCODE == OP_NOT)
+        bn = (bn == 0);
+    else if constexpr (OPCODE == OP_0NOTEQUAL)
+        bn = (bn != 0);
+    else
+        static_assert(OPCODE == OP_1ADD, "invalid opcode");
+    popstack(stack);
+    pushnum(stack, bn);
+    return true;
+}
+
+template <unsigned int FLAGS, opcodetype OPCODE>
+bool OpBinary(Evaluation& eval, const DecodedOp&)
+{
+    // (x1 x2 -- out)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    const CScriptNum bn1(stacktop(-2), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    const CScriptNum bn2(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    CScriptNum bn(0);
+    if constexpr (OPCODE == OP_ADD)
+        bn = bn1 + bn2;
+    else if constexpr (OPCODE == OP_SUB)
+        bn = bn1 - bn2;
+    else if constexpr (OPCODE == OP_BOOLAND)
+        bn = (bn1 != 0 && bn2 != 0);
+    else if constexpr (OPCODE == OP_BOOLOR)
+        bn = (bn1 != 0 || bn2 != 0);
+    else if constexpr (OPCODE == OP_NUMEQUAL || OPCODE == OP_NUMEQUALVERIFY)
+        bn = (bn1 == bn2);
+    else if constexpr (OPCODE == OP_NUMNOTEQUAL)
+        bn = (bn1 != bn2);
+    else if constexpr (OPCODE == OP_LESSTHAN)
+        bn = (bn1 < bn2);
+    else if constexpr (OPCODE == OP_GREATERTHAN)
+        bn = (bn1 > bn2);
+    else if constexpr (OPCODE == OP_LESSTHANOREQUAL)
+        bn = (bn1 <= bn2);
+    else if constexpr (OPCODE == OP_GREATERTHANOREQUAL)
+        bn = (bn1 >= bn2);
+    else if constexpr (OPCODE == OP_MIN)
+        bn = (bn1 < bn2 ? bn1 : bn2);
+    else if constexpr (OPCODE == OP_MAX)
+        bn = (bn1 > bn2 ? bn1 : bn2);
+    else
+        static_assert(OPCODE == OP_ADD, "invalid opcode");
+    popstack(stack);
+    popstack(stack);
+    pushnum(stack, bn);
+
+    if constexpr (OPCODE == OP_NUMEQUALVERIFY) {
+        if (!CastToBool(stacktop(-1)))
+            return set_error(eval.serror, SCRIPT_ERR_NUMEQUALVERIFY);
+        popstack(stack);
+    }
+    return true;
+}
+
+template <unsigned int FLAGS>
+bool OpWithin(Evaluation& eval, const DecodedOp&)
+{
+    // (x min max -- out)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 3)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    const CScriptNum bn1(stacktop(-3), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    const CScriptNum bn2(stacktop(-2), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    const CScriptNum bn3(stacktop(-1), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    const bool fValue = (bn2 <= bn1 && bn1 < bn3);
+    popstack(stack);
+    popstack(stack);
+    popstack(stack);
+    pushbool(stack, fValue);
+    return true;
+}
+
+//
+// Crypto
+//
+template <opcodetype OPCODE>
+bool OpHash(Evaluation& eval, const DecodedOp&)
+{
+    // (in -- hash)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 1)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    const StackElement& vch = stacktop(-1);
+    unsigned char vchHash[CSHA256::OUTPUT_SIZE];
+    const Span<unsigned char> hash(vchHash, (OPCODE == OP_RIPEMD160 || OPCODE == OP_SHA1 || OPCODE == OP_HASH160) ? 20 : 32);
+    if constexpr (OPCODE == OP_RIPEMD160)
+        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(hash.data());
+    else if constexpr (OPCODE == OP_SHA1)
+        CSHA1().Write(vch.data(), vch.size()).Finalize(hash.data());
+    else if constexpr (OPCODE == OP_SHA256)
+        CSHA256().Write(vch.data(), vch.size()).Finalize(hash.data());
+    else if constexpr (OPCODE == OP_HASH160)
+        CHash160().Write(vch).Finalize(hash);
+    else if constexpr (OPCODE == OP_HASH256)
+        CHash256().Write(vch).Finalize(hash);
+    else
+        static_assert(OPCODE == OP_SHA256, "invalid opcode");
+    popstack(stack);
+    stack.push_back(hash);
+    return true;
+}
+
+bool OpCodeSeparator(Evaluation& eval, const DecodedOp& op)
+{
+    // Hash starts after the code separator
+    eval.pbegincodehash = eval.decoded.Script().begin() + op.end;
+    eval.execdata.m_codeseparator_pos = eval.opcode_pos;
+    return true;
+}
+
+template <SigVersion SIGVERSION, unsigned int FLAGS, bool VERIFY>
+bool OpCheckSig(Evaluation& eval, const DecodedOp&)
+{
+    // (sig pubkey -- bool)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 2)
+        return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    bool fSuccess = true;
+    if (!EvalChecksig(stacktop(-2), stacktop(-1), eval.pbegincodehash, eval.decoded.Script().end(), eval.execdata, GetFlags<FLAGS>(eval), eval.checker, SIGVERSION, eval.serror, fSuccess)) return false;
+    popstack(stack);
+    popstack(stack);
+    if constexpr (VERIFY) {
+        if (!fSuccess) {
+            pushbool(stack, false);
+            return set_error(eval.serror, SCRIPT_ERR_CHECKSIGVERIFY);
+        }
+    } else {
+        pushbool(stack, fSuccess);
+    }
+    return true;
+}
+
+template <unsigned int FLAGS>
+bool OpCheckSigAdd(Evaluation& eval, const DecodedOp&)
+{
+    // (sig num pubkey -- num)
+    ScriptStack& stack = eval.stack;
+    if (stack.size() < 3) return set_error(eval.serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    const CScriptNum num(stacktop(-2), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA));
+    bool success = true;
+    if (!EvalChecksig(stacktop(-3), stacktop(-1), eval.pbegincodehash, eval.decoded.Script().end(), eval.execdata, GetFlags<FLAGS>(eval), eval.checker, SigVersion::TAPSCRIPT, eval.serror, success)) return false;
+    popstack(stack);
+    popstack(stack);
+    popstack(stack);
+    pushnum(stack, num + (success ? 1 : 0));
+    return true;
+}
+
+bool OpCheckMultiSigTapscript(Evaluation& eval, const DecodedOp&)
+{
+    return set_error(eval.serror, SCRIPT_ERR_TAPSCRIPT_CHECKMULTISIG);
+}
+
+template <SigVersion SIGVERSION, unsigned int FLAGS, bool VERIFY>
+bool OpCheckMultiSig(Evaluation& eval, const DecodedOp& op)
+{
+    // ([sig ...] num_of_signatures [pubkey ...] num_of_pubkeys -- bool)
+    ScriptStack& stack = eval.stack;
+    const unsigned int flags = GetFlags<FLAGS>(eval);
+    ScriptError* const serror = eval.serror;
+
+    int i = 1;
+    if ((int)stack.size() < i)
+        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    int nKeysCount = CScriptNum(stacktop(-i), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA)).getint();
+    if (nKeysCount < 0 || nKeysCount > MAX_PUBKEYS_PER_MULTISIG)
+        return set_error(serror, SCRIPT_ERR_PUBKEY_COUNT);
+    eval.nKeysCounted += nKeysCount;
+    if ((int)op.ordinal + eval.nKeysCounted > MAX_OPS_PER_SCRIPT)
+        return set_error(serror, SCRIPT_ERR_OP_COUNT);
+    eval.end = eval.StaticEnd();
+    int ikey = ++i;
+    // ikey2 is the position of last non-signature item in the stack. Top stack item = 1.
+    // With SCRIPT_VERIFY_NULLFAIL, this is used for cleanup if operation fails.
+    int ikey2 = nKeysCount + 2;
+    i += nKeysCount;
+    if ((int)stack.size() < i)
+        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    int nSigsCount = CScriptNum(stacktop(-i), HasFlag<FLAGS>(eval, SCRIPT_VERIFY_MINIMALDATA)).getint();
+    if (nSigsCount < 0 || nSigsCount > nKeysCount)
+        return set_error(serror, SCRIPT_ERR_SIG_COUNT);
+    int isig = ++i;
+    i += nSigsCount;
+    if ((int)stack.size() < i)
+        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+    // Subset of script starting at the most recent codeseparator
+    CScript scriptCode(eval.pbegincodehash, eval.decoded.Script().end());
+
+    // Drop the signature in pre-segwit scripts but not segwit scripts
+    if constexpr (SIGVERSION == SigVersion::BASE) {
+        for (int k = 0; k < nSigsCount; k++) {
+            int found = FindAndDelete(scriptCode, CScript() << stacktop(-isig-k));
+            if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
+                return set_error(serror, SCRIPT_ERR_SIG_FINDANDDELETE);
+        }
+    }
+
+    bool fSuccess = true;
+    while (fSuccess && nSigsCount > 0)
+    {
+        const StackElement& vchSig    = stacktop(-isig);
+        const StackElement& vchPubKey = stacktop(-ikey);
+
+        // Note how this makes the exact order of pubkey/signature evaluation
+        // distinguishable by CHECKMULTISIG NOT if the STRICTENC flag is set.
+        if (!CheckSignatureEncoding(vchSig, flags, serror) || !CheckPubKeyEncoding(vchPubKey, flags, SIGVERSION, serror)) {
+            // serror is set
+            return false;
+        }
+
+        // Check signature
+        bool fOk = eval.checker.CheckECDSASignature(vchSig, vchPubKey, scriptCode, SIGVERSION);
+
+        if (fOk) {
+            isig++;
+            nSigsCount--;
+        }
+        ikey++;
+        nKeysCount--;
+
+        // If there are more signatures left than keys left,
+        // then too many signatures have failed. Exit early,
+        // without checking any further signatures.
+        if (nSigsCount > nKeysCount)
+            fSuccess = false;
+    }
+
+    // Clean up stack of actual arguments
+    while (i-- > 1) {
+        // If the operation failed, we require that all signatures must be empty vector
+        if (!fSuccess && (flags & SCRIPT_VERIFY_NULLFAIL) && !ikey2 && stacktop(-1).size())
+            return set_error(serror, SCRIPT_ERR_SIG_NULLFAIL);
+        if (ikey2 > 0)
+            ikey2--;
+        popstack(stack);
+    }
+
+    // A bug causes CHECKMULTISIG to consume one extra argument
+    // whose contents were not checked in any way.
+    if (stack.size() < 1)
+        return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
+    if ((flags & SCRIPT_VERIFY_NULLDUMMY) && stacktop(-1).size())
+        return set_error(serror, SCRIPT_ERR_SIG_NULLDUMMY);
+    popstack(stack);
+
+    if constexpr (VERIFY) {
+        if (!fSuccess) {
+            pushbool(stack, false);
+            return set_error(serror, SCRIPT_ERR_CHECKMULTISIGVERIFY);
+        }
+    } else {
+        pushbool(stack, fSuccess);
+    }
+    return true;
+}
+
+template <SigVersion SIGVERSION, unsigned int FLAGS>
+constexpr OpHandlers MakeOpHandlers()
+{
+    OpHandlers handlers{};
+    for (int opcode = 0; opcode < 256; ++opcode) {
+        handlers.exec[opcode] = &OpBadOpcode;
+        handlers.skip[opcode] = &OpNop;
+    }
+
+    for (int opcode = OP_0; opcode <= OP_PUSHDATA4; ++opcode)
+        handlers.exec[opcode] = &OpPush<FLAGS>;
+    handlers.exec[OP_1NEGATE] = &OpPushNumber;
+    for (int opcode = OP_1; opcode <= OP_16; ++opcode)
+        handlers.exec[opcode] = &OpPushNumber;
+
+    handlers.exec[OP_NOP] = &OpNop;
+    handlers.exec[OP_IF] = &OpIf<SIGVERSION, FLAGS, false>;
+    handlers.exec[OP_NOTIF] = &OpIf<SIGVERSION, FLAGS, true>;
+    handlers.exec[OP_ELSE] = &OpElse;
+    handlers.exec[OP_ENDIF] = &OpEndIf;
+    handlers.exec[OP_VERIFY] = &OpVerify;
+    handlers.exec[OP_RETURN] = &OpReturn;
+
+    handlers.exec[OP_TOALTSTACK] = &OpToAltStack;
+    handlers.exec[OP_FROMALTSTACK] = &OpFromAltStack;
+    handlers.exec[OP_2DROP] = &Op2Drop;
+    handlers.exec[OP_2DUP] = &OpCopy<2, 2>;
+    handlers.exec[OP_3DUP] = &OpCopy<3, 3>;
+    handlers.exec[OP_2OVER] = &OpCopy<2, 4>;
+    handlers.exec[OP_2ROT] = &Op2Rot;
+    handlers.exec[OP_2SWAP] = &Op2Swap;
+    handlers.exec[OP_IFDUP] = &OpIfDup;
+    handlers.exec[OP_DEPTH] = &OpDepth;
+    handlers.exec[OP_DROP] = &OpDrop;
+    handlers.exec[OP_DUP] = &OpCopy<1, 1>;
+    handlers.exec[OP_NIP] = &OpNip;
+    handlers.exec[OP_OVER] = &OpCopy<1, 2>;
+    handlers.exec[OP_PICK] = &OpPick<FLAGS, false>;
+    handlers.exec[OP_ROLL] = &OpPick<FLAGS, true>;
+    handlers.exec[OP_ROT] = &OpRot;
+    handlers.exec[OP_SWAP] = &OpSwap;
+    handlers.exec[OP_TUCK] = &OpTuck;
+    handlers.exec[OP_SIZE] = &OpSize;
+
+    handlers.exec[OP_EQUAL] = &OpEqual<false>;
+    handlers.exec[OP_EQUALVERIFY] = &OpEqual<true>;
+
+    handlers.exec[OP_1ADD] = &OpUnary<FLAGS, OP_1ADD>;
+    handlers.exec[OP_1SUB] = &OpUnary<FLAGS, OP_1SUB>;
+    handlers.exec[OP_NEGATE] = &OpUnary<FLAGS, OP_NEGATE>;
+    handlers.exec[OP_ABS] = &OpUnary<FLAGS, OP_ABS>;
+    handlers.exec[OP_NOT] = &OpUnary<FLAGS, OP_NOT>;
+    handlers.exec[OP_0NOTEQUAL] = &OpUnary<FLAGS, OP_0NOTEQUAL>;
+    handlers.exec[OP_ADD] = &OpBinary<FLAGS, OP_ADD>;
+    handlers.exec[OP_SUB] = &OpBinary<FLAGS, OP_SUB>;
+    handlers.exec[OP_BOOLAND] = &OpBinary<FLAGS, OP_BOOLAND>;
+    handlers.exec[OP_BOOLOR] = &OpBinary<FLAGS, OP_BOOLOR>;
+    handlers.exec[OP_NUMEQUAL] = &OpBinary<FLAGS, OP_NUMEQUAL>;
+    handlers.exec[OP_NUMEQUALVERIFY] = &OpBinary<FLAGS, OP_NUMEQUALVERIFY>;
+    handlers.exec[OP_NUMNOTEQUAL] = &OpBinary<FLAGS, OP_NUMNOTEQUAL>;
+    handlers.exec[OP_LESSTHAN] = &OpBinary<FLAGS, OP_LESSTHAN>;
+    handlers.exec[OP_GREATERTHAN] = &OpBinary<FLAGS, OP_GREATERTHAN>;
+    handlers.exec[OP_LESSTHANOREQUAL] = &OpBinary<FLAGS, OP_LESSTHANOREQUAL>;
+    handlers.exec[OP_GREATERTHANOREQUAL] = &OpBinary<FLAGS, OP_GREATERTHANOREQUAL>;
+    handlers.exec[OP_MIN] = &OpBinary<FLAGS, OP_MIN>;
+    handlers.exec[OP_MAX] = &OpBinary<FLAGS, OP_MAX>;
+    handlers.exec[OP_WITHIN] = &OpWithin<FLAGS>;
+
+    handlers.exec[OP_RIPEMD160] = &OpHash<OP_RIPEMD160>;
+    handlers.exec[OP_SHA1] = &OpHash<OP_SHA1>;
+    handlers.exec[OP_SHA256] = &OpHash<OP_SHA256>;
+    handlers.exec[OP_HASH160] = &OpHash<OP_HASH160>;
+    handlers.exec[OP_HASH256] = &OpHash<OP_HASH256>;
+    handlers.exec[OP_CODESEPARATOR] = &OpCodeSeparator;
+    handlers.exec[OP_CHECKSIG] = &OpCheckSig<SIGVERSION, FLAGS, false>;
+    handlers.exec[OP_CHECKSIGVERIFY] = &OpCheckSig<SIGVERSION, FLAGS, true>;
+
+    if constexpr (SIGVERSION == SigVersion::TAPSCRIPT) {
+        handlers.exec[OP_CHECKSIGADD] = &OpCheckSigAdd<FLAGS>;
+        handlers.exec[OP_CHECKMULTISIG] = &OpCheckMultiSigTapscript;
+        handlers.exec[OP_CHECKMULTISIGVERIFY] = &OpCheckMultiSigTapscript;
+    } else {
+        handlers.exec[OP_CHECKMULTISIG] = &OpCheckMultiSig<SIGVERSION, FLAGS, false>;
+        handlers.exec[OP_CHECKMULTISIGVERIFY] = &OpCheckMultiSig<SIGVERSION, FLAGS, true>;
+    }
+
+    handlers.exec[OP_NOP1] = &OpUpgradableNop<FLAGS>;
+    handlers.exec[OP_CHECKLOCKTIMEVERIFY] = &OpCheckLockTimeVerify<FLAGS>;
+    handlers.exec[OP_CHECKSEQUENCEVERIFY] = &OpCheckSequenceVerify<FLAGS>;
+    for (int opcode = OP_NOP4; opcode <= OP_NOP10; ++opcode)
+        handlers.exec[opcode] = &OpUpgradableNop<FLAGS>;
+
+    // Within an unexecuted branch only conditionals are evaluated.
+    handlers.skip[OP_IF] = &OpIfSkipped;
+    handlers.skip[OP_NOTIF] = &OpIfSkipped;
+    handlers.skip[OP_VERIF] = &OpBadOpcode;
+    handlers.skip[OP_VERNOTIF] = &OpBadOpcode;
+    handlers.skip[OP_ELSE] = &OpElse;
+    handlers.skip[OP_ENDIF] = &OpEndIf;
+    return handlers;
+}
+
+/** The handlers for a sigversion, with flags fixed to FLAGS. */
+template <unsigned int FLAGS>
+const OpHandlers& GetOpHandlers(SigVersion sigversion)
+{
+    static constexpr OpHandlers base = MakeOpHandlers<SigVersion::BASE, FLAGS>();
+    static constexpr OpHandlers witness_v0 = MakeOpHandlers<SigVersion::WITNESS_V0, FLAGS>();
+    static constexpr OpHandlers tapscript = MakeOpHandlers<SigVersion::TAPSCRIPT, FLAGS>();
+
+    switch (sigversion) {
+    case SigVersion::BASE:
+        return base;
+    case SigVersion::WITNESS_V0:
+        return witness_v0;
+    case SigVersion::TAPSCRIPT:
+        return tapscript;
+    case SigVersion::TAPROOT:
+        // Key path spending in Taproot has no script, so this is unreachable.
+        break;
+    }
+    assert(false);
+    std::abort();
+}
+
+//! The flags that affect evaluation (as opposed to verification) of a script.
+constexpr unsigned int EVAL_FLAGS =
+    SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_DERSIG | SCRIPT_VERIFY_LOW_S |
+    SCRIPT_VERIFY_NULLDUMMY | SCRIPT_VERIFY_MINIMALDATA |
+    SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS | SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY |
+    SCRIPT_VERIFY_CHECKSEQUENCEVERIFY | SCRIPT_VERIFY_MINIMALIF |
+    SCRIPT_VERIFY_NULLFAIL | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE |
+    SCRIPT_VERIFY_CONST_SCRIPTCODE | SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_PUBKEYTYPE;
+
+//! Evaluation flags of the consensus rules as each activated.
+constexpr unsigned int BIP66_EVAL_FLAGS = SCRIPT_VERIFY_DERSIG;
+constexpr unsigned int BIP65_EVAL_FLAGS = BIP66_EVAL_FLAGS | SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
+constexpr unsigned int BIP112_EVAL_FLAGS = BIP65_EVAL_FLAGS | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY;
+constexpr unsigned int BIP147_EVAL_FLAGS = BIP112_EVAL_FLAGS | SCRIPT_VERIFY_NULLDUMMY;
+
+//! Evaluation flags of the standardness policy expressible by verify_flags.
+constexpr unsigned int POLICY_EVAL_FLAGS = BIP147_EVAL_FLAGS |
+    SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_LOW_S | SCRIPT_VERIFY_MINIMALDATA |
+    SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS | SCRIPT_VERIFY_MINIMALIF |
+    SCRIPT_VERIFY_NULLFAIL | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE;
+
+/**
+ * The handlers for a sigversion, specialized for the flags if they are among
+ * the known consensus and policy sets (other flags do not affect evaluation),
+ * and otherwise reading the flags at runtime.
+ */
+const OpHandlers& GetOpHandlers(SigVersion sigversion, unsigned int flags)
+{
+    switch (flags & EVAL_FLAGS) {
+    case SCRIPT_VERIFY_NONE:
+        return GetOpHandlers<SCRIPT_VERIFY_NONE>(sigversion);
+    case BIP66_EVAL_FLAGS:
+        return GetOpHandlers<BIP66_EVAL_FLAGS>(sigversion);
+    case BIP65_EVAL_FLAGS:
+        return GetOpHandlers<BIP65_EVAL_FLAGS>(sigversion);
+    case BIP112_EVAL_FLAGS:
+        return GetOpHandlers<BIP112_EVAL_FLAGS>(sigversion);
+    case BIP147_EVAL_FLAGS:
+        return GetOpHandlers<BIP147_EVAL_FLAGS>(sigversion);
+    case POLICY_EVAL_FLAGS:
+        return GetOpHandlers<POLICY_EVAL_FLAGS>(sigversion);
+    default:
+        return GetOpHandlers<RUNTIME_FLAGS>(sigversion);
+    }
+}
+
+/** The error of an instruction at which a static check fails (see Evaluation::StaticEnd). */
+ScriptError StaticError(const Evaluation& eval, const DecodedOp& op)
+{
+    if (op.size > MAX_SCRIPT_ELEMENT_SIZE)
+        return SCRIPT_ERR_PUSH_SIZE;
+    if (eval.sigversion != SigVersion::TAPSCRIPT && op.opcode > OP_16 && (int)op.ordinal + eval.nKeysCounted > MAX_OPS_PER_SCRIPT)
+        return SCRIPT_ERR_OP_COUNT;
+    if (IsDisabledOpcode(op.opcode))
+        return SCRIPT_ERR_DISABLED_OPCODE;
+    assert(op.opcode == OP_CODESEPARATOR);
+    return SCRIPT_ERR_OP_CODESEPARATOR;
+}
+
+} // namespace
+
+bool EvalScriptThreaded(ScriptStack& stack, const DecodedScript& decoded, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    // sigversion cannot be TAPROOT here, as it admits no script execution.
+    assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0 || sigversion == SigVersion::TAPSCRIPT);
+
+    // Handlers check the stack size only where it grows, so it must start within bounds.
+    if (stack.size() > MAX_STACK_SIZE)
+        return EvalScript(stack, decoded, flags, checker, sigversion, execdata, serror);
+
+    set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
+    if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && decoded.Script().size() > MAX_SCRIPT_SIZE) {
+        return set_error(serror, SCRIPT_ERR_SCRIPT_SIZE);
+    }
+    execdata.m_codeseparator_pos = 0xFFFFFFFFUL;
+    execdata.m_codeseparator_pos_init = true;
+
+    const DecodedScript::Ops& ops = decoded.Instructions();
+    Evaluation eval(stack, decoded, flags, checker, sigversion, GetOpHandlers(sigversion, flags), execdata, serror);
+
+    // With SCRIPT_VERIFY_CONST_SCRIPTCODE, OP_CODESEPARATOR in non-segwit script is rejected even in an unexecuted branch
+    eval.limit = decoded.FailIndex();
+    if (sigversion == SigVersion::BASE && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
+        eval.limit = std::min(eval.limit, decoded.SeparatorIndex());
+    eval.end = eval.StaticEnd();
+
+    // The cancellation check is kept out of the loop of uncancellable scripts.
+    const std::atomic<bool>* const cancelled = checker.Cancellation();
+
+    try
+    {
+        if (cancelled) {
+            for (; eval.index < eval.end; ++eval.index, ++eval.opcode_pos) {
+                if (cancelled->load(std::memory_order_relaxed))
+                    return set_error(serror, SCRIPT_ERR_CANCELLED);
+                const DecodedOp& op = ops[eval.index];
+                if (!eval.table[op.opcode](eval, op))
+                    return false;
+            }
+        } else {
+            for (; eval.index < eval.end; ++eval.index, ++eval.opcode_pos) {
+                const DecodedOp& op = ops[eval.index];
+                if (!eval.table[op.opcode](eval, op))
+                    return false;
+            }
+        }
+
+        if (eval.index < ops.size())
+            return set_error(serror, StaticError(eval, ops[eval.index]));
+
+        // Decoding ended at an unparseable instruction.
+        if (!decoded.IsValid())
+            return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
+    }
+    catch (...)
+    {
+        return set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
+    }
+
+    if (!eval.vfExec.empty())
+        return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
+
+    return set_success(serror);
+}
+
+namespace {
+
+/**
+ * Wrapper that serializes like CTransaction, but with the modifications
+ *  required for the signature hash done in-place
+ */
+template <class T>
+class CTransactionSignatureSerializer
+{
+private:
+    const T& txTo;             //!< reference to the spending transaction (the one being serialized)
+    const CScript& scriptCode; //!< output script being consumed
+    const unsigned int nIn;    //!< input index of txTo being signed
+    const bool fAnyoneCanPay;  //!< whether the hashtype has the SIGHASH_ANYONECANPAY flag set
+    const bool fHashSingle;    //!< whether the hashtype is SIGHASH_SINGLE
+    const bool fHashNone;      //!< whether the hashtype is SIGHASH_NONE
+
+public:
+    CTransactionSignatureSerializer(const T& txToIn, const CScript& scriptCodeIn, unsigned int nInIn, int nHashTypeIn) :
+        txTo(txToIn), scriptCode(scriptCodeIn), nIn(nInIn),
+        fAnyoneCanPay(!!(nHashTypeIn & SIGHASH_ANYONECANPAY)),
+        fHashSingle((nHashTypeIn & 0x1f) == SIGHASH_SINGLE),
+        fHashNone((nHashTypeIn & 0x1f) == SIGHASH_NONE) {}
+
+    /** Serialize the passed scriptCode, skipping OP_CODESEPARATORs */
+    template<typename S>
+    void SerializeScriptCode(S &s) const {
+        CScript::const_iterator it = scriptCode.begin();
+        CScript::const_iterator itBegin = it;
+        opcodetype opcode;
+        unsigned int nCodeSeparators = 0;
+        while (scriptCode.GetOp(it, opcode)) {
+            if (opcode == OP_CODESEPARATOR)
+                nCodeSeparators++;
+        }
+        ::WriteCompactSize(s, scriptCode.size() - nCodeSeparators);
+        it = itBegin;
+        while (scriptCode.GetOp(it, opcode)) {
+            if (opcode == OP_CODESEPARATOR) {
+                s.write((char*)&itBegin[0], it-itBegin-1);
+                itBegin = it;
+            }
+        }
+        if (itBegin != scriptCode.end())
+            s.write((char*)&itBegin[0], it-itBegin);
+    }
+
+    /** Serialize an input of txTo */
+    template<typename S>
+    void SerializeInput(S &s, unsigned int nInput) const {
+        // In case of SIGHASH_ANYONECANPAY, only the input being signed is serialized
+        if (fAnyoneCanPay)
+            nInput = nIn;
+        // Serialize the prevout
+        ::Serialize(s, txTo.vin[nInput].prevout);
+        // Serialize the script
+        if (nInput != nIn)
+            // Blank out other inputs' signatures
+            ::Serialize(s, CScript());
+        else
+            SerializeScriptCode(s);
+        // Serialize the nSequence
+        if (nInput != nIn && (fHashSingle || fHashNone))
+            // let the others update at will
+            ::Serialize(s, (int)0);
+        else
+            ::Serialize(s, txTo.vin[nInput].nSequence);
+    }
+
+    /** Serialize an output of txTo */
+    template<typename S>
+    void SerializeOutput(S &s, unsigned int nOutput) const {
+        if (fHashSingle && nOutput != nIn)
+            // Do not lock-in the txout payee at other indices as txin
+            ::Serialize(s, CTxOut());
+        else
+            ::Serialize(s, txTo.vout[nOutput]);
+    }
+
+    /** Serialize txTo */
+    template<typename S>
+    void Serialize(S &s) const {
+        // Serialize nVersion
+        ::Serialize(s, txTo.nVersion);
+        // Serialize vin
+        unsigned int nInputs = fAnyoneCanPay ? 1 : txTo.vin.size();
+        ::WriteCompactSize(s, nInputs);
+        for (unsigned int nInput = 0; nInput < nInputs; nInput++)
+             SerializeInput(s, nInput);
+        // Serialize vout
+        unsigned int nOutputs = fHashNone ? 0 : (fHashSingle ? nIn+1 : txTo.vout.size());
+        ::WriteCompactSize(s, nOutputs);
+        for (unsigned int nOutput = 0; nOutput < nOutputs; nOutput++)
+             SerializeOutput(s, nOutput);
+        // Serialize nLockTime
+        ::Serialize(s, txTo.nLockTime);
+    }
+};
+
+/** Compute the (single) SHA256 of the concatenation of all prevouts of a tx. */
+template <class T>
+uint256 GetPrevoutsSHA256(const T& txTo)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    for (const auto& txin : txTo.vin) {
+        ss << txin.prevout;
+    }
+    return ss.GetSHA256();
+}
+
+/** Compute the (single) SHA256 of the concatenation of all nSequences of a tx. */
+template <class T>
+uint256 GetSequencesSHA256(const T& txTo)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    for (const auto& txin : txTo.vin) {
+        ss << txin.nSequence;
+    }
+    return ss.GetSHA256();
+}
+
+/** Compute the (single) SHA256 of the concatenation of all txouts of a tx. */
+template <class T>
+uint256 GetOutputsSHA256(const T& txTo)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    for (const auto& txout : txTo.vout) {
+        ss << txout;
+    }
+    return ss.GetSHA256();
+}
+
+/** Compute the (single) SHA256 of the concatenation of all amounts spent by a tx. */
+uint256 GetSpentAmountsSHA256(const std::vector<CTxOut>& outputs_spent)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    for (const auto& txout : outputs_spent) {
+        ss << txout.nValue;
+    }
+    return ss.GetSHA256();
+}
+
+/** Compute the (single) SHA256 of the concatenation of all scriptPubKeys spent by a tx. */
+uint256 GetSpentScriptsSHA256(const std::vector<CTxOut>& outputs_spent)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    for (const auto& txout : outputs_spent) {
+        ss << txout.scriptPubKey;
+    }
+    return ss.GetSHA256();
+}
+
+
+} // namespace
+
+template <class T>
+void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent_outputs)
+{
+    assert(!m_spent_outputs_ready);
+
+    m_spent_outputs = std::move(spent_outputs);
+    if (!m_spent_outputs.empty()) {
+        assert(m_spent_outputs.size() == txTo.vin.size());
+        m_spent_outputs_ready = true;
+    }
+
+    // Determine which precomputation-impacting features this transaction uses.
+    bool uses_bip143_segwit = false;
+    bool uses_bip341_taproot = false;
+    for (size_t inpos = 0; inpos < txTo.vin.size(); ++inpos) {
+        if (!txTo.vin[inpos].scriptWitness.IsNull()) {
             if (m_spent_outputs_ready && m_spent_outputs[inpos].scriptPubKey.size() == 2 + WITNESS_V1_TAPROOT_SIZE &&
                 m_spent_outputs[inpos].scriptPubKey[0] == OP_1) {
                 // Treat every witness-bearing spend with 34-byte scriptPubKey that starts with OP_1 as a Taproot
@@ -1480,8 +3330,10 @@ PrecomputedTransactionData::PrecomputedTransactionData(const T& txTo)
 // explicit instantiation
 template void PrecomputedTransactionData::Init(const CTransaction& txTo, std::vector<CTxOut>&& spent_outputs);
 template void PrecomputedTransactionData::Init(const CMutableTransaction& txTo, std::vector<CTxOut>&& spent_outputs);
+template void PrecomputedTransactionData::Init(const CTransactionView& txTo, std::vector<CTxOut>&& spent_outputs);
 template PrecomputedTransactionData::PrecomputedTransactionData(const CTransaction& txTo);
 template PrecomputedTransactionData::PrecomputedTransactionData(const CMutableTransaction& txTo);
+template PrecomputedTransactionData::PrecomputedTransactionData(const CTransactionView& txTo);
 
 static const CHashWriter HASHER_TAPSIGHASH = TaggedHash("TapSighash");
 static const CHashWriter HASHER_TAPLEAF = TaggedHash("TapLeaf");
@@ -1654,14 +3506,14 @@ bool GenericTransactionSignatureChecker<T>::VerifySchnorrSignature(Span<const un
 }
 
 template <class T>
-bool GenericTransactionSignatureChecker<T>::CheckECDSASignature(const std::vector<unsigned char>& vchSigIn, const std::vector<unsigned char>& vchPubKey, const CScript& scriptCode, SigVersion sigversion) const
+bool GenericTransactionSignatureChecker<T>::CheckECDSASignature(Span<const unsigned char> vchSigIn, Span<const unsigned char> vchPubKey, const CScript& scriptCode, SigVersion sigversion) const
 {
-    CPubKey pubkey(vchPubKey);
+    CPubKey pubkey(vchPubKey.begin(), vchPubKey.end());
     if (!pubkey.IsValid())
         return false;
 
     // Hash type is one byte tacked on to the end of the signature
-    std::vector<unsigned char> vchSig(vchSigIn);
+    std::vector<unsigned char> vchSig(vchSigIn.begin(), vchSigIn.end());
     if (vchSig.empty())
         return false;
     int nHashType = vchSig.back();
@@ -1788,42 +3640,43 @@ bool GenericTransactionSignatureChecker<T>::CheckSequence(const CScriptNum& nSeq
 }
 
 // explicit instantiation
+template uint256 SignatureHash(const CScript& scriptCode, const CTransaction& txTo, unsigned int nIn, int nHashType, const CAmount& amount, SigVersion sigversion, const PrecomputedTransactionData* cache);
+template uint256 SignatureHash(const CScript& scriptCode, const CTransactionView& txTo, unsigned int nIn, int nHashType, const CAmount& amount, SigVersion sigversion, const PrecomputedTransactionData* cache);
 template class GenericTransactionSignatureChecker<CTransaction>;
 template class GenericTransactionSignatureChecker<CMutableTransaction>;
+template class GenericTransactionSignatureChecker<CTransactionView>;
 
-static bool ExecuteWitnessScript(const Span<const valtype>& stack_span, const CScript& scriptPubKey, unsigned int flags, SigVersion sigversion, const BaseSignatureChecker& checker, ScriptExecutionData& execdata, ScriptError* serror)
+static bool ExecuteWitnessScript(const Span<const valtype>& stack_span, const DecodedScript& decoded, unsigned int flags, SigVersion sigversion, const BaseSignatureChecker& checker, ScriptExecutionData& execdata, StackArena& arena, ScriptError* serror)
 {
-    std::vector<valtype> stack{stack_span.begin(), stack_span.end()};
-
     if (sigversion == SigVersion::TAPSCRIPT) {
         // OP_SUCCESSx processing overrides everything, including stack element size limits
-        CScript::const_iterator pc = scriptPubKey.begin();
-        while (pc < scriptPubKey.end()) {
-            opcodetype opcode;
-            if (!scriptPubKey.GetOp(pc, opcode)) {
-                // Note how this condition would not be reached if an unknown OP_SUCCESSx was found
-                return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
-            }
-            // New opcodes will be listed here. May use a different sigversion to modify existing opcodes.
-            if (IsOpSuccess(opcode)) {
-                if (flags & SCRIPT_VERIFY_DISCOURAGE_OP_SUCCESS) {
-                    return set_error(serror, SCRIPT_ERR_DISCOURAGE_OP_SUCCESS);
-                }
-                return set_success(serror);
+        // New opcodes will be listed here. May use a different sigversion to modify existing opcodes.
+        if (decoded.HasOpSuccess()) {
+            if (flags & SCRIPT_VERIFY_DISCOURAGE_OP_SUCCESS) {
+                return set_error(serror, SCRIPT_ERR_DISCOURAGE_OP_SUCCESS);
             }
+            return set_success(serror);
+        }
+        // Note how this condition would not be reached if an unknown OP_SUCCESSx was found
+        if (!decoded.IsValid()) {
+            return set_error(serror, SCRIPT_ERR_BAD_OPCODE);
         }
 
         // Tapscript enforces initial stack size limits (altstack is empty here)
-        if (stack.size() > MAX_STACK_SIZE) return set_error(serror, SCRIPT_ERR_STACK_SIZE);
+        if (stack_span.size() > MAX_STACK_SIZE) return set_error(serror, SCRIPT_ERR_STACK_SIZE);
     }
 
     // Disallow stack item size > MAX_SCRIPT_ELEMENT_SIZE in witness stack
-    for (const valtype& elem : stack) {
+    for (const valtype& elem : stack_span) {
         if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
     }
 
+    // Stack elements are bounded by the above, so may be copied into the arena.
+    ScriptStack stack(arena);
+    stack.assign(stack_span.begin(), stack_span.end());
+
     // Run the script interpreter.
-    if (!EvalScript(stack, scriptPubKey, flags, checker, sigversion, execdata, serror)) return false;
+    if (!EvalScriptThreaded(stack, decoded, flags, checker, sigversion, execdata, serror)) return false;
 
     // Scripts inside witness implicitly require cleanstack behaviour
     if (stack.size() != 1) return set_error(serror, SCRIPT_ERR_CLEANSTACK);
@@ -1852,7 +3705,7 @@ static bool VerifyTaprootCommitment(const std::vector<unsigned char>& control, c
     return q.CheckPayToContract(p, k, control[0] & 1);
 }
 
-static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion, const std::vector<unsigned char>& program, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror, bool is_p2sh)
+static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion, const std::vector<unsigned char>& program, unsigned int flags, const BaseSignatureChecker& checker, StackArena& arena, ScriptError* serror, bool is_p2sh)
 {
     CScript exec_script; //!< Actually executed script (last stack item in P2WSH; implied P2PKH script in P2WPKH; leaf script in P2TR)
     Span<const valtype> stack{witness.stack};
@@ -1865,20 +3718,21 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
                 return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_WITNESS_EMPTY);
             }
             const valtype& script_bytes = SpanPopBack(stack);
-            exec_script = CScript(script_bytes.begin(), script_bytes.end());
             uint256 hash_exec_script;
-            CSHA256().Write(&exec_script[0], exec_script.size()).Finalize(hash_exec_script.begin());
+            CSHA256().Write(script_bytes.data(), script_bytes.size()).Finalize(hash_exec_script.begin());
             if (memcmp(hash_exec_script.begin(), program.data(), 32)) {
                 return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH);
             }
-            return ExecuteWitnessScript(stack, exec_script, flags, SigVersion::WITNESS_V0, checker, execdata, serror);
+            const auto cached = GetDecodedScriptCache().Get(hash_exec_script, script_bytes);
+            return ExecuteWitnessScript(stack, cached->Decoded(), flags, SigVersion::WITNESS_V0, checker, execdata, arena, serror);
         } else if (program.size() == WITNESS_V0_KEYHASH_SIZE) {
             // BIP141 P2WPKH: 20-byte witness v0 program (which encodes Hash160(pubkey))
             if (stack.size() != 2) {
                 return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH); // 2 items in witness
             }
             exec_script << OP_DUP << OP_HASH160 << program << OP_EQUALVERIFY << OP_CHECKSIG;
-            return ExecuteWitnessScript(stack, exec_script, flags, SigVersion::WITNESS_V0, checker, execdata, serror);
+            const DecodedScript decoded(exec_script);
+            return ExecuteWitnessScript(stack, decoded, flags, SigVersion::WITNESS_V0, checker, execdata, arena, serror);
         } else {
             return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_WRONG_LENGTH);
         }
@@ -1917,7 +3771,8 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
                 // Tapscript (leaf version 0xc0)
                 execdata.m_validation_weight_left = ::GetSerializeSize(witness.stack, PROTOCOL_VERSION) + VALIDATION_WEIGHT_OFFSET;
                 execdata.m_validation_weight_left_init = true;
-                return ExecuteWitnessScript(stack, exec_script, flags, SigVersion::TAPSCRIPT, checker, execdata, serror);
+                const auto cached = GetDecodedScriptCache().Get(execdata.m_tapleaf_hash, script_bytes);
+                return ExecuteWitnessScript(stack, cached->Decoded(), flags, SigVersion::TAPSCRIPT, checker, execdata, arena, serror);
             }
             if (flags & SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION) {
                 return set_error(serror, SCRIPT_ERR_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION);
@@ -1935,6 +3790,12 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
 }
 
 bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    StackArena arena;
+    return VerifyScript(scriptSig, scriptPubKey, witness, flags, checker, arena, serror);
+}
+
+bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, StackArena& arena, ScriptError* serror)
 {
     static const CScriptWitness emptyWitness;
     if (witness == nullptr) {
@@ -1950,13 +3811,14 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
 
     // scriptSig and scriptPubKey must be evaluated sequentially on the same stack
     // rather than being simply concatenated (see CVE-2010-5141)
-    std::vector<std::vector<unsigned char> > stack, stackCopy;
-    if (!EvalScript(stack, scriptSig, flags, checker, SigVersion::BASE, serror))
+    ScriptStack stack(arena), stackCopy(arena);
+    ScriptExecutionData execdata;
+    if (!EvalScriptThreaded(stack, DecodedScript(scriptSig), flags, checker, SigVersion::BASE, execdata, serror))
         // serror is set
         return false;
     if (flags & SCRIPT_VERIFY_P2SH)
         stackCopy = stack;
-    if (!EvalScript(stack, scriptPubKey, flags, checker, SigVersion::BASE, serror))
+    if (!EvalScriptThreaded(stack, DecodedScript(scriptPubKey), flags, checker, SigVersion::BASE, execdata, serror))
         // serror is set
         return false;
     if (stack.empty())
@@ -1974,7 +3836,7 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
                 // The scriptSig must be _exactly_ CScript(), otherwise we reintroduce malleability.
                 return set_error(serror, SCRIPT_ERR_WITNESS_MALLEATED);
             }
-            if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /* is_p2sh */ false)) {
+            if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, arena, serror, /* is_p2sh */ false)) {
                 return false;
             }
             // Bypass the cleanstack check at the end. The actual stack is obviously not clean
@@ -1998,11 +3860,14 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
         // an empty stack and the EvalScript above would return false.
         assert(!stack.empty());
 
-        const valtype& pubKeySerialized = stack.back();
-        CScript pubKey2(pubKeySerialized.begin(), pubKeySerialized.end());
+        // The script hash of the P2SH scriptPubKey keys the decoded redeem script.
+        uint256 script_hash;
+        std::copy(scriptPubKey.begin() + 2, scriptPubKey.begin() + 22, script_hash.begin());
+        const auto cached = GetDecodedScriptCache().Get(script_hash, stack.back());
+        const CScript& pubKey2 = cached->Script();
         popstack(stack);
 
-        if (!EvalScript(stack, pubKey2, flags, checker, SigVersion::BASE, serror))
+        if (!EvalScriptThreaded(stack, cached->Decoded(), flags, checker, SigVersion::BASE, execdata, serror))
             // serror is set
             return false;
         if (stack.empty())
@@ -2019,7 +3884,7 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
                     // reintroduce malleability.
                     return set_error(serror, SCRIPT_ERR_WITNESS_MALLEATED_P2SH);
                 }
-                if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /* is_p2sh */ true)) {
+                if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, arena, serror, /* is_p2sh */ true)) {
                     return false;
                 }
                 // Bypass the cleanstack check at the end. The actual stack is obviously not clean
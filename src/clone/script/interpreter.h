@@ -6,10 +6,13 @@
 #ifndef BITCOIN_SCRIPT_INTERPRETER_H
 #define BITCOIN_SCRIPT_INTERPRETER_H
 
+#include <script/decoded.h>
 #include <script/script_error.h>
+#include <script/stack.h>
 #include <span.h>
 #include <primitives/transaction.h>
 
+#include <atomic>
 #include <vector>
 #include <stdint.h>
 
@@ -17,6 +20,7 @@ class CPubKey;
 class XOnlyPubKey;
 class CScript;
 class CTransaction;
+class CTransactionView;
 class CTxOut;
 class uint256;
 
@@ -141,7 +145,7 @@ enum
     SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_PUBKEYTYPE = (1U << 20),
 };
 
-bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned int flags, ScriptError* serror);
+bool CheckSignatureEncoding(Span<const unsigned char> vchSig, unsigned int flags, ScriptError* serror);
 
 struct PrecomputedTransactionData
 {
@@ -224,7 +228,7 @@ uint256 SignatureHash(const CScript& scriptCode, const T& txTo, unsigned int nIn
 class BaseSignatureChecker
 {
 public:
-    virtual bool CheckECDSASignature(const std::vector<unsigned char>&, const std::vector<unsigned char>&, const CScript&, SigVersion) const
+    virtual bool CheckECDSASignature(Span<const unsigned char>, Span<const unsigned char>, const CScript&, SigVersion) const
     {
         return false;
     }
@@ -244,6 +248,12 @@ public:
          return false;
     }
 
+    /** If set, evaluation fails with SCRIPT_ERR_CANCELLED between opcodes once it is true. */
+    virtual const std::atomic<bool>* Cancellation() const
+    {
+        return nullptr;
+    }
+
     virtual ~BaseSignatureChecker() {}
 };
 
@@ -263,7 +273,7 @@ protected:
 public:
     GenericTransactionSignatureChecker(const T* txToIn, unsigned int nInIn, const CAmount& amountIn) : txTo(txToIn), nIn(nInIn), amount(amountIn), txdata(nullptr) {}
     GenericTransactionSignatureChecker(const T* txToIn, unsigned int nInIn, const CAmount& amountIn, const PrecomputedTransactionData& txdataIn) : txTo(txToIn), nIn(nInIn), amount(amountIn), txdata(&txdataIn) {}
-    bool CheckECDSASignature(const std::vector<unsigned char>& scriptSig, const std::vector<unsigned char>& vchPubKey, const CScript& scriptCode, SigVersion sigversion) const override;
+    bool CheckECDSASignature(Span<const unsigned char> scriptSig, Span<const unsigned char> vchPubKey, const CScript& scriptCode, SigVersion sigversion) const override;
     bool CheckSchnorrSignature(Span<const unsigned char> sig, Span<const unsigned char> pubkey, SigVersion sigversion, const ScriptExecutionData& execdata, ScriptError* serror = nullptr) const override;
     bool CheckLockTime(const CScriptNum& nLockTime) const override;
     bool CheckSequence(const CScriptNum& nSequence) const override;
@@ -271,10 +281,24 @@ public:
 
 using TransactionSignatureChecker = GenericTransactionSignatureChecker<CTransaction>;
 using MutableTransactionSignatureChecker = GenericTransactionSignatureChecker<CMutableTransaction>;
-
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* error = nullptr);
+using TransactionViewSignatureChecker = GenericTransactionSignatureChecker<CTransactionView>;
+
+bool EvalScript(ScriptStack& stack, const DecodedScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
+bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
+bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* error = nullptr);
+/** EvalScript reading each instruction with GetOp, retained for differential testing. */
+bool EvalScriptReference(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
+/**
+ * Equivalent to EvalScript, dispatching each instruction through a table of
+ * handlers specific to the sigversion in place of the opcode switch. Checks
+ * that do not depend on execution (push size, operation count and disabled
+ * opcodes) are resolved from the decoding ahead of the loop, and the stack
+ * size is checked only by the handlers of instructions that grow it.
+ */
+bool EvalScriptThreaded(ScriptStack& stack, const DecodedScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
 bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror = nullptr);
+/** As above, with large stack elements allocated from the given (retained) arena. */
+bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, StackArena& arena, ScriptError* serror = nullptr);
 
 size_t CountWitnessSigOps(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags);
 
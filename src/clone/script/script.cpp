@@ -280,11 +280,11 @@ bool CScript::HasValidOps() const
     return true;
 }
 
-bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator end, opcodetype& opcodeRet, std::vector<unsigned char>* pvchRet)
+bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator end, opcodetype& opcodeRet, Span<const unsigned char>* pvchRet)
 {
     opcodeRet = OP_INVALIDOPCODE;
     if (pvchRet)
-        pvchRet->clear();
+        *pvchRet = Span<const unsigned char>();
     if (pc >= end)
         return false;
 
@@ -323,8 +323,8 @@ bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator en
         }
         if (end - pc < 0 || (unsigned int)(end - pc) < nSize)
             return false;
-        if (pvchRet)
-            pvchRet->assign(pc, pc + nSize);
+        if (pvchRet && nSize > 0)
+            *pvchRet = Span<const unsigned char>(&*pc, nSize);
         pc += nSize;
     }
 
@@ -332,6 +332,19 @@ bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator en
     return true;
 }
 
+bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator end, opcodetype& opcodeRet, std::vector<unsigned char>* pvchRet)
+{
+    Span<const unsigned char> data;
+    if (!GetScriptOp(pc, end, opcodeRet, pvchRet ? &data : nullptr)) {
+        if (pvchRet)
+            pvchRet->clear();
+        return false;
+    }
+    if (pvchRet)
+        pvchRet->assign(data.begin(), data.end());
+    return true;
+}
+
 bool IsOpSuccess(const opcodetype& opcode)
 {
     return opcode == 80 || opcode == 98 || (opcode >= 126 && opcode <= 129) ||
@@ -339,3 +352,29 @@ bool IsOpSuccess(const opcodetype& opcode)
            (opcode >= 141 && opcode <= 142) || (opcode >= 149 && opcode <= 153) ||
            (opcode >= 187 && opcode <= 254);
 }
+
+bool CheckMinimalPush(Span<const unsigned char> data, opcodetype opcode)
+{
+    // Excludes OP_1NEGATE, OP_1-16 since they are by definition minimal
+    assert(0 <= opcode && opcode <= OP_PUSHDATA4);
+    if (data.size() == 0) {
+        // Should have used OP_0.
+        return opcode == OP_0;
+    } else if (data.size() == 1 && data[0] >= 1 && data[0] <= 16) {
+        // Should have used OP_1 .. OP_16.
+        return false;
+    } else if (data.size() == 1 && data[0] == 0x81) {
+        // Should have used OP_1NEGATE.
+        return false;
+    } else if (data.size() <= 75) {
+        // Must have used a direct push (opcode indicating number of bytes pushed + those bytes).
+        return opcode == data.size();
+    } else if (data.size() <= 255) {
+        // Must have used OP_PUSHDATA.
+        return opcode == OP_PUSHDATA1;
+    } else if (data.size() <= 65535) {
+        // Must have used OP_PUSHDATA2.
+        return opcode == OP_PUSHDATA2;
+    }
+    return true;
+}
@@ -9,6 +9,7 @@
 #include <crypto/common.h>
 #include <prevector.h>
 #include <serialize.h>
+#include <span.h>
 
 #include <assert.h>
 #include <climits>
@@ -234,7 +235,7 @@ public:
 
     static const size_t nDefaultMaxNumSize = 4;
 
-    explicit CScriptNum(const std::vector<unsigned char>& vch, bool fRequireMinimal,
+    explicit CScriptNum(Span<const unsigned char> vch, bool fRequireMinimal,
                         const size_t nMaxNumSize = nDefaultMaxNumSize)
     {
         if (vch.size() > nMaxNumSize) {
@@ -336,18 +337,35 @@ public:
         return serialize(m_value);
     }
 
+    /** Serialize into a buffer of at least MAX_SERIALIZED_SIZE bytes, returning the size. */
+    size_t getvch(unsigned char* result) const
+    {
+        return serialize(m_value, result);
+    }
+
+    //! The largest serialization of an int64_t (eight bytes and a sign byte).
+    static const size_t MAX_SERIALIZED_SIZE = 9;
+
     static std::vector<unsigned char> serialize(const int64_t& value)
+    {
+        unsigned char result[MAX_SERIALIZED_SIZE];
+        const size_t size = serialize(value, result);
+        return std::vector<unsigned char>(result, result + size);
+    }
+
+    /** Serialize into a buffer of at least MAX_SERIALIZED_SIZE bytes, returning the size. */
+    static size_t serialize(const int64_t& value, unsigned char* result)
     {
         if(value == 0)
-            return std::vector<unsigned char>();
+            return 0;
 
-        std::vector<unsigned char> result;
+        size_t size = 0;
         const bool neg = value < 0;
         uint64_t absvalue = neg ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value);
 
         while(absvalue)
         {
-            result.push_back(absvalue & 0xff);
+            result[size++] = absvalue & 0xff;
             absvalue >>= 8;
         }
 
@@ -361,16 +379,16 @@ public:
 //    0x80 to it, since it will be subtracted and interpreted as a negative when
 //    converting to an integral.
 
-        if (result.back() & 0x80)
-            result.push_back(neg ? 0x80 : 0);
+        if (result[size - 1] & 0x80)
+            result[size++] = neg ? 0x80 : 0;
         else if (neg)
-            result.back() |= 0x80;
+            result[size - 1] |= 0x80;
 
-        return result;
+        return size;
     }
 
 private:
-    static int64_t set_vch(const std::vector<unsigned char>& vch)
+    static int64_t set_vch(Span<const unsigned char> vch)
     {
       if (vch.empty())
           return 0;
@@ -399,6 +417,8 @@ private:
 typedef prevector<28, unsigned char> CScriptBase;
 
 bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator end, opcodetype& opcodeRet, std::vector<unsigned char>* pvchRet);
+/** As above, but the returned push data references the script rather than a copy. */
+bool GetScriptOp(CScriptBase::const_iterator& pc, CScriptBase::const_iterator end, opcodetype& opcodeRet, Span<const unsigned char>* pvchRet);
 
 /** Serialized script, used inside transaction inputs and outputs */
 class CScript : public CScriptBase
@@ -455,6 +475,11 @@ public:
     }
 
     CScript& operator<<(const std::vector<unsigned char>& b)
+    {
+        return *this << MakeSpan(b);
+    }
+
+    CScript& operator<<(Span<const unsigned char> b)
     {
         if (b.size() < OP_PUSHDATA1)
         {
@@ -488,9 +513,14 @@ public:
         return GetScriptOp(pc, end(), opcodeRet, &vchRet);
     }
 
+    bool GetOp(const_iterator& pc, opcodetype& opcodeRet, Span<const unsigned char>& vchRet) const
+    {
+        return GetScriptOp(pc, end(), opcodeRet, &vchRet);
+    }
+
     bool GetOp(const_iterator& pc, opcodetype& opcodeRet) const
     {
-        return GetScriptOp(pc, end(), opcodeRet, nullptr);
+        return GetScriptOp(pc, end(), opcodeRet, static_cast<Span<const unsigned char>*>(nullptr));
     }
 
     /** Encode/decode small integers: */
@@ -572,4 +602,6 @@ struct CScriptWitness
 /** Test for OP_SUCCESSx opcodes as defined by BIP342. */
 bool IsOpSuccess(const opcodetype& opcode);
 
+bool CheckMinimalPush(Span<const unsigned char> data, opcodetype opcode);
+
 #endif // BITCOIN_SCRIPT_SCRIPT_H
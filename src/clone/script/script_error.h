@@ -82,6 +82,9 @@ typedef enum ScriptError_t
     SCRIPT_ERR_OP_CODESEPARATOR,
     SCRIPT_ERR_SIG_FINDANDDELETE,
 
+    /* Evaluation cancelled by the caller */
+    SCRIPT_ERR_CANCELLED,
+
     SCRIPT_ERR_ERROR_COUNT
 } ScriptError;
 
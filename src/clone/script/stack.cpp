@@ -0,0 +1,73 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <script/stack.h>
+
+#include <assert.h>
+
+unsigned char* StackArena::Allocate()
+{
+    if (!m_free.empty()) {
+        unsigned char* slot = m_free.back();
+        m_free.pop_back();
+        RefCount(slot) = 1;
+        return slot;
+    }
+
+    if (m_next == CHUNK_SLOTS) {
+        ++m_chunk;
+        m_next = 0;
+    }
+
+    if (m_chunk == m_chunks.size()) {
+        // Allocated as size_t so that each reference count is aligned.
+        static_assert(SLOT_STRIDE % sizeof(size_t) == 0, "unaligned slot stride");
+        m_chunks.emplace_back(new size_t[CHUNK_SLOTS * SLOT_STRIDE / sizeof(size_t)]);
+
+        // The free list can never exceed the slot count, reserving here
+        // guarantees that Release does not allocate.
+        m_free.reserve(m_chunks.size() * CHUNK_SLOTS);
+    }
+
+    unsigned char* base = reinterpret_cast<unsigned char*>(m_chunks[m_chunk].get());
+    unsigned char* slot = base + SLOT_STRIDE * m_next++ + SLOT_HEADER;
+    RefCount(slot) = 1;
+    return slot;
+}
+
+void StackArena::Release(unsigned char* slot) noexcept
+{
+    assert(RefCount(slot) > 0);
+    if (--RefCount(slot) > 0)
+        return;
+
+    assert(m_free.size() < m_free.capacity());
+    m_free.push_back(slot);
+}
+
+void StackArena::Reset() noexcept
+{
+    m_free.clear();
+    m_chunk = 0;
+    m_next = 0;
+}
+
+std::vector<StackElement> StackArena::AcquireItems()
+{
+    // Reserving here guarantees that ReleaseItems does not allocate.
+    m_stacks.reserve(POOLED_STACKS);
+    if (m_stacks.empty())
+        return {};
+
+    std::vector<StackElement> items(std::move(m_stacks.back()));
+    m_stacks.pop_back();
+    return items;
+}
+
+void StackArena::ReleaseItems(std::vector<StackElement>&& items) noexcept
+{
+    items.clear();
+    if (items.capacity() != 0 && m_stacks.size() < m_stacks.capacity())
+        m_stacks.push_back(std::move(items));
+}
@@ -0,0 +1,299 @@
+// Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SCRIPT_STACK_H
+#define BITCOIN_SCRIPT_STACK_H
+
+#include <script/script.h>
+#include <span.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class StackElement;
+
+/**
+ * Slab of fixed size, reference counted slots backing stack elements that do
+ * not fit inline.
+ *
+ * Every element on an interpreter stack is bounded by MAX_SCRIPT_ELEMENT_SIZE,
+ * so a single slot size suffices and released slots are recycled through a
+ * free list. Chunks are never returned to the allocator, an arena is reset
+ * (not freed) between evaluations so that steady state verification performs
+ * no heap allocation for large elements.
+ *
+ * Slot contents are immutable once written, so elements that duplicate one
+ * another (OP_DUP, OP_PICK, OP_OVER, OP_2DUP, ...) share a slot. An arena is
+ * not thread safe, it is intended to be owned by the evaluating thread.
+ *
+ * The arena also pools the element vectors of the stacks bound to it, so that
+ * the stacks of successive evaluations reuse their capacity.
+ */
+class StackArena
+{
+public:
+    static constexpr size_t SLOT_SIZE = MAX_SCRIPT_ELEMENT_SIZE;
+    static constexpr size_t CHUNK_SLOTS = 16;
+
+    //! Each slot is prefixed by its reference count.
+    static constexpr size_t SLOT_HEADER = sizeof(size_t);
+    static constexpr size_t SLOT_STRIDE = SLOT_HEADER + SLOT_SIZE;
+
+    //! Evaluation holds at most a stack, its copy, an altstack and a witness
+    //! stack at once.
+    static constexpr size_t POOLED_STACKS = 4;
+
+    StackArena() = default;
+    StackArena(const StackArena&) = delete;
+    StackArena& operator=(const StackArena&) = delete;
+
+    /** Obtain a slot of SLOT_SIZE bytes, with a single reference. */
+    unsigned char* Allocate();
+
+    /** Add a reference to a slot obtained from Allocate. */
+    void AddRef(unsigned char* slot) noexcept { ++RefCount(slot); }
+
+    /** Drop a reference to a slot, recycling it when no references remain. */
+    void Release(unsigned char* slot) noexcept;
+
+    /** Rewind to empty, retaining all chunks. No slot may be outstanding. */
+    void Reset() noexcept;
+
+    /** Obtain an empty element vector, with the capacity of one released. */
+    std::vector<StackElement> AcquireItems();
+
+    /** Clear an element vector and retain it for AcquireItems. */
+    void ReleaseItems(std::vector<StackElement>&& items) noexcept;
+
+    /** The number of bytes reserved by the arena. */
+    size_t Capacity() const noexcept { return m_chunks.size() * CHUNK_SLOTS * SLOT_STRIDE; }
+
+private:
+    static size_t& RefCount(unsigned char* slot) noexcept
+    {
+        return *reinterpret_cast<size_t*>(slot - SLOT_HEADER);
+    }
+
+    std::vector<std::unique_ptr<size_t[]>> m_chunks;
+    std::vector<unsigned char*> m_free;
+    std::vector<std::vector<StackElement>> m_stacks;
+    size_t m_chunk = 0;
+    size_t m_next = 0;
+};
+
+/**
+ * A script stack element with inline storage for direct pushes.
+ *
+ * Elements of up to INLINE_SIZE bytes (signatures, public keys, hashes and
+ * numbers) are stored in the element itself. Larger elements reference an
+ * arena slot, which is shared by copies of the element and released to the
+ * arena when the last of them is destroyed. Elements are immutable, a changed
+ * value is a new element, so sharing never requires a copy.
+ */
+class StackElement
+{
+public:
+    //! The largest direct push (opcodes 0x01-0x4b).
+    static constexpr size_t INLINE_SIZE = OP_PUSHDATA1 - 1;
+
+    StackElement() noexcept : m_size(0), m_arena(nullptr) {}
+
+    /** Construct from data, the arena is required only if data exceeds INLINE_SIZE. */
+    explicit StackElement(Span<const unsigned char> data, StackArena* arena = nullptr) : m_size(data.size()), m_arena(nullptr)
+    {
+        assert(m_size <= StackArena::SLOT_SIZE);
+        if (m_size > 0)
+            std::memcpy(Assign(arena), data.data(), m_size);
+    }
+
+    StackElement(const StackElement& other) noexcept : m_size(0), m_arena(nullptr)
+    {
+        Share(other);
+    }
+
+    StackElement(StackElement&& other) noexcept : m_size(0), m_arena(nullptr)
+    {
+        Take(other);
+    }
+
+    StackElement& operator=(const StackElement& other) noexcept
+    {
+        if (this != &other) {
+            Clear();
+            Share(other);
+        }
+        return *this;
+    }
+
+    StackElement& operator=(StackElement&& other) noexcept
+    {
+        if (this != &other) {
+            Clear();
+            Take(other);
+        }
+        return *this;
+    }
+
+    ~StackElement()
+    {
+        Clear();
+    }
+
+    friend void swap(StackElement& a, StackElement& b) noexcept
+    {
+        StackElement temp(std::move(a));
+        a.Take(b);
+        b.Take(temp);
+    }
+
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    const unsigned char* data() const noexcept { return m_arena ? m_heap : m_inline; }
+    const unsigned char* begin() const noexcept { return data(); }
+    const unsigned char* end() const noexcept { return data() + m_size; }
+    const unsigned char& operator[](size_t pos) const noexcept { return data()[pos]; }
+    const unsigned char& back() const noexcept { return data()[m_size - 1]; }
+
+    friend bool operator==(const StackElement& a, const StackElement& b) noexcept
+    {
+        return a.m_size == b.m_size && std::memcmp(a.data(), b.data(), a.m_size) == 0;
+    }
+
+private:
+    void Clear() noexcept
+    {
+        if (m_arena)
+            m_arena->Release(m_heap);
+        m_arena = nullptr;
+        m_size = 0;
+    }
+
+    void Share(const StackElement& other) noexcept
+    {
+        m_size = other.m_size;
+        m_arena = other.m_arena;
+        if (m_arena) {
+            m_heap = other.m_heap;
+            m_arena->AddRef(m_heap);
+        } else {
+            std::memcpy(m_inline, other.m_inline, m_size);
+        }
+    }
+
+    void Take(StackElement& other) noexcept
+    {
+        m_size = other.m_size;
+        m_arena = other.m_arena;
+        if (m_arena)
+            m_heap = other.m_heap;
+        else
+            std::memcpy(m_inline, other.m_inline, m_size);
+        other.m_arena = nullptr;
+        other.m_size = 0;
+    }
+
+    unsigned char* Assign(StackArena* arena)
+    {
+        if (m_size <= INLINE_SIZE)
+            return m_inline;
+
+        assert(arena != nullptr);
+        m_heap = arena->Allocate();
+        m_arena = arena;
+        return m_heap;
+    }
+
+    uint32_t m_size;
+    StackArena* m_arena; //!< Non-null iff the element references an arena slot.
+    union {
+        unsigned char m_inline[INLINE_SIZE];
+        unsigned char* m_heap;
+    };
+};
+
+/**
+ * The interpreter stack, a vector of elements bound to the arena that backs
+ * its large elements. Elements pushed from raw data are placed in the arena.
+ */
+class ScriptStack
+{
+public:
+    typedef std::vector<StackElement>::iterator iterator;
+    typedef std::vector<StackElement>::const_iterator const_iterator;
+
+    explicit ScriptStack(StackArena& arena) : m_arena(&arena), m_items(arena.AcquireItems()) {}
+
+    ScriptStack(const ScriptStack& other) : m_arena(other.m_arena), m_items(m_arena->AcquireItems())
+    {
+        m_items.assign(other.m_items.begin(), other.m_items.end());
+    }
+
+    ScriptStack& operator=(const ScriptStack& other)
+    {
+        if (this != &other)
+            m_items.assign(other.m_items.begin(), other.m_items.end());
+        return *this;
+    }
+
+    ~ScriptStack()
+    {
+        m_arena->ReleaseItems(std::move(m_items));
+    }
+
+    StackArena& arena() const noexcept { return *m_arena; }
+
+    size_t size() const noexcept { return m_items.size(); }
+    bool empty() const noexcept { return m_items.empty(); }
+    void reserve(size_t count) { m_items.reserve(count); }
+    void clear() noexcept { m_items.clear(); }
+    void resize(size_t count) { m_items.resize(count); }
+    void pop_back() { m_items.pop_back(); }
+
+    iterator begin() noexcept { return m_items.begin(); }
+    iterator end() noexcept { return m_items.end(); }
+    const_iterator begin() const noexcept { return m_items.begin(); }
+    const_iterator end() const noexcept { return m_items.end(); }
+    StackElement& at(size_t pos) { return m_items.at(pos); }
+    const StackElement& at(size_t pos) const { return m_items.at(pos); }
+    StackElement& operator[](size_t pos) noexcept { return m_items[pos]; }
+    const StackElement& operator[](size_t pos) const noexcept { return m_items[pos]; }
+    StackElement& front() noexcept { return m_items.front(); }
+    const StackElement& front() const noexcept { return m_items.front(); }
+    StackElement& back() noexcept { return m_items.back(); }
+    const StackElement& back() const noexcept { return m_items.back(); }
+
+    void push_back(const StackElement& element) { m_items.push_back(element); }
+    void push_back(StackElement&& element) { m_items.push_back(std::move(element)); }
+    void push_back(Span<const unsigned char> data) { m_items.emplace_back(data, m_arena); }
+    iterator insert(const_iterator position, const StackElement& element) { return m_items.insert(position, element); }
+    iterator insert(const_iterator position, StackElement&& element) { return m_items.insert(position, std::move(element)); }
+    iterator erase(const_iterator position) { return m_items.erase(position); }
+    iterator erase(const_iterator first, const_iterator last) { return m_items.erase(first, last); }
+
+    /** Replace the contents with copies of the given data elements. */
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last)
+    {
+        m_items.clear();
+        for (; first != last; ++first)
+            push_back(MakeSpan(*first));
+    }
+
+    friend void swap(ScriptStack& a, ScriptStack& b) noexcept
+    {
+        std::swap(a.m_arena, b.m_arena);
+        a.m_items.swap(b.m_items);
+    }
+
+private:
+    StackArena* m_arena;
+    std::vector<StackElement> m_items;
+};
+
+#endif // BITCOIN_SCRIPT_STACK_H
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/consensus.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/export.hpp>
+#include <bitcoin/consensus/version.hpp>
+#include "consensus/consensus.hpp"
+
+using namespace libbitcoin::consensus;
+
+// The C values must remain those of the C++ interface.
+#define BCK_C_VALUE(name) \
+    static_assert(static_cast<int64_t>(bck_##name) == \
+        static_cast<int64_t>(name), #name)
+
+BCK_C_VALUE(verify_result_eval_false);
+BCK_C_VALUE(verify_result_eval_true);
+BCK_C_VALUE(verify_result_script_size);
+BCK_C_VALUE(verify_result_push_size);
+BCK_C_VALUE(verify_result_op_count);
+BCK_C_VALUE(verify_result_stack_size);
+BCK_C_VALUE(verify_result_sig_count);
+BCK_C_VALUE(verify_result_pubkey_count);
+BCK_C_VALUE(verify_result_verify);
+BCK_C_VALUE(verify_result_equalverify);
+BCK_C_VALUE(verify_result_checkmultisigverify);
+BCK_C_VALUE(verify_result_checksigverify);
+BCK_C_VALUE(verify_result_numequalverify);
+BCK_C_VALUE(verify_result_bad_opcode);
+BCK_C_VALUE(verify_result_disabled_opcode);
+BCK_C_VALUE(verify_result_invalid_stack_operation);
+BCK_C_VALUE(verify_result_invalid_altstack_operation);
+BCK_C_VALUE(verify_result_unbalanced_conditional);
+BCK_C_VALUE(verify_result_sig_hashtype);
+BCK_C_VALUE(verify_result_sig_der);
+BCK_C_VALUE(verify_result_minimaldata);
+BCK_C_VALUE(verify_result_sig_pushonly);
+BCK_C_VALUE(verify_result_sig_high_s);
+BCK_C_VALUE(verify_result_sig_nulldummy);
+BCK_C_VALUE(verify_result_pubkeytype);
+BCK_C_VALUE(verify_result_cleanstack);
+BCK_C_VALUE(verify_result_minimalif);
+BCK_C_VALUE(verify_result_sig_nullfail);
+BCK_C_VALUE(verify_result_discourage_upgradable_nops);
+BCK_C_VALUE(verify_result_discourage_upgradable_witness_program);
+BCK_C_VALUE(verify_result_op_return);
+BCK_C_VALUE(verify_result_unknown_error);
+BCK_C_VALUE(verify_result_witness_program_wrong_length);
+BCK_C_VALUE(verify_result_witness_program_empty_witness);
+BCK_C_VALUE(verify_result_witness_program_mismatch);
+BCK_C_VALUE(verify_result_witness_malleated);
+BCK_C_VALUE(verify_result_witness_malleated_p2sh);
+BCK_C_VALUE(verify_result_witness_unexpected);
+BCK_C_VALUE(verify_result_witness_pubkeytype);
+BCK_C_VALUE(verify_result_tx_invalid);
+BCK_C_VALUE(verify_result_tx_size_invalid);
+BCK_C_VALUE(verify_result_tx_input_invalid);
+BCK_C_VALUE(verify_result_negative_locktime);
+BCK_C_VALUE(verify_result_unsatisfied_locktime);
+BCK_C_VALUE(verify_value_overflow);
+BCK_C_VALUE(verify_evaluation_throws);
+BCK_C_VALUE(verify_result_block_invalid);
+BCK_C_VALUE(verify_result_block_prevouts_invalid);
+BCK_C_VALUE(verify_result_tx_inputs_empty);
+BCK_C_VALUE(verify_result_tx_outputs_empty);
+BCK_C_VALUE(verify_result_tx_oversize);
+BCK_C_VALUE(verify_result_tx_output_value_invalid);
+BCK_C_VALUE(verify_result_tx_outputs_value_overflow);
+BCK_C_VALUE(verify_result_tx_inputs_duplicate);
+BCK_C_VALUE(verify_result_tx_coinbase_script_size);
+BCK_C_VALUE(verify_result_tx_prevout_null);
+BCK_C_VALUE(verify_result_tx_not_final);
+BCK_C_VALUE(verify_result_tx_sequence_locked);
+BCK_C_VALUE(verify_result_tx_confirmations_invalid);
+BCK_C_VALUE(verify_result_block_merkle_mutated);
+BCK_C_VALUE(verify_result_block_merkle_mismatch);
+BCK_C_VALUE(verify_result_block_witness_nonce_size);
+BCK_C_VALUE(verify_result_block_witness_mismatch);
+BCK_C_VALUE(verify_result_block_witness_uncommitted);
+BCK_C_VALUE(verify_result_block_witness_unexpected);
+BCK_C_VALUE(verify_result_cancelled);
+
+BCK_C_VALUE(verify_flags_none);
+BCK_C_VALUE(verify_flags_p2sh);
+BCK_C_VALUE(verify_flags_strictenc);
+BCK_C_VALUE(verify_flags_dersig);
+BCK_C_VALUE(verify_flags_low_s);
+BCK_C_VALUE(verify_flags_nulldummy);
+BCK_C_VALUE(verify_flags_sigpushonly);
+BCK_C_VALUE(verify_flags_minimaldata);
+BCK_C_VALUE(verify_flags_discourage_upgradable_nops);
+BCK_C_VALUE(verify_flags_cleanstack);
+BCK_C_VALUE(verify_flags_checklocktimeverify);
+BCK_C_VALUE(verify_flags_checksequenceverify);
+BCK_C_VALUE(verify_flags_witness);
+BCK_C_VALUE(verify_flags_discourage_upgradable_witness_program);
+BCK_C_VALUE(verify_flags_minimal_if);
+BCK_C_VALUE(verify_flags_null_fail);
+BCK_C_VALUE(verify_flags_witness_public_key_compressed);
+BCK_C_VALUE(verify_flags_all);
+
+#undef BCK_C_VALUE
+
+// The C structs are read in place as the C++ references, which have the
+// same members, so that a transaction's prevouts are not copied.
+#define BCK_C_MEMBER(c_type, cpp_type, member) \
+    static_assert(offsetof(c_type, member) == offsetof(cpp_type, member) && \
+        sizeof(c_type::member) == sizeof(cpp_type::member), #member)
+
+static_assert(sizeof(bck_output) == sizeof(output_reference), "bck_output");
+BCK_C_MEMBER(bck_output, output_reference, script);
+BCK_C_MEMBER(bck_output, output_reference, script_size);
+BCK_C_MEMBER(bck_output, output_reference, value);
+
+static_assert(sizeof(bck_transaction) == sizeof(transaction_reference),
+    "bck_transaction");
+BCK_C_MEMBER(bck_transaction, transaction_reference, transaction);
+BCK_C_MEMBER(bck_transaction, transaction_reference, transaction_size);
+BCK_C_MEMBER(bck_transaction, transaction_reference, prevouts);
+BCK_C_MEMBER(bck_transaction, transaction_reference, prevouts_size);
+
+static_assert(sizeof(bck_result::code) == sizeof(verify_result) &&
+    offsetof(bck_result, code) == 0, "bck_result");
+
+#undef BCK_C_MEMBER
+
+static const output_reference& reference(const bck_output& prevout)
+{
+    return reinterpret_cast<const output_reference&>(prevout);
+}
+
+static const transaction_reference& reference(
+    const bck_transaction& transaction)
+{
+    return reinterpret_cast<const transaction_reference&>(transaction);
+}
+
+static verify_result& result_code(bck_result& result)
+{
+    return reinterpret_cast<verify_result&>(result.code);
+}
+
+// The input is only meaningful for a script failure.
+static bck_result to_result(verify_result code, uint32_t input)
+{
+    switch (code)
+    {
+        case verify_result_eval_true:
+        case verify_result_tx_invalid:
+        case verify_result_tx_size_invalid:
+        case verify_result_tx_input_invalid:
+            return { code, 0 };
+        default:
+            return { code, input };
+    }
+}
+
+const char* bck_version(void)
+{
+    return LIBBITCOIN_CONSENSUS_VERSION;
+}
+
+int32_t bck_verify_script(const uint8_t* transaction,
+    size_t transaction_size, const bck_output* prevout, uint32_t input_index,
+    uint32_t flags)
+{
+    if (prevout == nullptr)
+        return verify_result_tx_input_invalid;
+
+    return verify_script(transaction, transaction_size, reference(*prevout),
+        input_index, flags);
+}
+
+int32_t bck_verify_transaction(bck_result* result,
+    const bck_transaction* transaction, uint32_t flags)
+{
+    if (transaction == nullptr)
+        return verify_result_tx_invalid;
+
+    bck_result out;
+    auto& target = result != nullptr ? *result : out;
+
+    try
+    {
+        return verify_transactions(default_pool(), &result_code(target),
+            &target.input, sizeof(bck_result), &reference(*transaction), 1,
+            flags, { nullptr, false, false, verify_lane_block });
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+int32_t bck_verify_transactions(bck_result* results,
+    const bck_transaction* transactions, size_t count, uint32_t flags,
+    size_t threads)
+{
+    if (count == 0)
+        return verify_result_eval_true;
+
+    if (results == nullptr || transactions == nullptr)
+        return verify_result_tx_invalid;
+
+    if (threads == 1)
+    {
+        uint32_t input;
+        for (size_t index = 0; index < count; ++index)
+        {
+            const auto code = verify_transaction(reference(transactions[index]),
+                flags, input);
+            results[index] = to_result(code, input);
+        }
+    }
+    else
+    {
+        // The codes and inputs are written in place to the results.
+        try
+        {
+            verify_transactions(default_pool(), &result_code(*results),
+                &results->input, sizeof(bck_result), &reference(*transactions),
+                count, flags, { nullptr, false, false, verify_lane_block });
+        }
+        catch (const std::exception&)
+        {
+            return verify_evaluation_throws;
+        }
+    }
+
+    for (size_t index = 0; index < count; ++index)
+        if (results[index].code != verify_result_eval_true)
+            return results[index].code;
+
+    return verify_result_eval_true;
+}
@@ -18,18 +18,33 @@
  */
 #include "consensus/consensus.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string.h>
+#include <utility>
+#include <vector>
 #include <bitcoin/consensus/define.hpp>
 #include <bitcoin/consensus/export.hpp>
 #include <bitcoin/consensus/version.hpp>
+#include "consensus/consensus.h"
+#include "consensus/cost.h"
+#include "consensus/merkle.h"
+#include "consensus/pipeline.hpp"
+#include "consensus/pool.hpp"
+#include "consensus/tx_check.h"
+#include "consensus/tx_verify.h"
+#include "crypto/sha256.h"
+#include "hash.h"
 #include "primitives/transaction.h"
+#include "primitives/transaction_view.h"
 #include "pubkey.h"
 #include "script/interpreter.h"
 #include "script/script_error.h"
@@ -41,7 +56,159 @@ namespace consensus {
 // Initialize libsecp256k1 context.
 static auto secp256k1_context = ECCVerifyHandle();
 
-// Helper class, not published. This is tested internal to verify_script.
+// Select the widest available double-SHA256 transforms for merkle trees.
+static const auto sha256_implementation = SHA256AutoDetect();
+
+// Storage retained by a verification context across calls.
+struct verification_context::implementation
+{
+    // Large stack elements and the stacks themselves.
+    StackArena arena;
+
+    // The transaction being verified and copies of its scripts.
+    CTransactionView transaction;
+    CScript input_script;
+    CScript output_script;
+    CScriptWitness witness;
+
+    // The outpoints of a block and the outputs that they reference.
+    std::vector<outpoint> outpoints;
+    std::vector<output_reference> spent;
+
+    // Transaction checks, the inputs seen and their confirmations.
+    OutpointSet inputs;
+    std::vector<CoinConfirmation> coins;
+
+    // The txids and wtxids of a block, overwritten by its merkle trees.
+    std::vector<uint256> hashes;
+    std::vector<uint256> witness_hashes;
+
+    // Signatures verified through the context.
+    uint64_t signature_checks = 0;
+};
+
+verification_context::verification_context()
+  : implementation_(std::make_unique<implementation>())
+{
+}
+
+verification_context::~verification_context() = default;
+
+verification_context::implementation& get_implementation(
+    verification_context& context) noexcept
+{
+    return *context.implementation_;
+}
+
+bool prevout_provider::get_batch(output_reference* out,
+    const outpoint* outpoints, size_t count)
+{
+    for (size_t index = 0; index < count; ++index)
+        if (!get(out[index], outpoints[index]))
+            return false;
+
+    return true;
+}
+
+void prevout_provider::prefetch(const outpoint*, size_t)
+{
+}
+
+prevout_provider::~prevout_provider() = default;
+
+uint64_t verification_context::signature_checks() const noexcept
+{
+    return implementation_->signature_checks;
+}
+
+cancellation::cancellation() noexcept
+  : cancelled_(false)
+{
+}
+
+void cancellation::cancel() noexcept
+{
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+void cancellation::reset() noexcept
+{
+    cancelled_.store(false, std::memory_order_relaxed);
+}
+
+bool cancellation::cancelled() const noexcept
+{
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+const std::atomic<bool>& cancellation::get() const noexcept
+{
+    return cancelled_;
+}
+
+// A transaction view checker that counts the signatures it verifies.
+class counting_signature_checker
+  : public TransactionViewSignatureChecker
+{
+public:
+    counting_signature_checker(const CTransactionView* tx,
+        unsigned int input_index, const CAmount& amount,
+        const PrecomputedTransactionData* txdata, uint64_t& count,
+        const std::atomic<bool>* cancelled)
+      : TransactionViewSignatureChecker(txdata == nullptr ?
+            TransactionViewSignatureChecker(tx, input_index, amount) :
+            TransactionViewSignatureChecker(tx, input_index, amount, *txdata)),
+        count_(count),
+        cancelled_(cancelled)
+    {
+    }
+
+    const std::atomic<bool>* Cancellation() const override
+    {
+        return cancelled_;
+    }
+
+protected:
+    bool VerifyECDSASignature(const std::vector<unsigned char>& signature,
+        const CPubKey& key, const uint256& sighash) const override
+    {
+        ++count_;
+        return TransactionViewSignatureChecker::VerifyECDSASignature(
+            signature, key, sighash);
+    }
+
+    bool VerifySchnorrSignature(Span<const unsigned char> signature,
+        const XOnlyPubKey& key, const uint256& sighash) const override
+    {
+        ++count_;
+        return TransactionViewSignatureChecker::VerifySchnorrSignature(
+            signature, key, sighash);
+    }
+
+private:
+    uint64_t& count_;
+    const std::atomic<bool>* cancelled_;
+};
+
+// The context of calls that do not provide one, retained by each thread so
+// that once warm script evaluation does not allocate for its stacks.
+static verification_context& thread_context()
+{
+    thread_local verification_context context;
+    return context;
+}
+
+// Copies the witness into the retained stack, reusing its capacity.
+static void assign_witness(CScriptWitness& out, const CWitnessView& witness)
+{
+    out.stack.resize(witness.size());
+    auto item = out.stack.begin();
+    for (const auto data: witness)
+        (item++)->assign(data.begin(), data.end());
+}
+
+// Helper class, not published. This is tested internal to verify_script and
+// verify_block.
 class transaction_istream
 {
 public:
@@ -63,10 +230,24 @@ public:
             throw std::ios_base::failure("end of data");
 
         memcpy(destination, source_, size);
+        skip(size);
+    }
+
+    void skip(size_t size)
+    {
+        if (size > remaining_)
+            throw std::ios_base::failure("end of data");
+
         remaining_ -= size;
         source_ += size;
     }
 
+    // The unread data, which may be parsed in place and then skipped.
+    Span<const uint8_t> unread() const
+    {
+        return { source_, remaining_ };
+    }
+
     int GetType() const
     {
         return SER_NETWORK;
@@ -186,6 +367,8 @@ verify_result script_error_to_verify_result(ScriptError_t code) noexcept
         // Other
         case SCRIPT_ERR_OP_RETURN:
             return verify_result_op_return;
+        case SCRIPT_ERR_CANCELLED:
+            return verify_result_cancelled;
         case SCRIPT_ERR_UNKNOWN_ERROR:
         case SCRIPT_ERR_ERROR_COUNT:
         default:
@@ -236,6 +419,97 @@ unsigned int verify_flags_to_script_flags(uint32_t flags) noexcept
     return script_flags;
 }
 
+// Evaluates a script against the stack with either script interpreter, so
+// that the two may be compared. Signature checks and lock times fail.
+// This function is not published (but non-static for testability).
+ScriptError_t evaluate_script(stack& data, const chunk& script,
+    unsigned int script_flags, SigVersion sigversion,
+    script_engine engine) noexcept
+{
+    ScriptError_t error = SCRIPT_ERR_UNKNOWN_ERROR;
+    const BaseSignatureChecker checker;
+    const CScript cscript(script.begin(), script.end());
+    const DecodedScript decoded(cscript);
+
+    // Admits a single successful tapscript signature check.
+    ScriptExecutionData execdata;
+    execdata.m_validation_weight_left_init = true;
+    execdata.m_validation_weight_left = VALIDATION_WEIGHT_OFFSET;
+
+    try
+    {
+        StackArena arena;
+        ScriptStack evaluated(arena);
+        evaluated.assign(data.begin(), data.end());
+
+        switch (engine)
+        {
+            case script_engine::reference:
+                EvalScriptReference(evaluated, cscript, script_flags, checker,
+                    sigversion, execdata, &error);
+                break;
+            case script_engine::decoded:
+                EvalScript(evaluated, decoded, script_flags, checker,
+                    sigversion, execdata, &error);
+                break;
+            case script_engine::threaded:
+                EvalScriptThreaded(evaluated, decoded, script_flags, checker,
+                    sigversion, execdata, &error);
+                break;
+        }
+
+        data.clear();
+        for (const auto& element: evaluated)
+            data.emplace_back(element.begin(), element.end());
+    }
+    catch (const std::exception&)
+    {
+        return SCRIPT_ERR_UNKNOWN_ERROR;
+    }
+
+    return error;
+}
+
+// Computes a signature hash over either transaction representation, so that
+// the two may be compared. Returns false if the transaction does not parse.
+// This function is not published (but non-static for testability).
+bool signature_hash(uint256& out, const chunk& transaction,
+    uint32_t input_index, const chunk& script_code, uint64_t value,
+    int hash_type, SigVersion sigversion, bool view) noexcept
+{
+    const CScript code(script_code.begin(), script_code.end());
+    const CAmount amount(static_cast<int64_t>(value));
+
+    try
+    {
+        if (view)
+        {
+            const CTransactionView tx(MakeSpan(transaction));
+            if (input_index >= tx.vin.size())
+                return false;
+
+            out = SignatureHash(code, tx, input_index, hash_type, amount,
+                sigversion);
+        }
+        else
+        {
+            transaction_istream stream(transaction.data(), transaction.size());
+            const CTransaction tx(deserialize, stream);
+            if (input_index >= tx.vin.size())
+                return false;
+
+            out = SignatureHash(code, tx, input_index, hash_type, amount,
+                sigversion);
+        }
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+
+    return true;
+}
+
 #ifdef UNTESTED
 verify_result verify_transaction(const chunk& transaction,
     const outputs& prevouts, uint32_t flags) noexcept
@@ -264,6 +538,7 @@ verify_result verify_transaction(const chunk& transaction,
     uint32_t input_index = 0;
     auto prevout = prevouts.begin();
     const auto script_flags = verify_flags_to_script_flags(flags);
+    auto& arena = get_implementation(thread_context()).arena;
 
     for (const auto& input: tx->vin)
     {
@@ -276,8 +551,9 @@ verify_result verify_transaction(const chunk& transaction,
 
         try
         {
+            arena.Reset();
             VerifyScript(input.scriptSig, output_cscript, &input.scriptWitness,
-                script_flags, checker, &error);
+                script_flags, checker, arena, &error);
         }
         catch (const std::exception&)
         {
@@ -298,43 +574,53 @@ verify_result verify_transaction(const chunk& transaction,
 verify_result verify_script(const chunk& transaction, const output& prevout,
     uint32_t input_index, uint32_t flags) noexcept
 {
-    if (prevout.value > std::numeric_limits<int64_t>::max())
-        return verify_value_overflow;
-
-    std::shared_ptr<CTransaction> tx;
-
     try
     {
-        transaction_istream stream(transaction.data(), transaction.size());
-        tx = std::make_shared<CTransaction>(deserialize, stream);
+        return verify_script(thread_context(), transaction, prevout,
+            input_index, flags);
     }
     catch (const std::exception&)
     {
-        return verify_result_tx_invalid;
+        return verify_evaluation_throws;
     }
+}
 
-    if (input_index >= tx->vin.size())
-        return verify_result_tx_input_invalid;
-
-#ifndef NDEBUG
-    if (GetSerializeSize(*tx, PROTOCOL_VERSION) != transaction.size())
-        return verify_result_tx_size_invalid;
-#endif // NDEBUG
+// Verifies an input of the parsed transaction, with the scripts copied to
+// the context's storage.
+static verify_result verify_input(verification_context::implementation& retained,
+    const CTransactionView& tx, uint32_t input_index,
+    const output_reference& prevout, unsigned int script_flags,
+    const PrecomputedTransactionData* txdata,
+    const std::atomic<bool>* cancelled) noexcept
+{
+    if (prevout.value > std::numeric_limits<int64_t>::max())
+        return verify_value_overflow;
 
     ScriptError_t error;
     const CAmount amount(static_cast<int64_t>(prevout.value));
-    const auto script_flags = verify_flags_to_script_flags(flags);
-    TransactionSignatureChecker checker(&(*tx), input_index, amount);
-    CScript output_cscript(prevout.script.begin(), prevout.script.end());
-    const auto& input = tx->vin[input_index];
+    const counting_signature_checker checker(&tx, input_index, amount, txdata,
+        retained.signature_checks, cancelled);
 
     try
     {
+        const auto input = tx.vin[input_index];
+        retained.input_script.assign(input.scriptSig.begin(),
+            input.scriptSig.end());
+        retained.output_script.assign(prevout.script,
+            prevout.script + prevout.script_size);
+
+        // The witness is not read unless witness validation is enabled.
+        if ((script_flags & SCRIPT_VERIFY_WITNESS) != 0)
+            assign_witness(retained.witness, input.scriptWitness);
+        else
+            retained.witness.stack.clear();
+
         // See libbitcoin-blockchain : validate_input.cpp :
         // bc::blockchain::validate_input::verify_script(const transaction& tx,
         //     uint32_t input_index, uint32_t forks, bool use_libconsensus)...
-        VerifyScript(input.scriptSig, output_cscript, &input.scriptWitness,
-            script_flags, checker, &error);
+        retained.arena.Reset();
+        VerifyScript(retained.input_script, retained.output_script,
+            &retained.witness, script_flags, checker, retained.arena, &error);
     }
     catch (const std::exception&)
     {
@@ -344,35 +630,1442 @@ verify_result verify_script(const chunk& transaction, const output& prevout,
     return script_error_to_verify_result(error);
 }
 
-verify_result verify_unsigned_script(const output& prevout,
-    const chunk& input_script, const stack& witness, uint32_t flags) noexcept
+verify_result verify_script(verification_context& context,
+    const chunk& transaction, const output& prevout, uint32_t input_index,
+    uint32_t flags) noexcept
+{
+    const output_reference reference
+    {
+        prevout.script.data(), prevout.script.size(), prevout.value
+    };
+
+    return verify_script(context, transaction.data(), transaction.size(),
+        reference, input_index, flags);
+}
+
+verify_result verify_script(const uint8_t* transaction,
+    size_t transaction_size, const output_reference& prevout,
+    uint32_t input_index, uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_script(thread_context(), transaction, transaction_size,
+            prevout, input_index, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_script(verification_context& context,
+    const uint8_t* transaction, size_t transaction_size,
+    const output_reference& prevout, uint32_t input_index,
+    uint32_t flags) noexcept
 {
     if (prevout.value > std::numeric_limits<int64_t>::max())
         return verify_value_overflow;
 
-    CTransaction tx;
-    ScriptError_t error;
-    const CAmount amount(static_cast<int64_t>(prevout.value));
-    TransactionSignatureChecker checker(&tx, 0, amount);
-    const auto script_flags = verify_flags_to_script_flags(flags);
+    // The view indexes the transaction in place, only the input being
+    // verified is copied out of it.
+    auto& retained = get_implementation(context);
+    auto& tx = retained.transaction;
+
+    try
+    {
+        tx.Parse({ transaction, transaction_size });
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_tx_invalid;
+    }
+
+    if (input_index >= tx.vin.size())
+        return verify_result_tx_input_invalid;
+
+#ifndef NDEBUG
+    if (tx.GetSerializeSize() != transaction_size)
+        return verify_result_tx_size_invalid;
+#endif // NDEBUG
+
+    return verify_input(retained, tx, input_index, prevout,
+        verify_flags_to_script_flags(flags), nullptr, nullptr);
+}
+
+// Verifies all inputs of the context's parsed transaction against the
+// outputs that they spend, in order. The input is left at the first failure.
+static verify_result verify_inputs(
+    verification_context::implementation& retained,
+    const output_reference* prevouts, unsigned int script_flags,
+    uint32_t& input)
+{
+    // Signature hashes of the transaction's inputs share its
+    // precomputed (BIP143) hashes.
+    const auto& tx = retained.transaction;
+    const PrecomputedTransactionData txdata(tx);
+    const auto inputs = tx.vin.size();
+
+    for (input = 0; input < inputs; ++input)
+    {
+        const auto result = verify_input(retained, tx, input,
+            prevouts[input], script_flags, &txdata, nullptr);
+
+        if (result != verify_result_eval_true)
+            return result;
+    }
+
+    return verify_result_eval_true;
+}
 
-    CScriptWitness witness_stack;
-    witness_stack.stack.assign(witness.begin(), witness.end());
-    CScript input_cscript(input_script.begin(), input_script.end());
-    CScript output_cscript(prevout.script.begin(), prevout.script.end());
+// Parses and verifies the transaction, the input is left at a script failure.
+static verify_result verify_transaction(
+    verification_context::implementation& retained,
+    const transaction_reference& transaction, uint32_t flags,
+    uint32_t& input) noexcept
+{
+    auto& tx = retained.transaction;
+    input = 0;
 
     try
     {
-        // The checker has an empty transaction, fails if checksig is invoked.
-        VerifyScript(input_cscript, output_cscript, &witness_stack, script_flags,
-            checker, &error);
+        tx.Parse({ transaction.transaction, transaction.transaction_size });
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_tx_invalid;
+    }
+
+    if (tx.GetSerializeSize() != transaction.transaction_size)
+        return verify_result_tx_size_invalid;
+
+    if (transaction.prevouts_size != tx.vin.size())
+        return verify_result_tx_input_invalid;
+
+    try
+    {
+        return verify_inputs(retained, transaction.prevouts,
+            verify_flags_to_script_flags(flags), input);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_transaction(const transaction_reference& transaction,
+    uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_transaction(default_pool(), transaction, flags);
     }
     catch (const std::exception&)
     {
         return verify_evaluation_throws;
     }
+}
 
-    return script_error_to_verify_result(error);
+verify_result verify_transaction(verification_context& context,
+    const transaction_reference& transaction, uint32_t flags) noexcept
+{
+    uint32_t input;
+    return verify_transaction(get_implementation(context), transaction, flags,
+        input);
+}
+
+verify_result verify_transaction(const transaction_reference& transaction,
+    uint32_t flags, uint32_t& input) noexcept
+{
+    try
+    {
+        return verify_transaction(get_implementation(thread_context()),
+            transaction, flags, input);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+// Verifies a batch of transactions as two pool jobs: each transaction is
+// parsed and its signature hashes precomputed, then each input of the parsed
+// transactions is verified. The result of a transaction is that of its first
+// failing input, as if verified serially, unless the batch is cancelled.
+class transactions_job
+  : public job
+{
+public:
+    // The result and input of each transaction are written in place, each
+    // stride bytes beyond the last. Inputs are retained here if not written.
+    transactions_job(const transaction_reference* transactions, size_t count,
+        uint32_t flags, verify_result* results, uint32_t* inputs,
+        size_t stride, bool in_order, const batch_settings& settings)
+      : transactions_(transactions),
+        count_(count),
+        script_flags_(verify_flags_to_script_flags(flags)),
+        in_order_(in_order),
+        token_(settings.cancel != nullptr ? *settings.cancel : local_),
+        fail_fast_(settings.fail_fast),
+        opcodes_(settings.opcodes ? &token_.get() : nullptr),
+        results_(reinterpret_cast<uint8_t*>(results)),
+        retained_(inputs != nullptr ? nullptr :
+            std::make_unique<uint32_t[]>(count)),
+        inputs_(inputs != nullptr ? reinterpret_cast<uint8_t*>(inputs) :
+            reinterpret_cast<uint8_t*>(retained_.get())),
+        result_stride_(stride),
+        input_stride_(inputs != nullptr ? stride : sizeof(uint32_t)),
+        views_(std::make_unique<CTransactionView[]>(count)),
+        txdata_(std::make_unique<PrecomputedTransactionData[]>(count)),
+        parsing_(true)
+    {
+    }
+
+    void run(size_t item, verification_context& context) noexcept override
+    {
+        if (parsing_)
+            parse(item);
+        else
+            verify(item, get_implementation(context));
+    }
+
+    // Lists the inputs of the parsed transactions as the items of the second
+    // job, once the first has completed. Unless in order, the costliest are
+    // listed first, so that they are dealt to the front of each deque.
+    size_t list_inputs()
+    {
+        parsing_ = false;
+        items_.clear();
+
+        for (size_t index = 0; index < count_; ++index)
+        {
+            if (result(index) != verify_result_eval_true)
+                continue;
+
+            const auto& tx = views_[index];
+            const auto prevouts = transactions_[index].prevouts;
+            for (uint32_t input = 0; input < tx.vin.size(); ++input)
+            {
+                const auto cost = in_order_ ? 0 : GetInputCost(tx, input,
+                    { prevouts[input].script, prevouts[input].script_size },
+                    script_flags_).Units();
+
+                items_.push_back({ static_cast<uint32_t>(index), input,
+                    cost });
+            }
+        }
+
+        if (!in_order_)
+            std::stable_sort(items_.begin(), items_.end(),
+                [](const item& left, const item& right)
+                {
+                    return left.cost > right.cost;
+                });
+
+        return items_.size();
+    }
+
+private:
+    verify_result& result(size_t index) const noexcept
+    {
+        return *reinterpret_cast<verify_result*>(results_ +
+            index * result_stride_);
+    }
+
+    // The input of the transaction's script failure, zero if none.
+    uint32_t& input(size_t index) const noexcept
+    {
+        return *reinterpret_cast<uint32_t*>(inputs_ + index * input_stride_);
+    }
+
+    void parse(size_t index) noexcept
+    {
+        input(index) = 0;
+        result(index) = token_.cancelled() ? verify_result_cancelled :
+            parse_transaction(index);
+
+        if (fail_fast_ && result(index) != verify_result_eval_true)
+            token_.cancel();
+    }
+
+    verify_result parse_transaction(size_t index) noexcept
+    {
+        const auto& transaction = transactions_[index];
+        auto& tx = views_[index];
+
+        try
+        {
+            tx.Parse({ transaction.transaction,
+                transaction.transaction_size });
+        }
+        catch (const std::exception&)
+        {
+            return verify_result_tx_invalid;
+        }
+
+        if (tx.GetSerializeSize() != transaction.transaction_size)
+            return verify_result_tx_size_invalid;
+
+        if (transaction.prevouts_size != tx.vin.size())
+            return verify_result_tx_input_invalid;
+
+        try
+        {
+            txdata_[index].Init(tx, {});
+        }
+        catch (const std::exception&)
+        {
+            return verify_evaluation_throws;
+        }
+
+        return verify_result_eval_true;
+    }
+
+    void verify(size_t item,
+        verification_context::implementation& retained) noexcept
+    {
+        const auto index = items_[item].index;
+        const auto input = items_[item].input;
+        const auto result = token_.cancelled() ? verify_result_cancelled :
+            verify_input(retained, views_[index], input,
+                transactions_[index].prevouts[input], script_flags_,
+                &txdata_[index], opcodes_);
+
+        if (result == verify_result_eval_true)
+            return;
+
+        if (fail_fast_ && result != verify_result_cancelled)
+            token_.cancel();
+
+        // Failures are rare, the lowest failing input of each is retained.
+        // A cancellation is retained only in the absence of a failure.
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& current = this->result(index);
+
+        if (result == verify_result_cancelled)
+        {
+            if (current == verify_result_eval_true)
+                current = result;
+        }
+        else if (current == verify_result_eval_true ||
+            current == verify_result_cancelled || input < this->input(index))
+        {
+            current = result;
+            this->input(index) = input;
+        }
+    }
+
+    struct item
+    {
+        uint32_t index;
+        uint32_t input;
+        uint64_t cost;
+    };
+
+    const transaction_reference* transactions_;
+    const size_t count_;
+    const unsigned int script_flags_;
+    const bool in_order_;
+    cancellation local_;
+    cancellation& token_;
+    const bool fail_fast_;
+    const std::atomic<bool>* const opcodes_;
+    uint8_t* const results_;
+    const std::unique_ptr<uint32_t[]> retained_;
+    uint8_t* const inputs_;
+    const size_t result_stride_;
+    const size_t input_stride_;
+    std::unique_ptr<CTransactionView[]> views_;
+    std::unique_ptr<PrecomputedTransactionData[]> txdata_;
+    std::vector<item> items_;
+    std::mutex mutex_;
+    bool parsing_;
+};
+
+verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, uint32_t* inputs, size_t stride,
+    const transaction_reference* transactions, size_t count,
+    uint32_t flags, const batch_settings& settings) noexcept
+{
+    try
+    {
+        auto& context = thread_context();
+        transactions_job batch(transactions, count, flags, results, inputs,
+            stride, get_implementation(pool).in_order(), settings);
+        const auto data = count == 0 ? nullptr : transactions->transaction;
+        get_implementation(pool).run(batch, count, context, settings.lane,
+            data);
+        get_implementation(pool).run(batch, batch.list_inputs(), context,
+            settings.lane, data);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+
+    auto result = verify_result_eval_true;
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto& code = *reinterpret_cast<const verify_result*>(
+            reinterpret_cast<const uint8_t*>(results) + index * stride);
+
+        if (code == verify_result_cancelled)
+            result = verify_result_cancelled;
+        else if (code != verify_result_eval_true)
+            return code;
+    }
+
+    return result;
+}
+
+verify_result verify_transaction(verification_pool& pool,
+    const transaction_reference& transaction, uint32_t flags) noexcept
+{
+    verify_result result;
+    return verify_transactions(pool, &result, nullptr, sizeof(result),
+        &transaction, 1, flags, { nullptr, false, false, verify_lane_block });
+}
+
+verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, const transaction_reference* transactions,
+    size_t count, uint32_t flags) noexcept
+{
+    return verify_transactions(pool, results, nullptr, sizeof(*results),
+        transactions, count, flags, { nullptr, false, false, verify_lane_block });
+}
+
+verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, const transaction_reference* transactions,
+    size_t count, uint32_t flags, const batch_settings& settings) noexcept
+{
+    return verify_transactions(pool, results, nullptr, sizeof(*results),
+        transactions, count, flags, settings);
+}
+
+verify_result verify_transactions(verify_result* results,
+    const transaction_reference* transactions, size_t count, uint32_t flags,
+    size_t threads) noexcept
+{
+    if (threads != 1)
+    {
+        try
+        {
+            return verify_transactions(default_pool(), results, transactions,
+                count, flags);
+        }
+        catch (const std::exception&)
+        {
+            return verify_evaluation_throws;
+        }
+    }
+
+    uint32_t input;
+    for (size_t index = 0; index < count; ++index)
+        results[index] = verify_transaction(transactions[index], flags,
+            input);
+
+    for (size_t index = 0; index < count; ++index)
+        if (results[index] != verify_result_eval_true)
+            return results[index];
+
+    return verify_result_eval_true;
+}
+
+static verify_result tx_check_to_verify_result(TxCheckResult result) noexcept
+{
+    switch (result)
+    {
+        case TxCheckResult::OK:
+            return verify_result_eval_true;
+        case TxCheckResult::VIN_EMPTY:
+            return verify_result_tx_inputs_empty;
+        case TxCheckResult::VOUT_EMPTY:
+            return verify_result_tx_outputs_empty;
+        case TxCheckResult::OVERSIZE:
+            return verify_result_tx_oversize;
+        case TxCheckResult::VOUT_NEGATIVE:
+        case TxCheckResult::VOUT_TOOLARGE:
+            return verify_result_tx_output_value_invalid;
+        case TxCheckResult::TXOUTTOTAL_TOOLARGE:
+            return verify_result_tx_outputs_value_overflow;
+        case TxCheckResult::INPUTS_DUPLICATE:
+            return verify_result_tx_inputs_duplicate;
+        case TxCheckResult::CB_LENGTH:
+            return verify_result_tx_coinbase_script_size;
+        case TxCheckResult::PREVOUT_NULL:
+            return verify_result_tx_prevout_null;
+        default:
+            return verify_result_unknown_error;
+    }
+}
+
+// Checks the context's parsed transaction.
+static verify_result check_transaction(
+    verification_context::implementation& retained)
+{
+    return tx_check_to_verify_result(CheckTransaction(retained.transaction,
+        retained.inputs));
+}
+
+// Serves the outputs of a list, in order, as a provider.
+class outputs_provider
+  : public prevout_provider
+{
+public:
+    outputs_provider(const outputs& prevouts) noexcept
+      : prevout_(prevouts.begin()), end_(prevouts.end())
+    {
+    }
+
+    bool get(output_reference& out, const outpoint&) override
+    {
+        if (prevout_ == end_)
+            return false;
+
+        out = { prevout_->script.data(), prevout_->script.size(),
+            prevout_->value };
+        ++prevout_;
+        return true;
+    }
+
+    bool exhausted() const noexcept
+    {
+        return prevout_ == end_;
+    }
+
+private:
+    outputs::const_iterator prevout_;
+    const outputs::const_iterator end_;
+};
+
+// Serves referenced outputs, in order, as a provider.
+class references_provider
+  : public prevout_provider
+{
+public:
+    references_provider(const output_reference* prevouts,
+        size_t count) noexcept
+      : prevout_(prevouts), end_(prevouts + count)
+    {
+    }
+
+    bool get(output_reference& out, const outpoint&) override
+    {
+        if (prevout_ == end_)
+            return false;
+
+        out = *prevout_++;
+        return true;
+    }
+
+    bool exhausted() const noexcept
+    {
+        return prevout_ == end_;
+    }
+
+private:
+    const output_reference* prevout_;
+    const output_reference* const end_;
+};
+
+// Appends the outpoints spent by the inputs of the view.
+static void append_outpoints(std::vector<outpoint>& out,
+    const CTransactionView& tx)
+{
+    for (const auto input: tx.vin)
+    {
+        out.emplace_back();
+        std::copy(input.prevout.hash.begin(), input.prevout.hash.end(),
+            out.back().hash.begin());
+        out.back().index = input.prevout.n;
+    }
+}
+
+// Parses the transactions of the block in turn, each into the view returned
+// for its index (given the count), passing the index of each to the handler,
+// until the handler fails.
+template <typename View, typename Handler>
+static verify_result parse_block(const uint8_t* block, size_t block_size,
+    View&& view, Handler&& handler)
+{
+    static constexpr size_t header_size = 80;
+
+    transaction_istream stream(block, block_size);
+    uint64_t count;
+
+    try
+    {
+        stream.skip(header_size);
+        count = ReadCompactSize(stream);
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_block_invalid;
+    }
+
+    // A transaction is at least a byte, which bounds any allocation by view.
+    if (count == 0 || count > stream.unread().size())
+        return verify_result_block_invalid;
+
+    for (uint64_t index = 0; index < count; ++index)
+    {
+        auto& tx = view(index, count);
+
+        // Each transaction is parsed in place, the view then bounds it.
+        try
+        {
+            tx.Parse(stream.unread());
+        }
+        catch (const std::exception&)
+        {
+            return verify_result_tx_invalid;
+        }
+
+        stream.skip(tx.GetSerializeSize());
+        const auto result = handler(index);
+
+        if (result != verify_result_eval_true)
+            return result;
+    }
+
+    return stream.unread().empty() ? verify_result_eval_true :
+        verify_result_block_invalid;
+}
+
+// As parse_block, each transaction parsed into the context's view.
+template <typename Handler>
+static verify_result parse_block(verification_context::implementation& retained,
+    const uint8_t* block, size_t block_size, Handler&& handler)
+{
+    auto& tx = retained.transaction;
+    return parse_block(block, block_size,
+        [&](uint64_t, uint64_t) -> CTransactionView&
+        {
+            return tx;
+        }, std::forward<Handler>(handler));
+}
+
+// The spent outputs of non-coinbase transactions are obtained from the
+// provider. If hinted the block is first parsed to prefetch all of them.
+static verify_result verify_block_inputs(
+    verification_context::implementation& retained, const uint8_t* block,
+    size_t block_size, prevout_provider& provider, uint32_t flags, bool hint)
+{
+    const auto script_flags = verify_flags_to_script_flags(flags);
+    auto& tx = retained.transaction;
+    auto& points = retained.outpoints;
+    auto& spent = retained.spent;
+    size_t point = 0;
+    points.clear();
+
+    if (hint)
+    {
+        const auto result = parse_block(retained, block, block_size,
+            [&](uint64_t index)
+        {
+            if (index != 0)
+                append_outpoints(points, tx);
+
+            return verify_result_eval_true;
+        });
+
+        if (result != verify_result_eval_true)
+            return result;
+
+        provider.prefetch(points.data(), points.size());
+    }
+
+    return parse_block(retained, block, block_size, [&](uint64_t index)
+    {
+        // Context free checks precede any signature work on the transaction.
+        const auto checked = check_transaction(retained);
+        if (checked != verify_result_eval_true)
+            return checked;
+
+        // The coinbase input spends no output.
+        if (index == 0)
+            return verify_result_eval_true;
+
+        if (!hint)
+        {
+            points.clear();
+            point = 0;
+            append_outpoints(points, tx);
+        }
+
+        const auto inputs = tx.vin.size();
+        spent.resize(inputs);
+
+        if (!provider.get_batch(spent.data(), points.data() + point, inputs))
+            return verify_result_block_prevouts_invalid;
+
+        point += inputs;
+        uint32_t input;
+        return verify_inputs(retained, spent.data(), script_flags, input);
+    });
+}
+
+// A block as it passes through a pipeline: parsed and checked, then its
+// signature hashes precomputed, then each of its inputs verified as an item.
+// A failure of parsing or checks is recorded at the position of the first
+// input of its transaction, which only an earlier input's failure precedes,
+// and verification stops at inputs that follow a failure. So the failure
+// reported is the first in block order, as verified serially. Unless in
+// order, the costliest inputs are listed first, retaining their positions.
+class block_inputs_job
+  : public block_job
+{
+public:
+    block_inputs_job(const block_reference& block, uint32_t flags,
+        bool in_order)
+      : block_(block),
+        script_flags_(verify_flags_to_script_flags(flags)),
+        in_order_(in_order),
+        count_(0),
+        result_(verify_result_eval_true),
+        failed_(std::numeric_limits<size_t>::max()),
+        failure_(verify_result_eval_true),
+        signature_checks_(0)
+    {
+    }
+
+    void parse() noexcept override
+    {
+        try
+        {
+            const auto result = parse_transactions();
+            if (result != verify_result_eval_true)
+            {
+                failed_ = items_.size();
+                failure_ = result;
+            }
+
+            order_inputs();
+        }
+        catch (const std::exception&)
+        {
+            result_ = verify_evaluation_throws;
+        }
+    }
+
+    void precompute() noexcept override
+    {
+        if (result_ != verify_result_eval_true)
+            return;
+
+        // The coinbase input spends no output.
+        try
+        {
+            for (size_t index = 1; index < count_; ++index)
+                txdata_[index].Init(views_[index], {});
+        }
+        catch (const std::exception&)
+        {
+            result_ = verify_evaluation_throws;
+        }
+    }
+
+    void run(size_t item, verification_context& context) noexcept override
+    {
+        const auto& input = items_[item];
+        const auto position = input.position;
+        if (position > failed_.load(std::memory_order_relaxed))
+            return;
+
+        // The context is the running thread's, so its count changes only by
+        // the signatures of this input.
+        auto& retained = get_implementation(context);
+        const auto checks = retained.signature_checks;
+        const auto result = verify_input(retained, views_[input.index],
+            input.input, block_.prevouts[position], script_flags_,
+            &txdata_[input.index], nullptr);
+        signature_checks_.fetch_add(retained.signature_checks - checks,
+            std::memory_order_relaxed);
+
+        if (result == verify_result_eval_true)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (position < failed_.load())
+        {
+            failed_ = position;
+            failure_ = result;
+        }
+    }
+
+    size_t transactions() const noexcept override
+    {
+        return count_;
+    }
+
+    size_t inputs() const noexcept override
+    {
+        return result_ == verify_result_eval_true ? items_.size() : 0;
+    }
+
+    const void* data() const noexcept override
+    {
+        return block_.block;
+    }
+
+    verify_result result() const noexcept override
+    {
+        if (result_ != verify_result_eval_true)
+            return result_;
+
+        return failed_.load() == std::numeric_limits<size_t>::max() ?
+            verify_result_eval_true : failure_;
+    }
+
+    uint64_t signature_checks() const noexcept override
+    {
+        return signature_checks_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct item
+    {
+        uint32_t index;
+        uint32_t input;
+        size_t position;
+        uint64_t cost;
+    };
+
+    // Parses and checks the transactions, retaining the view of each and
+    // listing the inputs of those that pass, up to the first failure.
+    verify_result parse_transactions()
+    {
+        const auto result = parse_block(block_.block, block_.block_size,
+            [&](uint64_t index, uint64_t count) -> CTransactionView&
+            {
+                if (index == 0)
+                {
+                    views_ = std::make_unique<CTransactionView[]>(count);
+                    txdata_ = std::make_unique<PrecomputedTransactionData[]>(
+                        count);
+                }
+
+                return views_[index];
+            },
+            [&](uint64_t index)
+            {
+                const auto& tx = views_[index];
+                const auto checked = tx_check_to_verify_result(
+                    CheckTransaction(tx, outpoints_));
+                if (checked != verify_result_eval_true)
+                    return checked;
+
+                // The coinbase input spends no output.
+                if (index != 0)
+                {
+                    if (tx.vin.size() > block_.prevouts_size - items_.size())
+                        return verify_result_block_prevouts_invalid;
+
+                    for (uint32_t input = 0; input < tx.vin.size(); ++input)
+                        items_.push_back({ static_cast<uint32_t>(index),
+                            input, items_.size(), 0 });
+                }
+
+                count_ = static_cast<size_t>(index) + 1;
+                return verify_result_eval_true;
+            });
+
+        if (result == verify_result_eval_true &&
+            items_.size() != block_.prevouts_size)
+            return verify_result_block_prevouts_invalid;
+
+        return result;
+    }
+
+    // Lists the costliest inputs first, so that they are dealt to the front
+    // of each deque and do not start last and extend the block.
+    void order_inputs()
+    {
+        if (in_order_)
+            return;
+
+        for (auto& input: items_)
+        {
+            const auto& prevout = block_.prevouts[input.position];
+            input.cost = GetInputCost(views_[input.index], input.input,
+                { prevout.script, prevout.script_size }, script_flags_).Units();
+        }
+
+        std::stable_sort(items_.begin(), items_.end(),
+            [](const item& left, const item& right)
+            {
+                return left.cost > right.cost;
+            });
+    }
+
+    const block_reference block_;
+    const unsigned int script_flags_;
+    const bool in_order_;
+    size_t count_;
+    std::unique_ptr<CTransactionView[]> views_;
+    std::unique_ptr<PrecomputedTransactionData[]> txdata_;
+    std::vector<item> items_;
+    OutpointSet outpoints_;
+    verify_result result_;
+    std::atomic<size_t> failed_;
+    verify_result failure_;
+    std::atomic<uint64_t> signature_checks_;
+    std::mutex mutex_;
+};
+
+std::unique_ptr<block_job> make_block_job(const block_reference& block,
+    uint32_t flags, bool in_order)
+{
+    return std::make_unique<block_inputs_job>(block, flags, in_order);
+}
+
+verify_result verify_block(verification_pool& pool,
+    const block_reference& block, uint32_t flags) noexcept
+{
+    try
+    {
+        block_inputs_job job(block, flags, get_implementation(pool).in_order());
+        job.parse();
+        job.precompute();
+        get_implementation(pool).run(job, job.inputs(), thread_context(),
+            verify_lane_block, job.data());
+
+        return job.result();
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(const block_reference& block,
+    uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_block(default_pool(), block, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(const chunk& block, const outputs& prevouts,
+    uint32_t flags) noexcept
+{
+    try
+    {
+        std::vector<output_reference> references;
+        references.reserve(prevouts.size());
+
+        for (const auto& prevout: prevouts)
+            references.push_back({ prevout.script.data(),
+                prevout.script.size(), prevout.value });
+
+        return verify_block(default_pool(), { block.data(), block.size(),
+            references.data(), references.size() }, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(verification_context& context, const chunk& block,
+    const outputs& prevouts, uint32_t flags) noexcept
+{
+    try
+    {
+        outputs_provider provider(prevouts);
+        const auto result = verify_block_inputs(get_implementation(context),
+            block.data(), block.size(), provider, flags, false);
+
+        return result == verify_result_eval_true && !provider.exhausted() ?
+            verify_result_block_prevouts_invalid : result;
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(verification_context& context,
+    const block_reference& block, uint32_t flags) noexcept
+{
+    try
+    {
+        references_provider provider(block.prevouts, block.prevouts_size);
+        const auto result = verify_block_inputs(get_implementation(context),
+            block.block, block.block_size, provider, flags, false);
+
+        return result == verify_result_eval_true && !provider.exhausted() ?
+            verify_result_block_prevouts_invalid : result;
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(const chunk& block, prevout_provider& provider,
+    uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_block(thread_context(), block, provider, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_block(verification_context& context, const chunk& block,
+    prevout_provider& provider, uint32_t flags) noexcept
+{
+    // Provider failures are reported as evaluation failures.
+    try
+    {
+        return verify_block_inputs(get_implementation(context), block.data(),
+            block.size(), provider, flags, true);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_unsigned_script(const output& prevout,
+    const chunk& input_script, const stack& witness, uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_unsigned_script(thread_context(), prevout, input_script,
+            witness, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_unsigned_script(verification_context& context,
+    const output& prevout, const chunk& input_script, const stack& witness,
+    uint32_t flags) noexcept
+{
+    if (prevout.value > std::numeric_limits<int64_t>::max())
+        return verify_value_overflow;
+
+    static const CTransaction tx;
+    ScriptError_t error;
+    auto& retained = get_implementation(context);
+    const CAmount amount(static_cast<int64_t>(prevout.value));
+    TransactionSignatureChecker checker(&tx, 0, amount);
+    const auto script_flags = verify_flags_to_script_flags(flags);
+
+    try
+    {
+        retained.witness.stack.assign(witness.begin(), witness.end());
+        retained.input_script.assign(input_script.begin(), input_script.end());
+        retained.output_script.assign(prevout.script.begin(),
+            prevout.script.end());
+
+        // The checker has an empty transaction, fails if checksig is invoked.
+        retained.arena.Reset();
+        VerifyScript(retained.input_script, retained.output_script,
+            &retained.witness, script_flags, checker, retained.arena, &error);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+
+    return script_error_to_verify_result(error);
+}
+
+bool extract_outpoints(outpoint* out, size_t capacity, size_t& inputs,
+    bool& witness, const chunk& transaction) noexcept
+{
+    static constexpr auto hash_size = sizeof(outpoint::hash);
+
+    try
+    {
+        // As UnserializeTransaction, reading no further than the inputs.
+        transaction_istream stream(transaction.data(), transaction.size());
+        stream.skip(sizeof(int32_t));
+        auto count = ReadCompactSize(stream);
+        witness = false;
+
+        if (count == 0)
+        {
+            // A dummy or an empty vin, only the witness flag is defined.
+            uint8_t flags;
+            stream.read(reinterpret_cast<char*>(&flags), sizeof(flags));
+
+            if (flags != 0)
+            {
+                if (flags != 1)
+                    return false;
+
+                witness = true;
+                count = ReadCompactSize(stream);
+            }
+        }
+
+        for (uint64_t index = 0; index < count; ++index)
+        {
+            if (index < capacity)
+            {
+                stream.read(reinterpret_cast<char*>(out[index].hash.data()),
+                    hash_size);
+                out[index].index = ser_readdata32(stream);
+            }
+            else
+            {
+                stream.skip(hash_size + sizeof(uint32_t));
+            }
+
+            // The input script and sequence.
+            stream.skip(ReadCompactSize(stream));
+            stream.skip(sizeof(uint32_t));
+        }
+
+        inputs = static_cast<size_t>(count);
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+verify_result check_transaction(const chunk& transaction) noexcept
+{
+    try
+    {
+        return check_transaction(thread_context(), transaction);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result check_transaction(verification_context& context,
+    const chunk& transaction) noexcept
+{
+    auto& retained = get_implementation(context);
+
+    try
+    {
+        retained.transaction.Parse(MakeSpan(transaction));
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_tx_invalid;
+    }
+
+    if (retained.transaction.GetSerializeSize() != transaction.size())
+        return verify_result_tx_size_invalid;
+
+    try
+    {
+        return check_transaction(retained);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result check_locks(const chunk& transaction,
+    const confirmations& confirmed, uint32_t height, int64_t time,
+    uint32_t flags) noexcept
+{
+    try
+    {
+        return check_locks(thread_context(), transaction, confirmed, height,
+            time, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result check_locks(verification_context& context,
+    const chunk& transaction, const confirmations& confirmed,
+    uint32_t height, int64_t time, uint32_t flags) noexcept
+{
+    auto& retained = get_implementation(context);
+    auto& tx = retained.transaction;
+
+    try
+    {
+        tx.Parse(MakeSpan(transaction));
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_tx_invalid;
+    }
+
+    if (tx.GetSerializeSize() != transaction.size())
+        return verify_result_tx_size_invalid;
+
+    if (height > static_cast<uint32_t>(std::numeric_limits<int>::max()))
+        return verify_result_tx_confirmations_invalid;
+
+    const auto block_height = static_cast<int>(height);
+
+    if (!IsFinalTx(tx, block_height, time))
+        return verify_result_tx_not_final;
+
+    // BIP68 is deployed with BIP112 (and BIP113).
+    if ((flags & verify_flags_checksequenceverify) == 0)
+        return verify_result_eval_true;
+
+    if (confirmed.size() != tx.vin.size())
+        return verify_result_tx_confirmations_invalid;
+
+    auto& coins = retained.coins;
+    coins.clear();
+
+    try
+    {
+        for (const auto& confirmation: confirmed)
+        {
+            if (confirmation.height > height)
+                return verify_result_tx_confirmations_invalid;
+
+            coins.push_back({ static_cast<int>(confirmation.height),
+                confirmation.median_time_past });
+        }
+
+        const auto locks = CalculateSequenceLocks(tx, LOCKTIME_VERIFY_SEQUENCE,
+            coins);
+
+        return EvaluateSequenceLocks(block_height, time, locks) ?
+            verify_result_eval_true : verify_result_tx_sequence_locked;
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result estimate_cost(transaction_cost& out,
+    const transaction_reference& transaction, uint32_t flags) noexcept
+{
+    try
+    {
+        return estimate_cost(thread_context(), out, transaction, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result estimate_cost(verification_context& context,
+    transaction_cost& out, const transaction_reference& transaction,
+    uint32_t flags) noexcept
+{
+    auto& tx = get_implementation(context).transaction;
+    out = { 0, 0, 0 };
+
+    try
+    {
+        tx.Parse({ transaction.transaction, transaction.transaction_size });
+    }
+    catch (const std::exception&)
+    {
+        return verify_result_tx_invalid;
+    }
+
+    if (tx.GetSerializeSize() != transaction.transaction_size)
+        return verify_result_tx_size_invalid;
+
+    if (transaction.prevouts_size != tx.vin.size())
+        return verify_result_tx_input_invalid;
+
+    const auto script_flags = verify_flags_to_script_flags(flags);
+
+    for (uint32_t input = 0; input < tx.vin.size(); ++input)
+    {
+        const auto& prevout = transaction.prevouts[input];
+        const auto cost = GetInputCost(tx, input,
+            { prevout.script, prevout.script_size }, script_flags);
+
+        out.signature_checks += cost.sigops;
+        out.sighash_bytes += cost.sighash_bytes;
+        out.validation_weight += cost.validation_weight;
+    }
+
+    return verify_result_eval_true;
+}
+
+// Copies the hashes into the retained tree, reusing its capacity.
+static void assign_hashes(std::vector<uint256>& out, const hash_list& hashes)
+{
+    out.resize(hashes.size());
+    auto hash = out.begin();
+    for (const auto& digest: hashes)
+        std::copy(digest.begin(), digest.end(), (hash++)->begin());
+}
+
+// Verifies the coinbase's commitment to the witness root of the wtxids, the
+// first of which is taken to be the (null) wtxid of the coinbase.
+static verify_result witness_commitment(const CTransactionView& coinbase,
+    std::vector<uint256>& wtxids)
+{
+    static constexpr size_t commitment_offset = 6;
+    static constexpr auto hash_size = sizeof(hash_digest);
+
+    const auto position = GetWitnessCommitmentIndex(coinbase);
+    if (position == NO_WITNESS_COMMITMENT)
+        return verify_result_block_witness_uncommitted;
+
+    // The reserved value is the coinbase input's only witness item.
+    if (coinbase.vin.empty() || wtxids.empty())
+        return verify_result_block_witness_nonce_size;
+
+    const auto witness = coinbase.vin[0].scriptWitness;
+    if (witness.size() != 1 || (*witness.begin()).size() != hash_size)
+        return verify_result_block_witness_nonce_size;
+
+    // The malleation check is ignored, the transaction tree precludes it.
+    wtxids.front().SetNull();
+    auto root = ComputeMerkleRoot(wtxids);
+    CHash256().Write(MakeUCharSpan(root)).Write(*witness.begin()).Finalize(root);
+
+    const auto commitment = coinbase.vout[position].scriptPubKey.subspan(
+        commitment_offset, hash_size);
+
+    return std::equal(root.begin(), root.end(), commitment.begin()) ?
+        verify_result_eval_true : verify_result_block_witness_mismatch;
+}
+
+bool merkle_root(hash_digest& out, bool& mutated,
+    const hash_list& hashes) noexcept
+{
+    if (hashes.empty())
+        return false;
+
+    try
+    {
+        auto& tree = get_implementation(thread_context()).hashes;
+        assign_hashes(tree, hashes);
+        const auto root = ComputeMerkleRoot(tree, &mutated);
+        std::copy(root.begin(), root.end(), out.begin());
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+verify_result verify_witness_commitment(const chunk& coinbase,
+    const hash_list& wtxids) noexcept
+{
+    try
+    {
+        auto& retained = get_implementation(thread_context());
+        auto& tx = retained.transaction;
+
+        try
+        {
+            tx.Parse(MakeSpan(coinbase));
+        }
+        catch (const std::exception&)
+        {
+            return verify_result_tx_invalid;
+        }
+
+        if (tx.GetSerializeSize() != coinbase.size())
+            return verify_result_tx_size_invalid;
+
+        assign_hashes(retained.witness_hashes, wtxids);
+        return witness_commitment(tx, retained.witness_hashes);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_merkle(const chunk& block, uint32_t flags) noexcept
+{
+    try
+    {
+        return verify_merkle(thread_context(), block, flags);
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
+}
+
+verify_result verify_merkle(verification_context& context, const chunk& block,
+    uint32_t flags) noexcept
+{
+    static constexpr size_t merkle_root_offset = 36;
+
+    auto& retained = get_implementation(context);
+    auto& tx = retained.transaction;
+    auto& hashes = retained.hashes;
+    auto& witness_hashes = retained.witness_hashes;
+    const auto witness = (flags & verify_flags_witness) != 0;
+    Span<const unsigned char> coinbase;
+    auto witnessed = false;
+    hashes.clear();
+    witness_hashes.clear();
+
+    try
+    {
+        const auto result = parse_block(retained, block.data(),
+            block.size(), [&](uint64_t index)
+        {
+            if (index == 0)
+                coinbase = tx.Bytes();
+
+            hashes.push_back(tx.GetHash());
+            if (witness)
+                witness_hashes.push_back(tx.GetWitnessHash());
+
+            witnessed |= tx.HasWitness();
+            return verify_result_eval_true;
+        });
+
+        if (result != verify_result_eval_true)
+            return result;
+
+        bool mutated;
+        const auto root = ComputeMerkleRoot(hashes, &mutated);
+        if (!std::equal(root.begin(), root.end(),
+            block.begin() + merkle_root_offset))
+            return verify_result_block_merkle_mismatch;
+
+        if (mutated)
+            return verify_result_block_merkle_mutated;
+
+        if (witness)
+        {
+            // The view is returned to the coinbase, which is in the block.
+            tx.Parse(coinbase);
+            const auto committed = witness_commitment(tx, witness_hashes);
+            if (committed != verify_result_block_witness_uncommitted)
+                return committed;
+        }
+
+        // Witnesses are not allowed in a block that does not commit to them.
+        return witnessed ? verify_result_block_witness_unexpected :
+            verify_result_eval_true;
+    }
+    catch (const std::exception&)
+    {
+        return verify_evaluation_throws;
+    }
 }
 
 } // namespace consensus
@@ -20,16 +20,48 @@
 #define LIBBITCOIN_CONSENSUS_CONSENSUS_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <bitcoin/consensus/define.hpp>
 #include <bitcoin/consensus/export.hpp>
+#include "script/interpreter.h"
 #include "script/script_error.h"
 
 namespace libbitcoin {
 namespace consensus {
 
+// The script interpreters of evaluate_script: the opcode switch over script
+// bytes (EvalScriptReference), over a decoded script (EvalScript), and the
+// handler tables (EvalScriptThreaded).
+enum class script_engine
+{
+    reference,
+    decoded,
+    threaded
+};
+
 // These are not published in the public header but are exposed here for test.
 BCK_API verify_result script_error_to_verify_result(ScriptError_t code) noexcept;
 BCK_API unsigned int verify_flags_to_script_flags(uint32_t flags) noexcept;
+BCK_API ScriptError_t evaluate_script(stack& data, const chunk& script,
+    unsigned int script_flags, SigVersion sigversion,
+    script_engine engine) noexcept;
+BCK_API bool signature_hash(uint256& out, const chunk& transaction,
+    uint32_t input_index, const chunk& script_code, uint64_t value,
+    int hash_type, SigVersion sigversion, bool view) noexcept;
+
+// These are shared with the C interface (abi.cpp). The result and failing
+// input (if inputs is not null) of each transaction are written stride bytes
+// beyond those of the last, so that they are written in place to C structs.
+verify_result verify_transaction(const transaction_reference& transaction,
+    uint32_t flags, uint32_t& input) noexcept;
+verify_result verify_transactions(verification_pool& pool,
+    verify_result* results, uint32_t* inputs, size_t stride,
+    const transaction_reference* transactions, size_t count,
+    uint32_t flags, const batch_settings& settings) noexcept;
+
+// The retained storage of the context, a friend of the published class.
+verification_context::implementation& get_implementation(
+    verification_context& context) noexcept;
 
 } // namespace consensus
 } // namespace libbitcoin
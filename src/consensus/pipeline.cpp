@@ -0,0 +1,329 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "consensus/pipeline.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/export.hpp>
+#include "consensus/pool.hpp"
+
+namespace libbitcoin {
+namespace consensus {
+
+using namespace std::chrono;
+
+// Adds the time since start to the counter.
+static void add_since(std::atomic<uint64_t>& nanoseconds,
+    steady_clock::time_point start)
+{
+    nanoseconds.fetch_add(static_cast<uint64_t>(duration_cast<
+        std::chrono::nanoseconds>(steady_clock::now() - start).count()),
+        std::memory_order_relaxed);
+}
+
+block_pipeline::implementation::queue::queue(size_t capacity)
+  : capacity_(std::max(capacity, size_t{ 1 })), closed_(false)
+{
+}
+
+void block_pipeline::implementation::queue::push(entry&& value,
+    std::atomic<uint64_t>& blocked)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (entries_.size() >= capacity_)
+        {
+            const auto start = steady_clock::now();
+            popped_.wait(lock, [&]()
+            {
+                return entries_.size() < capacity_;
+            });
+
+            add_since(blocked, start);
+        }
+
+        entries_.push_back(std::move(value));
+    }
+
+    pushed_.notify_one();
+}
+
+bool block_pipeline::implementation::queue::pop(entry& out,
+    std::atomic<uint64_t>& starved)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (entries_.empty() && !closed_)
+        {
+            const auto start = steady_clock::now();
+            pushed_.wait(lock, [&]()
+            {
+                return !entries_.empty() || closed_;
+            });
+
+            add_since(starved, start);
+        }
+
+        if (entries_.empty())
+            return false;
+
+        out = std::move(entries_.front());
+        entries_.pop_front();
+    }
+
+    popped_.notify_one();
+    return true;
+}
+
+void block_pipeline::implementation::queue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+
+    pushed_.notify_all();
+}
+
+size_t block_pipeline::implementation::queue::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+block_pipeline::implementation::implementation(
+    const pipeline_settings& settings, block_pipeline::handler complete)
+  : complete_(std::move(complete)),
+    parsing_(settings.queue_depth),
+    precomputing_(settings.queue_depth),
+    verifying_(settings.queue_depth),
+    pool_(pool_settings{ settings.verify_threads, {},
+        settings.in_order, false, false }),
+    submitted_(0),
+    submit_blocked_nanoseconds_(0),
+    signature_checks_(0),
+    handler_exceptions_(0),
+    completed_(0)
+{
+    const auto parsers = std::max(settings.parse_threads, size_t{ 1 });
+    const auto precomputers = std::max(settings.precompute_threads,
+        size_t{ 1 });
+
+    // Stages that have started are stopped if any cannot be started.
+    try
+    {
+        for (size_t index = 0; index < parsers; ++index)
+            parse_.threads.emplace_back(&implementation::parse, this);
+
+        for (size_t index = 0; index < precomputers; ++index)
+            precompute_.threads.emplace_back(&implementation::precompute,
+                this);
+
+        verify_.threads.emplace_back(&implementation::verify, this);
+    }
+    catch (const std::exception&)
+    {
+        stop();
+        throw;
+    }
+}
+
+block_pipeline::implementation::~implementation()
+{
+    stop();
+}
+
+// Each stage is closed once its predecessor has stopped, so that the blocks
+// in flight complete.
+void block_pipeline::implementation::stop() noexcept
+{
+    const auto join = [](stage& stopping)
+    {
+        for (auto& thread: stopping.threads)
+            thread.join();
+
+        stopping.threads.clear();
+    };
+
+    parsing_.close();
+    join(parse_);
+    precomputing_.close();
+    join(precompute_);
+    verifying_.close();
+    join(verify_);
+}
+
+uint64_t block_pipeline::implementation::submit(const block_reference& block,
+    uint32_t flags)
+{
+    auto job = make_block_job(block, flags,
+        get_implementation(pool_).in_order());
+    const auto sequence = submitted_++;
+    parsing_.push({ sequence, std::move(job) }, submit_blocked_nanoseconds_);
+    return sequence;
+}
+
+void block_pipeline::implementation::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [&]()
+    {
+        return completed_ == submitted_.load();
+    });
+}
+
+stage_statistics block_pipeline::implementation::statistics(
+    const stage& counters, const queue& waiting)
+{
+    return
+    {
+        counters.blocks.load(std::memory_order_relaxed),
+        counters.items.load(std::memory_order_relaxed),
+        counters.busy_nanoseconds.load(std::memory_order_relaxed),
+        counters.starved_nanoseconds.load(std::memory_order_relaxed),
+        counters.blocked_nanoseconds.load(std::memory_order_relaxed),
+        waiting.size()
+    };
+}
+
+pipeline_statistics block_pipeline::implementation::statistics() const
+{
+    return
+    {
+        statistics(parse_, parsing_),
+        statistics(precompute_, precomputing_),
+        statistics(verify_, verifying_),
+        submit_blocked_nanoseconds_.load(std::memory_order_relaxed),
+        signature_checks_.load(std::memory_order_relaxed),
+        handler_exceptions_.load(std::memory_order_relaxed)
+    };
+}
+
+void block_pipeline::implementation::parse()
+{
+    entry next;
+    while (parsing_.pop(next, parse_.starved_nanoseconds))
+    {
+        const auto start = steady_clock::now();
+        next.block->parse();
+        add_since(parse_.busy_nanoseconds, start);
+
+        ++parse_.blocks;
+        parse_.items += next.block->transactions();
+        precomputing_.push(std::move(next), parse_.blocked_nanoseconds);
+    }
+}
+
+void block_pipeline::implementation::precompute()
+{
+    entry next;
+    while (precomputing_.pop(next, precompute_.starved_nanoseconds))
+    {
+        const auto start = steady_clock::now();
+        next.block->precompute();
+        add_since(precompute_.busy_nanoseconds, start);
+
+        ++precompute_.blocks;
+        precompute_.items += next.block->transactions();
+        verifying_.push(std::move(next), precompute_.blocked_nanoseconds);
+    }
+}
+
+// The stage thread verifies alongside the workers of the pool.
+void block_pipeline::implementation::verify()
+{
+    verification_context context;
+    entry next;
+
+    while (verifying_.pop(next, verify_.starved_nanoseconds))
+    {
+        const auto inputs = next.block->inputs();
+        const auto start = steady_clock::now();
+        auto result = verify_evaluation_throws;
+
+        try
+        {
+            get_implementation(pool_).run(*next.block, inputs, context,
+                verify_lane_block, next.block->data());
+            result = next.block->result();
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        add_since(verify_.busy_nanoseconds, start);
+        ++verify_.blocks;
+        verify_.items += inputs;
+        signature_checks_ += next.block->signature_checks();
+
+        // The block is completed regardless, so that drain does not wait.
+        try
+        {
+            complete_(next.sequence, result);
+        }
+        catch (...)
+        {
+            ++handler_exceptions_;
+        }
+
+        next.block.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++completed_;
+        }
+
+        drained_.notify_all();
+    }
+}
+
+block_pipeline::block_pipeline(const pipeline_settings& settings,
+    handler complete)
+  : implementation_(std::make_unique<implementation>(settings,
+        std::move(complete)))
+{
+}
+
+block_pipeline::~block_pipeline() = default;
+
+uint64_t block_pipeline::submit(const block_reference& block, uint32_t flags)
+{
+    return implementation_->submit(block, flags);
+}
+
+void block_pipeline::drain()
+{
+    implementation_->drain();
+}
+
+pipeline_statistics block_pipeline::statistics() const
+{
+    return implementation_->statistics();
+}
+
+} // namespace consensus
+} // namespace libbitcoin
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CONSENSUS_PIPELINE_HPP
+#define LIBBITCOIN_CONSENSUS_PIPELINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/export.hpp>
+#include "consensus/pool.hpp"
+
+namespace libbitcoin {
+namespace consensus {
+
+// A block passing through the stages of a pipeline, its inputs verified as
+// the items of a pool job.
+class block_job
+  : public job
+{
+public:
+    // Parses and checks the transactions, failing the block if invalid.
+    virtual void parse() noexcept = 0;
+
+    // Precomputes the signature hashes shared by each transaction's inputs.
+    virtual void precompute() noexcept = 0;
+
+    // The parsed transactions and the inputs to verify, zero once failed.
+    virtual size_t transactions() const noexcept = 0;
+    virtual size_t inputs() const noexcept = 0;
+
+    // The serialized block, to which its inputs have node affinity.
+    virtual const void* data() const noexcept = 0;
+
+    virtual verify_result result() const noexcept = 0;
+
+    // The signatures verified in the block's inputs.
+    virtual uint64_t signature_checks() const noexcept = 0;
+};
+
+// Defined with the verification of transactions (consensus.cpp).
+std::unique_ptr<block_job> make_block_job(const block_reference& block,
+    uint32_t flags, bool in_order);
+
+struct block_pipeline::implementation
+{
+    implementation(const pipeline_settings& settings,
+        block_pipeline::handler complete);
+    ~implementation();
+
+    uint64_t submit(const block_reference& block, uint32_t flags);
+    void drain();
+    pipeline_statistics statistics() const;
+
+private:
+    struct entry
+    {
+        uint64_t sequence;
+        std::unique_ptr<block_job> block;
+    };
+
+    // The blocks waiting for a stage, closed to stop the stage once empty.
+    class queue
+    {
+    public:
+        explicit queue(size_t capacity);
+
+        // Waits while full, adding the wait to blocked.
+        void push(entry&& value, std::atomic<uint64_t>& blocked);
+
+        // Waits while empty and open, adding the wait to starved. False once
+        // closed and empty.
+        bool pop(entry& out, std::atomic<uint64_t>& starved);
+
+        void close();
+        size_t size() const;
+
+    private:
+        const size_t capacity_;
+        mutable std::mutex mutex_;
+        std::condition_variable pushed_;
+        std::condition_variable popped_;
+        std::deque<entry> entries_;
+        bool closed_;
+    };
+
+    struct stage
+    {
+        std::atomic<uint64_t> blocks{ 0 };
+        std::atomic<uint64_t> items{ 0 };
+        std::atomic<uint64_t> busy_nanoseconds{ 0 };
+        std::atomic<uint64_t> starved_nanoseconds{ 0 };
+        std::atomic<uint64_t> blocked_nanoseconds{ 0 };
+        std::vector<std::thread> threads;
+    };
+
+    void parse();
+    void precompute();
+    void verify();
+    void stop() noexcept;
+
+    static stage_statistics statistics(const stage& counters,
+        const queue& waiting);
+
+    const block_pipeline::handler complete_;
+    queue parsing_;
+    queue precomputing_;
+    queue verifying_;
+    stage parse_;
+    stage precompute_;
+    stage verify_;
+    verification_pool pool_;
+    std::atomic<uint64_t> submitted_;
+    std::atomic<uint64_t> submit_blocked_nanoseconds_;
+    std::atomic<uint64_t> signature_checks_;
+    std::atomic<uint64_t> handler_exceptions_;
+    uint64_t completed_;
+    std::mutex mutex_;
+    std::condition_variable drained_;
+};
+
+} // namespace consensus
+} // namespace libbitcoin
+
+#endif
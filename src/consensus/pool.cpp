@@ -0,0 +1,575 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "consensus/pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/export.hpp>
+
+#if defined(__linux__)
+    #include <dirent.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+namespace libbitcoin {
+namespace consensus {
+
+// The node of a worker or of memory that is not known.
+static constexpr size_t any_node = std::numeric_limits<size_t>::max();
+
+struct node_processors
+{
+    size_t node;
+    std::vector<size_t> processors;
+};
+
+// Pins the calling thread to the processors, where supported.
+static void pin(const std::vector<size_t>& processors)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto processor: processors)
+        if (processor < CPU_SETSIZE)
+            CPU_SET(processor, &set);
+
+    if (CPU_COUNT(&set) != 0)
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (const auto processor: processors)
+        if (processor < sizeof(DWORD_PTR) * 8)
+            mask |= static_cast<DWORD_PTR>(1) << processor;
+
+    if (mask != 0)
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+    (void)processors;
+#endif
+}
+
+// Parses a processor list such as "0-7,16-23".
+static std::vector<size_t> parse_processors(const std::string& list)
+{
+    std::vector<size_t> out;
+    std::istringstream stream(list);
+    std::string range;
+
+    while (std::getline(stream, range, ','))
+    {
+        char* end = nullptr;
+        const auto first = std::strtoul(range.c_str(), &end, 10);
+        if (end == range.c_str())
+            continue;
+
+        const auto last = *end == '-' ? std::strtoul(end + 1, nullptr, 10) :
+            first;
+
+        for (auto processor = first; processor <= last; ++processor)
+            out.push_back(processor);
+    }
+
+    return out;
+}
+
+// The nodes that have processors, or a single node of unknown processors
+// where the topology cannot be read (which leaves the workers unpinned).
+static std::vector<node_processors> topology()
+{
+    std::vector<node_processors> nodes;
+
+#if defined(__linux__)
+    static const std::string root{ "/sys/devices/system/node/" };
+    if (const auto directory = opendir(root.c_str()))
+    {
+        while (const auto entry = readdir(directory))
+        {
+            const std::string name{ entry->d_name };
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+                name.find_first_not_of("0123456789", 4) != std::string::npos)
+                continue;
+
+            std::ifstream file(root + name + "/cpulist");
+            std::string list;
+            if (!std::getline(file, list))
+                continue;
+
+            auto processors = parse_processors(list);
+            if (!processors.empty())
+                nodes.push_back({ std::stoul(name.substr(4)),
+                    std::move(processors) });
+        }
+
+        closedir(directory);
+    }
+
+    std::sort(nodes.begin(), nodes.end(),
+        [](const node_processors& left, const node_processors& right)
+        {
+            return left.node < right.node;
+        });
+#endif
+
+    if (nodes.empty())
+        nodes.push_back({ 0, {} });
+
+    return nodes;
+}
+
+// The node on which the page holding the address is allocated, if known.
+static size_t node_of(const void* address)
+{
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    // MPOL_F_NODE | MPOL_F_ADDR, defined here so as not to require libnuma.
+    constexpr unsigned long node_of_address = 1 | 2;
+
+    int node = -1;
+    if (address != nullptr && syscall(SYS_get_mempolicy, &node, nullptr, 0,
+        address, node_of_address) == 0 && node >= 0)
+        return static_cast<size_t>(node);
+#else
+    (void)address;
+#endif
+
+    return any_node;
+}
+
+verification_pool::implementation::implementation(
+    const pool_settings& settings)
+  : in_order_(settings.in_order), numa_(settings.numa),
+    spin_(settings.spin), started_(0), stopping_(false)
+{
+    const auto nodes = numa_ ? topology() : std::vector<node_processors>{};
+
+    auto threads = settings.threads;
+    if (threads == 0 && numa_ && !nodes.front().processors.empty())
+        for (const auto& node: nodes)
+            threads += node.processors.size();
+
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // All deques exist before any worker starts stealing from them. Under
+    // numa the nodes are taken in turn, so that each has a share of workers.
+    for (size_t index = 0; index < threads; ++index)
+    {
+        auto next = std::make_unique<worker>();
+        next->node = any_node;
+
+        if (numa_)
+        {
+            const auto& node = nodes[index % nodes.size()];
+            next->node = node.node;
+            next->processors = node.processors;
+        }
+        else if (!settings.processors.empty())
+        {
+            next->processors.push_back(settings.processors[index %
+                settings.processors.size()]);
+        }
+
+        const auto existing = std::find_if(groups_.begin(), groups_.end(),
+            [&](const group& candidate)
+            {
+                return candidate.node == next->node;
+            });
+
+        if (existing == groups_.end())
+            groups_.push_back({ next->node, { index } });
+        else
+            existing->workers.push_back(index);
+
+        everyone_.push_back(index);
+        workers_.push_back(std::move(next));
+    }
+
+    try
+    {
+        for (; started_ < threads; ++started_)
+            workers_[started_]->thread = std::thread(&implementation::work,
+                this, started_);
+    }
+    catch (const std::exception&)
+    {
+        // Tasks dealt to a worker that did not start are stolen from it.
+    }
+}
+
+verification_pool::implementation::~implementation()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    ready_.notify_all();
+    for (size_t index = 0; index < started_; ++index)
+        workers_[index]->thread.join();
+}
+
+size_t verification_pool::implementation::threads() const noexcept
+{
+    return started_;
+}
+
+bool verification_pool::implementation::in_order() const noexcept
+{
+    return in_order_;
+}
+
+lane_statistics verification_pool::implementation::statistics(
+    verify_lane lane) const noexcept
+{
+    if (lane >= verify_lanes)
+        return {};
+
+    const auto& counters = lanes_[lane];
+    return
+    {
+        counters.batches.load(std::memory_order_relaxed),
+        counters.tasks.load(std::memory_order_relaxed),
+        counters.queued.load(std::memory_order_relaxed),
+        counters.latency_nanoseconds.load(std::memory_order_relaxed),
+        counters.max_latency_nanoseconds.load(std::memory_order_relaxed)
+    };
+}
+
+std::vector<worker_statistics>
+verification_pool::implementation::statistics() const
+{
+    std::vector<worker_statistics> out;
+    out.reserve(started_);
+
+    for (size_t index = 0; index < started_; ++index)
+    {
+        const auto& worker = *workers_[index];
+        out.push_back(
+        {
+            worker.tasks_run.load(std::memory_order_relaxed),
+            worker.steals.load(std::memory_order_relaxed),
+            worker.idle_nanoseconds.load(std::memory_order_relaxed)
+        });
+    }
+
+    return out;
+}
+
+// The workers of the node holding the data, or all workers.
+const std::vector<size_t>& verification_pool::implementation::targets(
+    const void* data) const noexcept
+{
+    if (!numa_ || groups_.size() < 2)
+        return everyone_;
+
+    const auto node = node_of(data);
+    for (const auto& group: groups_)
+        if (group.node == node)
+            return group.workers;
+
+    return everyone_;
+}
+
+void verification_pool::implementation::run(job& work, size_t items,
+    verification_context& context, verify_lane lane, const void* data)
+{
+    using namespace std::chrono;
+    if (items == 0)
+        return;
+
+    // An undefined lane is the lowest.
+    if (lane >= verify_lanes)
+        lane = static_cast<verify_lane>(verify_lanes - 1);
+
+    const auto start = steady_clock::now();
+    auto& counters = lanes_[lane];
+    batch current{ work, { items }, {}, {} };
+    const auto& dealt = targets(data);
+    const auto workers = dealt.size();
+
+    // Items are dealt in turn, so that each deque holds a spread of the batch.
+    for (size_t index = 0; index < workers; ++index)
+    {
+        auto& worker = *workers_[dealt[index]];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        for (auto item = index; item < items; item += workers)
+            worker.tasks[lane].push_back({ &current, item });
+
+        if (index < items)
+            counters.queued += (items - index - 1) / workers + 1;
+    }
+
+    counters.tasks.fetch_add(items, std::memory_order_relaxed);
+
+    // Taken under the mutex, so that a waiting worker cannot miss the items.
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+    ready_.notify_all();
+
+    // The submitter steals alongside the workers until its batch is taken,
+    // never from a lower lane, which would delay the completion of its own.
+    task next;
+    bool stolen;
+    while (current.pending.load() != 0 &&
+        take(workers_.size(), lane + 1, next, stolen))
+        complete(next, context);
+
+    // The wait below still takes the mutex, which the last worker may hold.
+    if (spin_)
+        while (current.pending.load() != 0)
+            std::this_thread::yield();
+
+    {
+        std::unique_lock<std::mutex> lock(current.mutex);
+        current.done.wait(lock, [&]()
+        {
+            return current.pending.load() == 0;
+        });
+    }
+
+    const auto latency = static_cast<uint64_t>(duration_cast<nanoseconds>(
+        steady_clock::now() - start).count());
+
+    counters.batches.fetch_add(1, std::memory_order_relaxed);
+    counters.latency_nanoseconds.fetch_add(latency, std::memory_order_relaxed);
+
+    auto greatest = counters.max_latency_nanoseconds.load();
+    while (latency > greatest &&
+        !counters.max_latency_nanoseconds.compare_exchange_weak(greatest,
+            latency));
+}
+
+// Takes a task of the highest lane below lanes, from the worker's own deque
+// or else from another's. The submitter (index of workers) only steals.
+bool verification_pool::implementation::take(size_t index, size_t lanes,
+    task& out, bool& stolen)
+{
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+        if (lanes_[lane].queued.load() == 0)
+            continue;
+
+        stolen = false;
+        if (index < workers_.size() && pop(*workers_[index], lane, out))
+            return true;
+
+        stolen = true;
+        if (steal(index, lane, out))
+            return true;
+    }
+
+    return false;
+}
+
+bool verification_pool::implementation::pop(worker& self, size_t lane,
+    task& out)
+{
+    std::lock_guard<std::mutex> lock(self.mutex);
+    auto& tasks = self.tasks[lane];
+    if (tasks.empty())
+        return false;
+
+    out = tasks.front();
+    tasks.pop_front();
+    --lanes_[lane].queued;
+    return true;
+}
+
+// Takes from the back of the deque of another worker, beginning after the
+// thief so that thieves are spread across their victims. Workers of the
+// thief's node are robbed before those of other nodes.
+bool verification_pool::implementation::steal(size_t thief, size_t lane,
+    task& out)
+{
+    const auto workers = workers_.size();
+    const auto home = thief < workers ? workers_[thief]->node : any_node;
+
+    for (const auto local: { true, false })
+    {
+        for (size_t offset = 1; offset <= workers; ++offset)
+        {
+            const auto victim = (thief + offset) % workers;
+            auto& worker = *workers_[victim];
+            if (victim == thief || (worker.node == home) != local)
+                continue;
+
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& tasks = worker.tasks[lane];
+            if (tasks.empty())
+                continue;
+
+            out = tasks.back();
+            tasks.pop_back();
+            --lanes_[lane].queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void verification_pool::implementation::complete(const task& done,
+    verification_context& context)
+{
+    auto& owner = *done.owner;
+    owner.work.run(done.item, context);
+
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    if (--owner.pending == 0)
+        owner.done.notify_all();
+}
+
+void verification_pool::implementation::work(size_t index)
+{
+    using namespace std::chrono;
+    auto& self = *workers_[index];
+    pin(self.processors);
+
+    // Allocated once pinned, so that the arena is local to the worker's node.
+    std::unique_ptr<verification_context> context;
+    try
+    {
+        context = std::make_unique<verification_context>();
+    }
+    catch (const std::exception&)
+    {
+        // Tasks dealt to this worker are stolen from it.
+        return;
+    }
+
+    task next;
+    bool stolen;
+
+    // Lanes are taken in turn after each task, so that a higher lane's work
+    // preempts that of a lower lane between inputs.
+    while (true)
+    {
+        if (take(index, verify_lanes, next, stolen))
+        {
+            complete(next, *context);
+            self.tasks_run.fetch_add(1, std::memory_order_relaxed);
+            if (stolen)
+                self.steals.fetch_add(1, std::memory_order_relaxed);
+
+            continue;
+        }
+
+        const auto start = steady_clock::now();
+        auto stop = false;
+
+        if (spin_)
+        {
+            while (!stopping_.load() && !queued())
+                std::this_thread::yield();
+
+            stop = stopping_.load() && !queued();
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [&]()
+            {
+                return stopping_.load() || queued();
+            });
+
+            stop = stopping_.load() && !queued();
+        }
+
+        self.idle_nanoseconds.fetch_add(static_cast<uint64_t>(
+            duration_cast<nanoseconds>(steady_clock::now() - start).count()),
+            std::memory_order_relaxed);
+
+        if (stop)
+            return;
+    }
+}
+
+bool verification_pool::implementation::queued() const noexcept
+{
+    for (const auto& lane: lanes_)
+        if (lane.queued.load() != 0)
+            return true;
+
+    return false;
+}
+
+verification_pool::verification_pool()
+  : verification_pool(pool_settings{ 0, {}, false, false, false })
+{
+}
+
+verification_pool::verification_pool(const pool_settings& settings)
+  : implementation_(std::make_unique<implementation>(settings))
+{
+}
+
+verification_pool::~verification_pool() = default;
+
+verification_pool::implementation& get_implementation(
+    verification_pool& pool) noexcept
+{
+    return *pool.implementation_;
+}
+
+size_t verification_pool::threads() const noexcept
+{
+    return implementation_->threads();
+}
+
+std::vector<worker_statistics> verification_pool::statistics() const
+{
+    return implementation_->statistics();
+}
+
+lane_statistics verification_pool::statistics(verify_lane lane) const noexcept
+{
+    return implementation_->statistics(lane);
+}
+
+verification_pool& default_pool()
+{
+    static verification_pool pool;
+    return pool;
+}
+
+} // namespace consensus
+} // namespace libbitcoin
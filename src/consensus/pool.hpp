@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_CONSENSUS_POOL_HPP
+#define LIBBITCOIN_CONSENSUS_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <bitcoin/consensus/define.hpp>
+#include <bitcoin/consensus/export.hpp>
+
+namespace libbitcoin {
+namespace consensus {
+
+// Work submitted to a pool as a number of independent items.
+class job
+{
+public:
+    virtual ~job() = default;
+
+    // Runs the item, on a worker or the submitting thread, with its context.
+    virtual void run(size_t item, verification_context& context) noexcept = 0;
+};
+
+struct verification_pool::implementation
+{
+    explicit implementation(const pool_settings& settings);
+    ~implementation();
+
+    // Deals the items of the job across the workers' deques of the lane and
+    // runs items of the lane (or higher lanes) alongside the workers, with
+    // the context, until all items have run. Under numa the items are dealt
+    // to the workers of the node holding data (if known), others steal them.
+    void run(job& work, size_t items, verification_context& context,
+        verify_lane lane, const void* data);
+
+    size_t threads() const noexcept;
+    bool in_order() const noexcept;
+    std::vector<worker_statistics> statistics() const;
+    lane_statistics statistics(verify_lane lane) const noexcept;
+
+private:
+    // The items of a job in progress, completed under the mutex so that the
+    // submitter does not return while a worker is still signalling it.
+    struct batch
+    {
+        job& work;
+        std::atomic<size_t> pending;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    struct task
+    {
+        batch* owner;
+        size_t item;
+    };
+
+    struct worker
+    {
+        // Popped at the front by the worker, stolen from the back.
+        std::mutex mutex;
+        std::deque<task> tasks[verify_lanes];
+
+        // The node of the worker and the processors it pins itself to.
+        size_t node;
+        std::vector<size_t> processors;
+
+        std::atomic<uint64_t> tasks_run{ 0 };
+        std::atomic<uint64_t> steals{ 0 };
+        std::atomic<uint64_t> idle_nanoseconds{ 0 };
+        std::thread thread;
+    };
+
+    struct lane
+    {
+        std::atomic<size_t> queued{ 0 };
+        std::atomic<uint64_t> batches{ 0 };
+        std::atomic<uint64_t> tasks{ 0 };
+        std::atomic<uint64_t> latency_nanoseconds{ 0 };
+        std::atomic<uint64_t> max_latency_nanoseconds{ 0 };
+    };
+
+    bool take(size_t index, size_t lanes, task& out, bool& stolen);
+    bool pop(worker& self, size_t lane, task& out);
+    bool steal(size_t thief, size_t lane, task& out);
+    void complete(const task& done, verification_context& context);
+    void work(size_t index);
+    bool queued() const noexcept;
+
+    // The workers of a node, in the order items are dealt to them.
+    struct group
+    {
+        size_t node;
+        std::vector<size_t> workers;
+    };
+
+    const std::vector<size_t>& targets(const void* data) const noexcept;
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::vector<group> groups_;
+    std::vector<size_t> everyone_;
+    const bool in_order_;
+    const bool numa_;
+    const bool spin_;
+    size_t started_;
+    lane lanes_[verify_lanes];
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::atomic<bool> stopping_;
+};
+
+// The workers of the pool, a friend of the published class.
+verification_pool::implementation& get_implementation(
+    verification_pool& pool) noexcept;
+
+} // namespace consensus
+} // namespace libbitcoin
+
+#endif
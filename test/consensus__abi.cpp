@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.h>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__abi)
+
+using namespace libbitcoin::consensus;
+
+// Test case derived from:
+// github.com/libbitcoin/libbitcoin-explorer/wiki/How-to-Spend-Bitcoin
+#define CONSENSUS_ABI_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_ABI_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+#define CONSENSUS_ABI_WRONG_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac"
+
+static const uint32_t flags = bck_verify_flags_p2sh;
+
+// test helper
+static bck_output output(const data_chunk& script, uint64_t value=0)
+{
+    return { script.data(), script.size(), value };
+}
+
+// test helper
+static bck_transaction transaction(const data_chunk& tx,
+    const bck_output& prevout)
+{
+    return { tx.data(), tx.size(), &prevout, 1 };
+}
+
+// bck_version
+
+BOOST_AUTO_TEST_CASE(consensus__abi__version__expected)
+{
+    BOOST_REQUIRE_EQUAL(std::strcmp(bck_version(), LIBBITCOIN_CONSENSUS_VERSION), 0);
+}
+
+// bck_verify_script
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_script__valid__true)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    const auto script = decode(CONSENSUS_ABI_PREVOUT_SCRIPT);
+    const auto prevout = output(script);
+    BOOST_REQUIRE_EQUAL(bck_verify_script(tx.data(), tx.size(), &prevout, 0, flags), bck_verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_script__incorrect_pubkey_hash__equalverify)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    const auto script = decode(CONSENSUS_ABI_WRONG_PREVOUT_SCRIPT);
+    const auto prevout = output(script);
+    BOOST_REQUIRE_EQUAL(bck_verify_script(tx.data(), tx.size(), &prevout, 0, flags), bck_verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_script__null_prevout__tx_input_invalid)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    BOOST_REQUIRE_EQUAL(bck_verify_script(tx.data(), tx.size(), nullptr, 0, flags), bck_verify_result_tx_input_invalid);
+}
+
+// bck_verify_transaction
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_transaction__valid__true)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    const auto script = decode(CONSENSUS_ABI_PREVOUT_SCRIPT);
+    const auto prevout = output(script);
+    const auto reference = transaction(tx, prevout);
+    bck_result result{ bck_verify_result_eval_false, 42 };
+    BOOST_REQUIRE_EQUAL(bck_verify_transaction(&result, &reference, flags), bck_verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(result.code, bck_verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(result.input, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_transaction__null_result__equalverify)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    const auto script = decode(CONSENSUS_ABI_WRONG_PREVOUT_SCRIPT);
+    const auto prevout = output(script);
+    const auto reference = transaction(tx, prevout);
+    BOOST_REQUIRE_EQUAL(bck_verify_transaction(nullptr, &reference, flags), bck_verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_transaction__trailing_byte__tx_size_invalid)
+{
+    auto tx = decode(CONSENSUS_ABI_TX);
+    tx.push_back(0x42);
+    const auto script = decode(CONSENSUS_ABI_PREVOUT_SCRIPT);
+    const auto prevout = output(script);
+    const auto reference = transaction(tx, prevout);
+    bck_result result;
+    BOOST_REQUIRE_EQUAL(bck_verify_transaction(&result, &reference, flags), bck_verify_result_tx_size_invalid);
+    BOOST_REQUIRE_EQUAL(result.code, bck_verify_result_tx_size_invalid);
+    BOOST_REQUIRE_EQUAL(result.input, 0u);
+}
+
+// bck_verify_transactions
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_transactions__empty__true)
+{
+    BOOST_REQUIRE_EQUAL(bck_verify_transactions(nullptr, nullptr, 0, flags, 0), bck_verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__abi__verify_transactions__failures__first_failure)
+{
+    const auto tx = decode(CONSENSUS_ABI_TX);
+    const auto valid = decode(CONSENSUS_ABI_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_ABI_WRONG_PREVOUT_SCRIPT);
+    const auto valid_prevout = output(valid);
+    const auto invalid_prevout = output(invalid);
+    const auto overflow_prevout = output(valid, 0xffffffffffffffff);
+
+    std::vector<bck_transaction> transactions(8, transaction(tx, valid_prevout));
+    transactions[3] = transaction(tx, invalid_prevout);
+    transactions[6] = transaction(tx, overflow_prevout);
+    std::vector<bck_result> results(transactions.size(), { -1, 0xffffffff });
+
+    BOOST_REQUIRE_EQUAL(bck_verify_transactions(results.data(), transactions.data(), transactions.size(), flags, 3), bck_verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[0].code, bck_verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(results[3].code, bck_verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[6].code, bck_verify_value_overflow);
+    BOOST_REQUIRE_EQUAL(results[7].code, bck_verify_result_eval_true);
+
+    for (const auto& result: results)
+        BOOST_REQUIRE_EQUAL(result.input, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__block_pipeline)
+
+using namespace libbitcoin::consensus;
+
+#define CONSENSUS_BLOCK_PIPELINE_HEADER \
+    "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+
+#define CONSENSUS_BLOCK_PIPELINE_COINBASE \
+    "01000000" "01" \
+    "0000000000000000000000000000000000000000000000000000000000000000" "ffffffff" "03" "010203" "ffffffff" \
+    "01" "00f2052a01000000" "0151" \
+    "00000000"
+
+// See consensus__script_verify.
+#define CONSENSUS_BLOCK_PIPELINE_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_BLOCK_PIPELINE_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+#define CONSENSUS_BLOCK_PIPELINE_WITNESS_TX \
+    "010000000001015836964079411659db5a4cfddd70e3f0de0261268f86c998a69a143f47c6c83800000000171600149445e8b825f1a17d5e091948545c90654096db68ffffffff02d8be04000000000017a91422c17a06117b40516f9826804800003562e834c98700000000000000004d6a4b424950313431205c6f2f2048656c6c6f20536567576974203a2d29206b656570206974207374726f6e6721204c4c415020426974636f696e20747769747465722e636f6d2f6b6873396e6502483045022100aaa281e0611ba0b5a2cd055f77e5594709d611ad1233e7096394f64ffe16f5b202207e2dcc9ef3a54c24471799ab99f6615847b21be2a6b4e0285918fd025597c5740121021ec0613f21c4e81c4b300426e5e5d30fa651f41e9993223adbe74dbe603c74fb00000000"
+#define CONSENSUS_BLOCK_PIPELINE_WITNESS_PREVOUT_SCRIPT \
+    "a914642bda298792901eb1b48f654dd7225d99e5e68c87"
+
+// Two unsigned inputs, only the second having a witness (OP_DROP 1).
+#define CONSENSUS_BLOCK_PIPELINE_SECOND_INPUT_WITNESS_TX \
+    "01000000" "0001" "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "00" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "00" \
+    "02" "0101" "027551" \
+    "00000000"
+#define CONSENSUS_BLOCK_PIPELINE_DROP_TRUE_P2WSH \
+    "002033198a9bfef674ebddb9ffaa52928017b8472791e54c609cb95f278ac6b1e349"
+
+#define CONSENSUS_BLOCK_PIPELINE_BLOCK \
+    CONSENSUS_BLOCK_PIPELINE_HEADER "04" \
+    CONSENSUS_BLOCK_PIPELINE_COINBASE \
+    CONSENSUS_BLOCK_PIPELINE_TX \
+    CONSENSUS_BLOCK_PIPELINE_WITNESS_TX \
+    CONSENSUS_BLOCK_PIPELINE_SECOND_INPUT_WITNESS_TX
+
+static const uint32_t flags =
+    verify_flags_p2sh |
+    verify_flags_dersig |
+    verify_flags_nulldummy |
+    verify_flags_checklocktimeverify |
+    verify_flags_checksequenceverify |
+    verify_flags_witness;
+
+// test helper
+static outputs block_prevouts()
+{
+    return
+    {
+        { decode(CONSENSUS_BLOCK_PIPELINE_PREVOUT_SCRIPT), 0 },
+        { decode(CONSENSUS_BLOCK_PIPELINE_WITNESS_PREVOUT_SCRIPT), 500000 },
+        { decode("51"), 0 },
+        { decode(CONSENSUS_BLOCK_PIPELINE_DROP_TRUE_P2WSH), 0 }
+    };
+}
+
+// test helper
+static std::vector<output_reference> references(const outputs& prevouts)
+{
+    std::vector<output_reference> out;
+    for (const auto& prevout: prevouts)
+        out.push_back({ prevout.script.data(), prevout.script.size(), prevout.value });
+
+    return out;
+}
+
+// test helper
+class results
+{
+public:
+    block_pipeline::handler handler()
+    {
+        return [this](uint64_t sequence, verify_result result)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (sequence >= results_.size())
+                results_.resize(sequence + 1, verify_result_unknown_error);
+
+            results_[sequence] = result;
+        };
+    }
+
+    std::vector<verify_result> get()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<verify_result> results_;
+};
+
+BOOST_AUTO_TEST_CASE(consensus__block_pipeline__submit_valid__true)
+{
+    const auto block = decode(CONSENSUS_BLOCK_PIPELINE_BLOCK);
+    const auto prevouts = block_prevouts();
+    const auto spent = references(prevouts);
+    const block_reference reference{ block.data(), block.size(), spent.data(), spent.size() };
+
+    results handled;
+    block_pipeline pipeline({ 1, 1, 2, 2 }, handled.handler());
+
+    for (uint64_t sequence = 0; sequence < 8; ++sequence)
+        BOOST_REQUIRE_EQUAL(pipeline.submit(reference, flags), sequence);
+
+    pipeline.drain();
+    const auto out = handled.get();
+    BOOST_REQUIRE_EQUAL(out.size(), 8u);
+    for (const auto result: out)
+        BOOST_REQUIRE_EQUAL(result, verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_pipeline__submit_failures__expected)
+{
+    const auto block = decode(CONSENSUS_BLOCK_PIPELINE_BLOCK);
+    auto truncated = block;
+    truncated.pop_back();
+    const auto prevouts = block_prevouts();
+    const auto spent = references(prevouts);
+    auto wrong_prevouts = block_prevouts();
+    wrong_prevouts[0].script.back() = 0x00;
+    const auto wrong = references(wrong_prevouts);
+
+    results handled;
+    block_pipeline pipeline({ 2, 2, 2, 1 }, handled.handler());
+    pipeline.submit({ block.data(), block.size(), spent.data(), spent.size() }, flags);
+    pipeline.submit({ truncated.data(), truncated.size(), spent.data(), spent.size() }, flags);
+    pipeline.submit({ block.data(), block.size(), spent.data(), spent.size() - 1 }, flags);
+    pipeline.submit({ block.data(), block.size(), wrong.data(), wrong.size() }, flags);
+    pipeline.drain();
+
+    const auto out = handled.get();
+    BOOST_REQUIRE_EQUAL(out.size(), 4u);
+    BOOST_REQUIRE_EQUAL(out[0], verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(out[1], verify_result_tx_invalid);
+    BOOST_REQUIRE_EQUAL(out[2], verify_result_block_prevouts_invalid);
+    BOOST_REQUIRE_EQUAL(out[3], verify_block(block, wrong_prevouts, flags));
+    BOOST_REQUIRE(out[3] != verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_pipeline__statistics__counted)
+{
+    const auto block = decode(CONSENSUS_BLOCK_PIPELINE_BLOCK);
+    const auto prevouts = block_prevouts();
+    const auto spent = references(prevouts);
+
+    results handled;
+    block_pipeline pipeline({ 0, 0, 1, 0 }, handled.handler());
+    for (size_t count = 0; count < 3; ++count)
+        pipeline.submit({ block.data(), block.size(), spent.data(), spent.size() }, flags);
+
+    pipeline.drain();
+    const auto statistics = pipeline.statistics();
+    BOOST_REQUIRE_EQUAL(statistics.parse.blocks, 3u);
+    BOOST_REQUIRE_EQUAL(statistics.parse.items, 12u);
+    BOOST_REQUIRE_EQUAL(statistics.precompute.blocks, 3u);
+    BOOST_REQUIRE_EQUAL(statistics.verify.blocks, 3u);
+    BOOST_REQUIRE_EQUAL(statistics.verify.items, 12u);
+    BOOST_REQUIRE_EQUAL(statistics.verify.queued, 0u);
+
+    // One signature each for the p2pkh and nested p2wpkh inputs.
+    BOOST_REQUIRE_EQUAL(statistics.signature_checks, 6u);
+    BOOST_REQUIRE_EQUAL(statistics.handler_exceptions, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_pipeline__handler_throws__counted)
+{
+    const auto block = decode(CONSENSUS_BLOCK_PIPELINE_BLOCK);
+    const auto prevouts = block_prevouts();
+    const auto spent = references(prevouts);
+
+    const auto handler = [](uint64_t sequence, verify_result)
+    {
+        if (sequence % 2 == 0)
+            throw std::runtime_error("handler");
+    };
+
+    block_pipeline pipeline({ 1, 1, 1, 1 }, handler);
+    for (size_t count = 0; count < 3; ++count)
+        pipeline.submit({ block.data(), block.size(), spent.data(), spent.size() }, flags);
+
+    pipeline.drain();
+    const auto statistics = pipeline.statistics();
+    BOOST_REQUIRE_EQUAL(statistics.verify.blocks, 3u);
+    BOOST_REQUIRE_EQUAL(statistics.handler_exceptions, 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,429 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__block_verify)
+
+using namespace libbitcoin::consensus;
+
+#define CONSENSUS_BLOCK_VERIFY_HEADER \
+    "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+
+#define CONSENSUS_BLOCK_VERIFY_COINBASE \
+    "01000000" "01" \
+    "0000000000000000000000000000000000000000000000000000000000000000" "ffffffff" "03" "010203" "ffffffff" \
+    "01" "00f2052a01000000" "0151" \
+    "00000000"
+
+// See consensus__script_verify.
+#define CONSENSUS_BLOCK_VERIFY_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_BLOCK_VERIFY_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+#define CONSENSUS_BLOCK_VERIFY_WITNESS_TX \
+    "010000000001015836964079411659db5a4cfddd70e3f0de0261268f86c998a69a143f47c6c83800000000171600149445e8b825f1a17d5e091948545c90654096db68ffffffff02d8be04000000000017a91422c17a06117b40516f9826804800003562e834c98700000000000000004d6a4b424950313431205c6f2f2048656c6c6f20536567576974203a2d29206b656570206974207374726f6e6721204c4c415020426974636f696e20747769747465722e636f6d2f6b6873396e6502483045022100aaa281e0611ba0b5a2cd055f77e5594709d611ad1233e7096394f64ffe16f5b202207e2dcc9ef3a54c24471799ab99f6615847b21be2a6b4e0285918fd025597c5740121021ec0613f21c4e81c4b300426e5e5d30fa651f41e9993223adbe74dbe603c74fb00000000"
+#define CONSENSUS_BLOCK_VERIFY_WITNESS_PREVOUT_SCRIPT \
+    "a914642bda298792901eb1b48f654dd7225d99e5e68c87"
+
+// Two unsigned inputs, only the second having a witness (OP_DROP 1).
+#define CONSENSUS_BLOCK_VERIFY_SECOND_INPUT_WITNESS_TX \
+    "01000000" "0001" "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "00" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "00" \
+    "02" "0101" "027551" \
+    "00000000"
+#define CONSENSUS_BLOCK_VERIFY_DROP_TRUE_P2WSH \
+    "002033198a9bfef674ebddb9ffaa52928017b8472791e54c609cb95f278ac6b1e349"
+
+// Two inputs spending the same outpoint.
+#define CONSENSUS_BLOCK_VERIFY_DUPLICATE_INPUTS_TX \
+    "01000000" "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "00000000"
+
+#define CONSENSUS_BLOCK_VERIFY_BLOCK \
+    CONSENSUS_BLOCK_VERIFY_HEADER "04" \
+    CONSENSUS_BLOCK_VERIFY_COINBASE \
+    CONSENSUS_BLOCK_VERIFY_TX \
+    CONSENSUS_BLOCK_VERIFY_WITNESS_TX \
+    CONSENSUS_BLOCK_VERIFY_SECOND_INPUT_WITNESS_TX
+
+static const uint32_t flags =
+    verify_flags_p2sh |
+    verify_flags_dersig |
+    verify_flags_nulldummy |
+    verify_flags_checklocktimeverify |
+    verify_flags_checksequenceverify |
+    verify_flags_witness;
+
+// test helper
+static outputs block_prevouts()
+{
+    return
+    {
+        { decode(CONSENSUS_BLOCK_VERIFY_PREVOUT_SCRIPT), 0 },
+        { decode(CONSENSUS_BLOCK_VERIFY_WITNESS_PREVOUT_SCRIPT), 500000 },
+        { decode("51"), 0 },
+        { decode(CONSENSUS_BLOCK_VERIFY_DROP_TRUE_P2WSH), 0 }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__valid__true)
+{
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, block_prevouts(), flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__context__true)
+{
+    verification_context context;
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(context, block, block_prevouts(), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(verify_block(context, block, block_prevouts(), flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__context__signature_checks)
+{
+    verification_context context;
+    BOOST_REQUIRE_EQUAL(context.signature_checks(), 0u);
+
+    // One signature each for the p2pkh and nested p2wpkh inputs.
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(context, block, block_prevouts(), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(context.signature_checks(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__reference__true)
+{
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    const auto prevouts = block_prevouts();
+    std::vector<output_reference> references;
+
+    for (const auto& prevout: prevouts)
+        references.push_back({ prevout.script.data(), prevout.script.size(), prevout.value });
+
+    const block_reference reference{ block.data(), block.size(), references.data(), references.size() };
+    BOOST_REQUIRE_EQUAL(verify_block(reference, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__reference_pool_incorrect_pubkey_hash__equalverify)
+{
+    verification_pool pool({ 2, {}, false });
+    auto prevouts = block_prevouts();
+    prevouts[0].script = decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac");
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    std::vector<output_reference> references;
+
+    for (const auto& prevout: prevouts)
+        references.push_back({ prevout.script.data(), prevout.script.size(), prevout.value });
+
+    const block_reference reference{ block.data(), block.size(), references.data(), references.size() };
+    BOOST_REQUIRE_EQUAL(verify_block(pool, reference, flags), verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__context_reference_missing_prevout__block_prevouts_invalid)
+{
+    verification_context context;
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    const auto prevouts = block_prevouts();
+    std::vector<output_reference> references;
+
+    for (const auto& prevout: prevouts)
+        references.push_back({ prevout.script.data(), prevout.script.size(), prevout.value });
+
+    BOOST_REQUIRE_EQUAL(verify_block(context, { block.data(), block.size(), references.data(), references.size() }, flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(context.signature_checks(), 2u);
+    BOOST_REQUIRE_EQUAL(verify_block(context, { block.data(), block.size(), references.data(), references.size() - 1 }, flags), verify_result_block_prevouts_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__coinbase_only__true)
+{
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "01" CONSENSUS_BLOCK_VERIFY_COINBASE);
+    BOOST_REQUIRE_EQUAL(verify_block(block, {}, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__missing_prevout__block_prevouts_invalid)
+{
+    auto prevouts = block_prevouts();
+    prevouts.pop_back();
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_block_prevouts_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__extra_prevout__block_prevouts_invalid)
+{
+    auto prevouts = block_prevouts();
+    prevouts.push_back({ decode("51"), 0 });
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_block_prevouts_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__prevout_value_overflow__value_overflow)
+{
+    auto prevouts = block_prevouts();
+    prevouts[2].value = std::numeric_limits<uint64_t>::max();
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_value_overflow);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__incorrect_pubkey_hash__equalverify)
+{
+    auto prevouts = block_prevouts();
+    prevouts[0].script = decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac");
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__duplicate_inputs__tx_inputs_duplicate)
+{
+    // The transaction is rejected before its prevouts are obtained.
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "02"
+        CONSENSUS_BLOCK_VERIFY_COINBASE
+        CONSENSUS_BLOCK_VERIFY_DUPLICATE_INPUTS_TX);
+
+    BOOST_REQUIRE_EQUAL(verify_block(block, { { decode("51"), 0 }, { decode("51"), 0 } }, flags), verify_result_tx_inputs_duplicate);
+}
+
+// test helper
+static verify_result verify_block_serial(const data_chunk& block, const outputs& prevouts)
+{
+    verification_context context;
+    return verify_block(context, block, prevouts, flags);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__script_failure_before_duplicate_inputs__first_in_block_order)
+{
+    // The script failure of the first spend precedes the check failure of the last.
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "05"
+        CONSENSUS_BLOCK_VERIFY_COINBASE
+        CONSENSUS_BLOCK_VERIFY_TX
+        CONSENSUS_BLOCK_VERIFY_WITNESS_TX
+        CONSENSUS_BLOCK_VERIFY_SECOND_INPUT_WITNESS_TX
+        CONSENSUS_BLOCK_VERIFY_DUPLICATE_INPUTS_TX);
+
+    auto prevouts = block_prevouts();
+    prevouts[0].script = decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac");
+    prevouts.push_back({ decode("51"), 0 });
+    prevouts.push_back({ decode("51"), 0 });
+
+    BOOST_REQUIRE_EQUAL(verify_block_serial(block, prevouts), verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__script_failure_before_missing_prevout__first_in_block_order)
+{
+    // The script failure of the first spend precedes the missing prevout of the last.
+    auto prevouts = block_prevouts();
+    prevouts[0].script = decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac");
+    prevouts.pop_back();
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+
+    BOOST_REQUIRE_EQUAL(verify_block_serial(block, prevouts), verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__duplicate_inputs_before_script_failure__first_in_block_order)
+{
+    // The check failure of the first spend precedes the script failure of the last.
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "03"
+        CONSENSUS_BLOCK_VERIFY_COINBASE
+        CONSENSUS_BLOCK_VERIFY_DUPLICATE_INPUTS_TX
+        CONSENSUS_BLOCK_VERIFY_TX);
+
+    const outputs prevouts
+    {
+        { decode("51"), 0 },
+        { decode("51"), 0 },
+        { decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac"), 0 }
+    };
+
+    BOOST_REQUIRE_EQUAL(verify_block_serial(block, prevouts), verify_result_tx_inputs_duplicate);
+    BOOST_REQUIRE_EQUAL(verify_block(block, prevouts, flags), verify_result_tx_inputs_duplicate);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__cheap_failure_before_costly_failure__first_in_block_order)
+{
+    // The costlier signature spend is verified first, but its failure follows.
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "03"
+        CONSENSUS_BLOCK_VERIFY_COINBASE
+        "01000000" "01"
+        "2222222222222222222222222222222222222222222222222222222222222222" "00000000" "00" "ffffffff"
+        "01" "1027000000000000" "0151"
+        "00000000"
+        CONSENSUS_BLOCK_VERIFY_TX);
+
+    const outputs prevouts
+    {
+        { decode("00"), 0 },
+        { decode("76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac"), 0 }
+    };
+
+    verification_pool pool({ 2, {}, false });
+    std::vector<output_reference> references;
+    for (const auto& prevout: prevouts)
+        references.push_back({ prevout.script.data(), prevout.script.size(), prevout.value });
+
+    BOOST_REQUIRE_EQUAL(verify_block_serial(block, prevouts), verify_result_eval_false);
+    BOOST_REQUIRE_EQUAL(verify_block(pool, { block.data(), block.size(), references.data(), references.size() }, flags), verify_result_eval_false);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__truncated_transaction__tx_invalid)
+{
+    auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    block.pop_back();
+    BOOST_REQUIRE_EQUAL(verify_block(block, block_prevouts(), flags), verify_result_tx_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__trailing_byte__block_invalid)
+{
+    auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    block.push_back(0x42);
+    BOOST_REQUIRE_EQUAL(verify_block(block, block_prevouts(), flags), verify_result_block_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__short_header__block_invalid)
+{
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER);
+    const data_chunk truncated(block.begin(), block.end() - 1);
+    BOOST_REQUIRE_EQUAL(verify_block(truncated, {}, flags), verify_result_block_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__no_transactions__block_invalid)
+{
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_HEADER "00");
+    BOOST_REQUIRE_EQUAL(verify_block(block, {}, flags), verify_result_block_invalid);
+}
+
+// Serves outputs in order, recording the outpoints requested.
+class ordered_provider
+  : public prevout_provider
+{
+public:
+    ordered_provider(const outputs& prevouts)
+      : prevouts_(prevouts)
+    {
+    }
+
+    void prefetch(const outpoint* outpoints, size_t count) override
+    {
+        prefetched.assign(outpoints, outpoints + count);
+    }
+
+    bool get(output_reference& out, const outpoint& point) override
+    {
+        if (requested.size() == prevouts_.size())
+            return false;
+
+        const auto& prevout = prevouts_[requested.size()];
+        out = { prevout.script.data(), prevout.script.size(), prevout.value };
+        requested.push_back(point);
+        return true;
+    }
+
+    std::vector<outpoint> prefetched;
+    std::vector<outpoint> requested;
+
+private:
+    const outputs& prevouts_;
+};
+
+class throwing_provider
+  : public prevout_provider
+{
+public:
+    bool get(output_reference&, const outpoint&) override
+    {
+        throw std::runtime_error("unavailable");
+    }
+};
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__provider__true)
+{
+    const auto prevouts = block_prevouts();
+    ordered_provider provider(prevouts);
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, provider, flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(provider.requested.size(), 4u);
+    BOOST_REQUIRE_EQUAL(provider.prefetched.size(), 4u);
+
+    // The inputs of the second witness transaction, in block order.
+    BOOST_REQUIRE_EQUAL(provider.requested[2].hash[0], 0x11);
+    BOOST_REQUIRE_EQUAL(provider.requested[2].index, 0u);
+    BOOST_REQUIRE_EQUAL(provider.requested[3].hash[0], 0x22);
+    BOOST_REQUIRE_EQUAL(provider.requested[3].index, 1u);
+
+    for (size_t index = 0; index < provider.requested.size(); ++index)
+    {
+        BOOST_REQUIRE(provider.prefetched[index].hash == provider.requested[index].hash);
+        BOOST_REQUIRE_EQUAL(provider.prefetched[index].index, provider.requested[index].index);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__provider_context__true)
+{
+    verification_context context;
+    const auto prevouts = block_prevouts();
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    ordered_provider first(prevouts);
+    ordered_provider second(prevouts);
+    BOOST_REQUIRE_EQUAL(verify_block(context, block, first, flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(verify_block(context, block, second, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__provider_missing__block_prevouts_invalid)
+{
+    auto prevouts = block_prevouts();
+    prevouts.pop_back();
+    ordered_provider provider(prevouts);
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, provider, flags), verify_result_block_prevouts_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__provider_truncated__tx_invalid_not_requested)
+{
+    const auto prevouts = block_prevouts();
+    ordered_provider provider(prevouts);
+    auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    block.pop_back();
+    BOOST_REQUIRE_EQUAL(verify_block(block, provider, flags), verify_result_tx_invalid);
+    BOOST_REQUIRE(provider.prefetched.empty());
+    BOOST_REQUIRE(provider.requested.empty());
+}
+
+BOOST_AUTO_TEST_CASE(consensus__block_verify__provider_throws__evaluation_throws)
+{
+    throwing_provider provider;
+    const auto block = decode(CONSENSUS_BLOCK_VERIFY_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_block(block, provider, flags), verify_evaluation_throws);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__check_transaction)
+
+using namespace libbitcoin::consensus;
+
+#define CONSENSUS_CHECK_TRANSACTION_INPUT \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff"
+#define CONSENSUS_CHECK_TRANSACTION_OTHER_INPUT \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "00" "ffffffff"
+#define CONSENSUS_CHECK_TRANSACTION_NULL_PREVOUT \
+    "0000000000000000000000000000000000000000000000000000000000000000" "ffffffff"
+#define CONSENSUS_CHECK_TRANSACTION_OUTPUT \
+    "1027000000000000" "0151"
+
+// MAX_MONEY and MAX_MONEY + 1, little endian.
+#define CONSENSUS_CHECK_TRANSACTION_MAX_MONEY "0040075af0750700"
+#define CONSENSUS_CHECK_TRANSACTION_ABOVE_MAX_MONEY "0140075af0750700"
+
+static const uint32_t flags =
+    verify_flags_p2sh |
+    verify_flags_checklocktimeverify |
+    verify_flags_checksequenceverify;
+
+// test helper
+static data_chunk lock_transaction(const std::string& version,
+    const std::string& sequence, const std::string& locktime)
+{
+    return decode(version + "01"
+        "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" + sequence +
+        "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT + locktime);
+}
+
+// check_transaction
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__valid__true)
+{
+    const auto tx = decode("01000000" "02" CONSENSUS_CHECK_TRANSACTION_INPUT CONSENSUS_CHECK_TRANSACTION_OTHER_INPUT "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__context__true)
+{
+    verification_context context;
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(context, tx), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(check_transaction(context, tx), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__malformed__tx_invalid)
+{
+    auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    tx.pop_back();
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__trailing_byte__tx_size_invalid)
+{
+    auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    tx.push_back(0x42);
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_size_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__no_inputs__tx_inputs_empty)
+{
+    // Without inputs the (zero) marker terminates the transaction body.
+    const auto tx = decode("01000000" "00" "00" "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_inputs_empty);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__no_outputs__tx_outputs_empty)
+{
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "00" "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_outputs_empty);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__oversize__tx_oversize)
+{
+    // A 1,000,000 byte output script, exceeding a quarter of the block weight.
+    auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" "1027000000000000" "fe40420f00");
+    tx.resize(tx.size() + 1000000, 0x51);
+    const auto locktime = decode("00000000");
+    tx.insert(tx.end(), locktime.begin(), locktime.end());
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_oversize);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__negative_output__tx_output_value_invalid)
+{
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" "ffffffffffffffff" "0151" "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_output_value_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__output_above_max_money__tx_output_value_invalid)
+{
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" CONSENSUS_CHECK_TRANSACTION_ABOVE_MAX_MONEY "0151" "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_output_value_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__output_max_money__true)
+{
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "01" CONSENSUS_CHECK_TRANSACTION_MAX_MONEY "0151" "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__outputs_above_max_money__tx_outputs_value_overflow)
+{
+    const auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_INPUT "02"
+        CONSENSUS_CHECK_TRANSACTION_MAX_MONEY "0151"
+        CONSENSUS_CHECK_TRANSACTION_MAX_MONEY "0151"
+        "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_outputs_value_overflow);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__duplicate_inputs__tx_inputs_duplicate)
+{
+    const auto tx = decode("01000000" "03"
+        CONSENSUS_CHECK_TRANSACTION_INPUT
+        CONSENSUS_CHECK_TRANSACTION_OTHER_INPUT
+        CONSENSUS_CHECK_TRANSACTION_INPUT
+        "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_inputs_duplicate);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__distinct_indexes__true)
+{
+    // The same hash with distinct indexes.
+    const auto tx = decode("01000000" "02"
+        "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff"
+        "1111111111111111111111111111111111111111111111111111111111111111" "01000000" "00" "ffffffff"
+        "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__coinbase_script_sizes__expected)
+{
+    verification_context context;
+    for (size_t size = 0; size <= 101; ++size)
+    {
+        auto tx = decode("01000000" "01" CONSENSUS_CHECK_TRANSACTION_NULL_PREVOUT);
+        tx.push_back(static_cast<uint8_t>(size));
+        tx.resize(tx.size() + size, 0x51);
+        const auto rest = decode("ffffffff" "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+        tx.insert(tx.end(), rest.begin(), rest.end());
+
+        const auto expected = size < 2 || size > 100 ?
+            verify_result_tx_coinbase_script_size : verify_result_eval_true;
+        BOOST_CHECK_MESSAGE(check_transaction(context, tx) == expected, "size: " << size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_transaction__null_prevout__tx_prevout_null)
+{
+    const auto tx = decode("01000000" "02"
+        CONSENSUS_CHECK_TRANSACTION_INPUT
+        CONSENSUS_CHECK_TRANSACTION_NULL_PREVOUT "00" "ffffffff"
+        "01" CONSENSUS_CHECK_TRANSACTION_OUTPUT "00000000");
+    BOOST_REQUIRE_EQUAL(check_transaction(tx), verify_result_tx_prevout_null);
+}
+
+// check_locks
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__zero_locktime__true)
+{
+    const auto tx = lock_transaction("01000000", "00000000", "00000000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 0, 0, 0), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__height_locktime__expected)
+{
+    // Lock time is the last invalid height.
+    const auto tx = lock_transaction("01000000", "feffffff", "f4010000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 500, 0, 0), verify_result_tx_not_final);
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 501, 0, 0), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__time_locktime__expected)
+{
+    // 500000000 is the least time based lock time.
+    const auto tx = lock_transaction("01000000", "feffffff", "0065cd1d");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 1000, 500000000, 0), verify_result_tx_not_final);
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 1000, 500000001, 0), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__final_sequences__true)
+{
+    const auto tx = lock_transaction("01000000", "ffffffff", "f4010000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 1, 0, 0), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__relative_height__expected)
+{
+    // Spendable ten blocks after the block confirming the output.
+    const auto tx = lock_transaction("02000000", "0a000000", "00000000");
+    const confirmations confirmed{ { 100, 0 } };
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 109, 0, flags), verify_result_tx_sequence_locked);
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 110, 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__relative_time__expected)
+{
+    // Spendable two 512 second intervals after the prior median time past.
+    const auto tx = lock_transaction("02000000", "02004000", "00000000");
+    const confirmations confirmed{ { 100, 1000 } };
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 200, 2023, flags), verify_result_tx_sequence_locked);
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 200, 2024, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__relative_height_without_flag__true)
+{
+    const auto tx = lock_transaction("02000000", "0a000000", "00000000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 101, 0, verify_flags_p2sh), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__relative_height_version_one__true)
+{
+    const auto tx = lock_transaction("01000000", "0a000000", "00000000");
+    const confirmations confirmed{ { 100, 0 } };
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 101, 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__relative_height_disabled__true)
+{
+    const auto tx = lock_transaction("02000000", "0a000080", "00000000");
+    const confirmations confirmed{ { 100, 0 } };
+    BOOST_REQUIRE_EQUAL(check_locks(tx, confirmed, 101, 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__confirmations_mismatch__tx_confirmations_invalid)
+{
+    const auto tx = lock_transaction("02000000", "0a000000", "00000000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, {}, 110, 0, flags), verify_result_tx_confirmations_invalid);
+    BOOST_REQUIRE_EQUAL(check_locks(tx, { { 100, 0 }, { 100, 0 } }, 110, 0, flags), verify_result_tx_confirmations_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__confirmation_above_height__tx_confirmations_invalid)
+{
+    const auto tx = lock_transaction("02000000", "0a000000", "00000000");
+    BOOST_REQUIRE_EQUAL(check_locks(tx, { { 111, 0 } }, 110, 0, flags), verify_result_tx_confirmations_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__check_locks__context__expected)
+{
+    verification_context context;
+    const auto tx = lock_transaction("02000000", "0a000000", "00000000");
+    const confirmations confirmed{ { 100, 0 } };
+    BOOST_REQUIRE_EQUAL(check_locks(context, tx, confirmed, 109, 0, flags), verify_result_tx_sequence_locked);
+    BOOST_REQUIRE_EQUAL(check_locks(context, tx, confirmed, 110, 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
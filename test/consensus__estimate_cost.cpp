@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__estimate_cost)
+
+using namespace libbitcoin::consensus;
+
+// Test case derived from:
+// github.com/libbitcoin/libbitcoin-explorer/wiki/How-to-Spend-Bitcoin
+#define CONSENSUS_ESTIMATE_COST_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_ESTIMATE_COST_P2PKH \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+
+// 2-of-3 bare multisig.
+#define CONSENSUS_ESTIMATE_COST_KEY \
+    "21" "03e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31"
+#define CONSENSUS_ESTIMATE_COST_MULTISIG \
+    "52" CONSENSUS_ESTIMATE_COST_KEY CONSENSUS_ESTIMATE_COST_KEY \
+    CONSENSUS_ESTIMATE_COST_KEY "53ae"
+
+// Spends of a taproot output, by key path and by a single key tapscript.
+#define CONSENSUS_ESTIMATE_COST_KEY32 \
+    "e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31"
+#define CONSENSUS_ESTIMATE_COST_SIGNATURE \
+    "40" CONSENSUS_ESTIMATE_COST_KEY32 CONSENSUS_ESTIMATE_COST_KEY32
+#define CONSENSUS_ESTIMATE_COST_TAPROOT_TX(witness) \
+    "02000000" "0001" "01" \
+    "0000000000000000000000000000000000000000000000000000000000000000" \
+    "00000000" "00" "ffffffff" "01" "0000000000000000" "00" witness "00000000"
+#define CONSENSUS_ESTIMATE_COST_KEY_PATH \
+    CONSENSUS_ESTIMATE_COST_TAPROOT_TX("01" CONSENSUS_ESTIMATE_COST_SIGNATURE)
+#define CONSENSUS_ESTIMATE_COST_SCRIPT_PATH \
+    CONSENSUS_ESTIMATE_COST_TAPROOT_TX("03" CONSENSUS_ESTIMATE_COST_SIGNATURE \
+    "22" "20" CONSENSUS_ESTIMATE_COST_KEY32 "ac" \
+    "21" "c0" CONSENSUS_ESTIMATE_COST_KEY32)
+#define CONSENSUS_ESTIMATE_COST_P2TR \
+    "5120" CONSENSUS_ESTIMATE_COST_KEY32
+
+static const uint32_t flags = verify_flags_p2sh | verify_flags_witness;
+
+// test helper
+static transaction_reference reference(const data_chunk& transaction,
+    const output_reference& prevout)
+{
+    return { transaction.data(), transaction.size(), &prevout, 1 };
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__p2pkh__one_check)
+{
+    const auto tx = decode(CONSENSUS_ESTIMATE_COST_TX);
+    const auto script = decode(CONSENSUS_ESTIMATE_COST_P2PKH);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(cost, reference(tx, prevout), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(cost.signature_checks, 1u);
+
+    // The transaction without its scriptSig (107 bytes), with the scriptCode.
+    BOOST_REQUIRE_EQUAL(cost.sighash_bytes, tx.size() - 107u + script.size());
+    BOOST_REQUIRE_EQUAL(cost.validation_weight, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__bare_multisig__check_per_key)
+{
+    verification_context context;
+    const auto tx = decode(CONSENSUS_ESTIMATE_COST_TX);
+    const auto script = decode(CONSENSUS_ESTIMATE_COST_MULTISIG);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(context, cost, reference(tx, prevout), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(cost.signature_checks, 3u);
+    BOOST_REQUIRE_EQUAL(cost.sighash_bytes, 3u * (tx.size() - 107u + script.size()));
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__taproot_key_path__no_validation_weight)
+{
+    const auto tx = decode(CONSENSUS_ESTIMATE_COST_KEY_PATH);
+    const auto script = decode(CONSENSUS_ESTIMATE_COST_P2TR);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(cost, reference(tx, prevout), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(cost.signature_checks, 1u);
+    BOOST_REQUIRE(cost.sighash_bytes > 0u);
+    BOOST_REQUIRE_EQUAL(cost.validation_weight, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__tapscript__validation_weight)
+{
+    const auto tx = decode(CONSENSUS_ESTIMATE_COST_SCRIPT_PATH);
+    const auto script = decode(CONSENSUS_ESTIMATE_COST_P2TR);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(cost, reference(tx, prevout), flags), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(cost.signature_checks, 1u);
+    BOOST_REQUIRE_EQUAL(cost.validation_weight, 50u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__missing_prevout__tx_input_invalid)
+{
+    const auto tx = decode(CONSENSUS_ESTIMATE_COST_TX);
+    const transaction_reference transaction{ tx.data(), tx.size(), nullptr, 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(cost, transaction, flags), verify_result_tx_input_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__estimate_cost__truncated__tx_invalid)
+{
+    auto tx = decode(CONSENSUS_ESTIMATE_COST_TX);
+    tx.pop_back();
+    const auto script = decode(CONSENSUS_ESTIMATE_COST_P2PKH);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    transaction_cost cost;
+    BOOST_REQUIRE_EQUAL(estimate_cost(cost, reference(tx, prevout), flags), verify_result_tx_invalid);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+// These give us test accesss to unpublished symbols.
+#include "consensus/consensus.hpp"
+#include "script/interpreter.h"
+
+using namespace libbitcoin::consensus;
+
+BOOST_AUTO_TEST_SUITE(consensus__evaluate_script)
+
+// Each script is evaluated under every sigversion that executes script.
+static const SigVersion sigversions[]
+{
+    SigVersion::BASE,
+    SigVersion::WITNESS_V0,
+    SigVersion::TAPSCRIPT
+};
+
+// The consensus flags as each activated, standard policy, and all flags
+// that affect evaluation. The threaded interpreter is specialized for all
+// but the last.
+static const unsigned int flag_sets[]
+{
+    SCRIPT_VERIFY_NONE,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG |
+        SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG |
+        SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG |
+        SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY |
+        SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_NULLDUMMY,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_DERSIG |
+        SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY |
+        SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_NULLDUMMY |
+        SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_LOW_S |
+        SCRIPT_VERIFY_MINIMALDATA | SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS |
+        SCRIPT_VERIFY_CLEANSTACK | SCRIPT_VERIFY_MINIMALIF |
+        SCRIPT_VERIFY_NULLFAIL | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_DERSIG |
+        SCRIPT_VERIFY_LOW_S | SCRIPT_VERIFY_NULLDUMMY |
+        SCRIPT_VERIFY_MINIMALDATA | SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS |
+        SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY |
+        SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_MINIMALIF |
+        SCRIPT_VERIFY_NULLFAIL | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE |
+        SCRIPT_VERIFY_CONST_SCRIPTCODE
+};
+
+// test helper
+static void test_engines(const stack& initial, const data_chunk& input,
+    const data_chunk& output, const std::string& description)
+{
+    for (const auto sigversion: sigversions)
+    {
+        for (const auto flags: flag_sets)
+        {
+            // Each engine is compared with the switch over script bytes.
+            for (const auto engine: { script_engine::decoded, script_engine::threaded })
+            {
+                // The output is evaluated against the stack left by the input.
+                auto expected_stack = initial;
+                auto engine_stack = initial;
+                for (const auto& script: { input, output })
+                {
+                    const auto expected = evaluate_script(expected_stack,
+                        script, flags, sigversion, script_engine::reference);
+                    const auto result = evaluate_script(engine_stack, script,
+                        flags, sigversion, engine);
+
+                    BOOST_CHECK_MESSAGE(result == expected, description);
+                    BOOST_CHECK_MESSAGE(engine_stack == expected_stack, description);
+
+                    if (expected != SCRIPT_ERR_OK)
+                        break;
+                }
+            }
+        }
+    }
+}
+
+// test helper
+static void test_engines(const script_test_list& tests)
+{
+    for (const auto& test: tests)
+    {
+        test_engines({}, mnemonic_to_data(test.input),
+            mnemonic_to_data(test.output), test.description);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__bip16__same)
+{
+    test_engines(valid_bip16_scripts);
+    test_engines(invalidated_bip16_scripts);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__bip65__same)
+{
+    test_engines(valid_bip65_scripts);
+    test_engines(invalid_bip65_scripts);
+    test_engines(invalidated_bip65_scripts);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__multisig__same)
+{
+    test_engines(valid_multisig_scripts);
+    test_engines(invalid_multisig_scripts);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__context_free__same)
+{
+    test_engines(valid_context_free_scripts);
+    test_engines(invalid_context_free_scripts);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__push_data__same)
+{
+    test_engines(not_invalid_parse_scripts);
+    test_engines(valid_push_data_scripts);
+}
+
+// The operation count limit is reached through counted keys of
+// OP_CHECKMULTISIG and through operations in a skipped branch.
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__operation_count__same)
+{
+    // 0 0 [0 x 20] 20 checkmultisig drop
+    data_chunk multisig{ 0x00, 0x00 };
+    multisig.resize(multisig.size() + 20, 0x00);
+    multisig.insert(multisig.end(), { 0x01, 0x14, 0xae, 0x75 });
+
+    for (size_t multisigs = 0; multisigs <= 10; ++multisigs)
+    {
+        for (const size_t nops: { 0, 50, 150, 200 })
+        {
+            data_chunk script;
+            for (size_t count = 0; count < multisigs; ++count)
+                script.insert(script.end(), multisig.begin(), multisig.end());
+
+            // nop...nop 1, and 0 if nop...nop endif 1
+            data_chunk straight{ script }, skipped{ script };
+            straight.resize(straight.size() + nops, 0x61);
+            straight.push_back(0x51);
+            skipped.insert(skipped.end(), { 0x00, 0x63 });
+            skipped.resize(skipped.size() + nops, 0x61);
+            skipped.insert(skipped.end(), { 0x68, 0x51 });
+
+            test_engines({}, {}, straight, "straight");
+            test_engines({}, {}, skipped, "skipped");
+        }
+    }
+}
+
+// Failures that do not depend upon execution, in order of precedence.
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__static_failures__same)
+{
+    // 201 nops, then a disabled opcode (counted first).
+    data_chunk counted(201, 0x61);
+    counted.push_back(0x7e);
+    test_engines({}, {}, counted, "counted disabled opcode");
+
+    // 0 if codeseparator endif 1
+    test_engines({}, {}, { 0x00, 0x63, 0xab, 0x68, 0x51 }, "codeseparator");
+
+    // 0 if cat endif 1
+    test_engines({}, {}, { 0x00, 0x63, 0x7e, 0x68, 0x51 }, "disabled opcode");
+
+    // 0 if [521 bytes] endif 1
+    data_chunk oversized{ 0x00, 0x63, 0x4d, 0x09, 0x02 };
+    oversized.resize(oversized.size() + 521, 0x42);
+    oversized.insert(oversized.end(), { 0x68, 0x51 });
+    test_engines({}, {}, oversized, "oversized push");
+}
+
+// The stack size limit applies upon growth, and after any operation once the
+// initial stack is over the limit.
+BOOST_AUTO_TEST_CASE(consensus__evaluate_script__stack_size__same)
+{
+    // nop, toaltstack fromaltstack, and each operation that grows the stack.
+    const stack full(1000, data_chunk{ 0x01 });
+    test_engines(full, {}, { 0x61 }, "full nop");
+    test_engines(full, {}, { 0x6b, 0x6c }, "full alt");
+    for (const uint8_t opcode: { 0x00, 0x01, 0x4f, 0x51, 0x6e, 0x6f, 0x70,
+        0x73, 0x74, 0x76, 0x78, 0x7d, 0x82 })
+    {
+        test_engines(full, {}, { opcode, 0x42 }, "full growth");
+    }
+
+    const stack over(1001, data_chunk{ 0x01 });
+    test_engines(over, {}, {}, "over empty");
+    test_engines(over, {}, { 0x75 }, "over drop");
+
+    // notif nop...nop endif, still over after the pop, with the operation
+    // count exceeded in the skipped branch.
+    const stack further(1002, data_chunk{ 0x01 });
+    data_chunk skipped{ 0x64 };
+    skipped.resize(skipped.size() + 202, 0x61);
+    skipped.push_back(0x68);
+    test_engines(further, {}, skipped, "over skipped");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <string>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__extract_outpoints)
+
+using namespace libbitcoin::consensus;
+
+#define CONSENSUS_EXTRACT_OUTPOINTS_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+
+// Two inputs, only the second having a witness.
+#define CONSENSUS_EXTRACT_OUTPOINTS_WITNESS_TX \
+    "01000000" "0001" "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "025151" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "00" \
+    "02" "0101" "027551" \
+    "00000000"
+
+// The end of the inputs of CONSENSUS_EXTRACT_OUTPOINTS_WITNESS_TX, in bytes.
+static const size_t witness_tx_inputs_end = 4 + 2 + 1 + 41 + 43;
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__single_input__expected)
+{
+    outpoint outpoints[2];
+    size_t inputs = 0;
+    bool witness = true;
+    const auto tx = decode(CONSENSUS_EXTRACT_OUTPOINTS_TX);
+    BOOST_REQUIRE(extract_outpoints(outpoints, 2, inputs, witness, tx));
+    BOOST_REQUIRE_EQUAL(inputs, 1u);
+    BOOST_REQUIRE(!witness);
+    BOOST_REQUIRE_EQUAL(outpoints[0].hash[0], 0x7d);
+    BOOST_REQUIRE_EQUAL(outpoints[0].hash[31], 0x7c);
+    BOOST_REQUIRE_EQUAL(outpoints[0].index, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__witness__expected)
+{
+    outpoint outpoints[2];
+    size_t inputs = 0;
+    bool witness = false;
+    const auto tx = decode(CONSENSUS_EXTRACT_OUTPOINTS_WITNESS_TX);
+    BOOST_REQUIRE(extract_outpoints(outpoints, 2, inputs, witness, tx));
+    BOOST_REQUIRE_EQUAL(inputs, 2u);
+    BOOST_REQUIRE(witness);
+    BOOST_REQUIRE_EQUAL(outpoints[0].hash[0], 0x11);
+    BOOST_REQUIRE_EQUAL(outpoints[0].index, 0u);
+    BOOST_REQUIRE_EQUAL(outpoints[1].hash[0], 0x22);
+    BOOST_REQUIRE_EQUAL(outpoints[1].index, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__insufficient_capacity__counted)
+{
+    outpoint outpoints[1];
+    size_t inputs = 0;
+    bool witness = false;
+    const auto tx = decode(CONSENSUS_EXTRACT_OUTPOINTS_WITNESS_TX);
+    BOOST_REQUIRE(extract_outpoints(outpoints, 1, inputs, witness, tx));
+    BOOST_REQUIRE_EQUAL(inputs, 2u);
+    BOOST_REQUIRE_EQUAL(outpoints[0].hash[0], 0x11);
+
+    BOOST_REQUIRE(extract_outpoints(nullptr, 0, inputs, witness, tx));
+    BOOST_REQUIRE_EQUAL(inputs, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__truncated__inputs_required)
+{
+    outpoint outpoints[2];
+    size_t inputs = 0;
+    bool witness = false;
+    const auto tx = decode(CONSENSUS_EXTRACT_OUTPOINTS_WITNESS_TX);
+
+    // Outputs, witnesses and lock time are not read.
+    for (size_t size = 0; size <= tx.size(); ++size)
+    {
+        const data_chunk prefix(tx.begin(), tx.begin() + size);
+        const auto expected = size >= witness_tx_inputs_end;
+        BOOST_CHECK_MESSAGE(extract_outpoints(outpoints, 2, inputs, witness, prefix) == expected, "size: " << size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__malformed__false)
+{
+    static const std::string malformed[]
+    {
+        // Non-canonical input count.
+        "01000000" "fd0100" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" "00" "00000000",
+
+        // Unknown optional data.
+        "01000000" "0002" "01" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" "00" "00000000",
+
+        // Script size exceeding MAX_SIZE.
+        "01000000" "01" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "fe01000002" "ffffffff" "00" "00000000"
+    };
+
+    outpoint outpoints[1];
+    size_t inputs = 0;
+    bool witness = false;
+
+    for (const auto& hex: malformed)
+        BOOST_CHECK_MESSAGE(!extract_outpoints(outpoints, 1, inputs, witness, decode(hex)), hex);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__extract_outpoints__empty_inputs__none)
+{
+    size_t inputs = 1;
+    bool witness = true;
+    const auto tx = decode("01000000" "00" "00000000");
+    BOOST_REQUIRE(extract_outpoints(nullptr, 0, inputs, witness, tx));
+    BOOST_REQUIRE_EQUAL(inputs, 0u);
+    BOOST_REQUIRE(!witness);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+// These give us test accesss to unpublished symbols.
+#include "hash.h"
+#include "primitives/transaction.h"
+#include "script/script.h"
+#include "uint256.h"
+
+BOOST_AUTO_TEST_SUITE(consensus__lazy_hash)
+
+// test helper
+static CMutableTransaction transaction(bool witness)
+{
+    CMutableTransaction tx;
+    tx.nVersion = 1;
+    tx.nLockTime = 0;
+    tx.vin.resize(2);
+    tx.vin[0].prevout = COutPoint(uint256::ONE, 0);
+    tx.vin[1].prevout = COutPoint(uint256::ONE, 1);
+    tx.vin[1].scriptSig = CScript() << OP_1;
+    tx.vout.emplace_back(10000, CScript() << OP_1);
+
+    if (witness)
+        tx.vin[0].scriptWitness.stack = { { 0xaa }, {} };
+
+    return tx;
+}
+
+// test helper
+static uint256 witness_hash(const CMutableTransaction& tx)
+{
+    return SerializeHash(tx, SER_GETHASH, 0);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__lazy_hash__get__computed_once)
+{
+    size_t computed = 0;
+    const auto compute = [&]()
+    {
+        ++computed;
+        return uint256::ONE;
+    };
+
+    const LazyHash hash;
+    BOOST_REQUIRE_EQUAL(computed, 0u);
+    BOOST_REQUIRE_EQUAL(hash.Get(compute).GetHex(), uint256::ONE.GetHex());
+    BOOST_REQUIRE_EQUAL(hash.Get(compute).GetHex(), uint256::ONE.GetHex());
+    BOOST_REQUIRE_EQUAL(computed, 1u);
+
+    // A copy carries the computed hash.
+    const LazyHash copy(hash);
+    BOOST_REQUIRE_EQUAL(copy.Get(compute).GetHex(), uint256::ONE.GetHex());
+    BOOST_REQUIRE_EQUAL(computed, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__lazy_hash__copy_uncomputed__computed_by_copy)
+{
+    size_t computed = 0;
+    const auto compute = [&]()
+    {
+        ++computed;
+        return uint256::ONE;
+    };
+
+    const LazyHash hash;
+    const LazyHash copy(hash);
+    BOOST_REQUIRE_EQUAL(copy.Get(compute).GetHex(), uint256::ONE.GetHex());
+    BOOST_REQUIRE_EQUAL(hash.Get(compute).GetHex(), uint256::ONE.GetHex());
+    BOOST_REQUIRE_EQUAL(computed, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__lazy_hash__transaction_without_witness__eager_hashes)
+{
+    const auto mutable_tx = transaction(false);
+    const CTransaction tx(mutable_tx);
+    const auto& txid = tx.GetHash();
+    const auto& wtxid = tx.GetWitnessHash();
+
+    BOOST_REQUIRE(!tx.HasWitness());
+    BOOST_REQUIRE_EQUAL(txid.GetHex(), mutable_tx.GetHash().GetHex());
+    BOOST_REQUIRE_EQUAL(wtxid.GetHex(), txid.GetHex());
+    BOOST_REQUIRE_EQUAL(wtxid.GetHex(), witness_hash(mutable_tx).GetHex());
+
+    // Each is computed once, subsequent calls return the retained hash.
+    BOOST_REQUIRE_EQUAL(&tx.GetHash(), &txid);
+    BOOST_REQUIRE_EQUAL(&tx.GetWitnessHash(), &wtxid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__lazy_hash__transaction_with_witness__eager_hashes)
+{
+    const auto mutable_tx = transaction(true);
+    const CTransaction tx(mutable_tx);
+    const auto& txid = tx.GetHash();
+    const auto& wtxid = tx.GetWitnessHash();
+
+    BOOST_REQUIRE(tx.HasWitness());
+    BOOST_REQUIRE_EQUAL(txid.GetHex(), mutable_tx.GetHash().GetHex());
+    BOOST_REQUIRE_EQUAL(wtxid.GetHex(), witness_hash(mutable_tx).GetHex());
+    BOOST_REQUIRE(wtxid != txid);
+
+    // The witness does not change the txid.
+    BOOST_REQUIRE_EQUAL(txid.GetHex(), transaction(false).GetHash().GetHex());
+
+    // Each is computed once, subsequent calls return the retained hash.
+    BOOST_REQUIRE_EQUAL(&tx.GetHash(), &txid);
+    BOOST_REQUIRE_EQUAL(&tx.GetWitnessHash(), &wtxid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__lazy_hash__transaction_copy__equal_hashes)
+{
+    const CTransaction tx(transaction(true));
+    const auto txid = tx.GetHash();
+    const CTransaction copy(tx);
+
+    BOOST_REQUIRE_EQUAL(copy.GetHash().GetHex(), txid.GetHex());
+    BOOST_REQUIRE_EQUAL(copy.GetWitnessHash().GetHex(), tx.GetWitnessHash().GetHex());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
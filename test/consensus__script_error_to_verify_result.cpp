@@ -246,6 +246,11 @@ BOOST_AUTO_TEST_CASE(consensus__script_error_to_verify_result__OP_RETURN__op_ret
     BOOST_REQUIRE_EQUAL(script_error_to_verify_result(SCRIPT_ERR_OP_RETURN), verify_result_op_return);
 }
 
+BOOST_AUTO_TEST_CASE(consensus__script_error_to_verify_result__CANCELLED__cancelled)
+{
+    BOOST_REQUIRE_EQUAL(script_error_to_verify_result(SCRIPT_ERR_CANCELLED), verify_result_cancelled);
+}
+
 BOOST_AUTO_TEST_CASE(consensus__script_error_to_verify_result__UNKNOWN_ERROR__unknown_error)
 {
     BOOST_REQUIRE_EQUAL(script_error_to_verify_result(SCRIPT_ERR_UNKNOWN_ERROR), verify_result_unknown_error);
@@ -215,6 +215,190 @@ BOOST_AUTO_TEST_CASE(consensus__script_verify__context_free__invalid)
     }
 }
 
+// test helper
+static data_chunk large_push(uint8_t fill)
+{
+    // OP_PUSHDATA2 of the maximum script element size (520 bytes).
+    data_chunk push{ 0x4d, 0x08, 0x02 };
+    push.resize(push.size() + 520, fill);
+    return push;
+}
+
+// test helper
+static verify_result test_verify_unsigned_data(const data_chunk& input,
+    const data_chunk& prevout, const uint32_t flags)
+{
+    static const stack witness;
+    return verify_unsigned_script({ prevout, 0 }, input, witness, flags);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__duplicated_large_elements__true)
+{
+    // <a> OP_DUP OP_DUP OP_3DUP x199 (600 elements of 520 bytes, 201 ops).
+    auto prevout = large_push(0x42);
+    prevout.insert(prevout.end(), { 0x76, 0x76 });
+    prevout.insert(prevout.end(), 199, 0x6f);
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__duplicated_large_elements_compared__true)
+{
+    // <a> <b> OP_OVER 2 OP_PICK OP_EQUALVERIFY OP_DROP <a> OP_EQUAL
+    const auto a = large_push(0x01);
+    const auto b = large_push(0x02);
+    data_chunk prevout;
+    prevout.insert(prevout.end(), a.begin(), a.end());
+    prevout.insert(prevout.end(), b.begin(), b.end());
+    prevout.insert(prevout.end(), { 0x78, 0x52, 0x79, 0x88, 0x75 });
+    prevout.insert(prevout.end(), a.begin(), a.end());
+    prevout.push_back(0x87);
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__duplicated_large_elements_differ__eval_false)
+{
+    // <a> OP_DUP <b> OP_EQUAL
+    auto prevout = large_push(0x01);
+    prevout.push_back(0x76);
+    const auto b = large_push(0x02);
+    prevout.insert(prevout.end(), b.begin(), b.end());
+    prevout.push_back(0x87);
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_eval_false);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__unexecuted_branch_op_count__op_count)
+{
+    // 0 OP_IF OP_NOP x200 OP_ENDIF 1 (202 counted ops, none executed).
+    data_chunk prevout{ 0x00, 0x63 };
+    prevout.insert(prevout.end(), 200, 0x61);
+    prevout.insert(prevout.end(), { 0x68, 0x51 });
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_op_count);
+
+    // 0 OP_IF OP_NOP x199 OP_ENDIF 1 (201 counted ops, none executed).
+    prevout.erase(prevout.begin() + 2);
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__unexecuted_branch_disabled_opcode__disabled_opcode)
+{
+    // 1 OP_IF 1 OP_ELSE OP_NOP OP_CAT OP_ENDIF
+    const data_chunk prevout{ 0x51, 0x63, 0x51, 0x67, 0x61, 0x7e, 0x68 };
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_disabled_opcode);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__unexecuted_branch_unparseable__bad_opcode)
+{
+    // 0 OP_IF OP_NOP OP_ENDIF 1 OP_PUSHDATA1 (truncated)
+    const data_chunk prevout{ 0x00, 0x63, 0x61, 0x68, 0x51, 0x4c };
+    BOOST_REQUIRE_EQUAL(test_verify_unsigned_data({}, prevout, verify_flags_none), verify_result_bad_opcode);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__repeated_witness_script__true)
+{
+    // P2WSH of (OP_DROP x3 1), with a 3-element witness, verified repeatedly.
+    const data_chunk script{ 0x75, 0x75, 0x75, 0x51 };
+    data_chunk prevout;
+    BOOST_REQUIRE(decode_base16(prevout, "00206b4f6cd415fcf1a1edb90a4d422c80b458421cd1c2bb4c9b3923735733f486ef"));
+    const stack witness{ { 0x01 }, data_chunk(520, 0x01), {}, script };
+    for (auto count = 0; count < 3; ++count)
+    {
+        BOOST_REQUIRE_EQUAL(verify_unsigned_script({ prevout, 0 }, {}, witness, verify_flags_p2sh | verify_flags_witness), verify_result_eval_true);
+    }
+}
+
+#define CONSENSUS_SCRIPT_VERIFY_300_BYTES \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101" \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101" \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101" \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101" \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101" \
+    "0101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101"
+
+// Two unsigned inputs, only the second having a witness: a 300 byte element
+// and the witness script (OP_DROP 1).
+#define CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX \
+    "01000000" "0001" "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "00" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "00" \
+    "02" "fd2c01" CONSENSUS_SCRIPT_VERIFY_300_BYTES "027551" \
+    "00000000"
+#define CONSENSUS_SCRIPT_VERIFY_DROP_TRUE_P2WSH \
+    "002033198a9bfef674ebddb9ffaa52928017b8472791e54c609cb95f278ac6b1e349"
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__second_input_witness__true)
+{
+    const auto flags = verify_flags_p2sh | verify_flags_witness;
+    const auto result = test_verify(CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_DROP_TRUE_P2WSH, 0, 1, flags);
+    BOOST_REQUIRE_EQUAL(result, verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__first_input_without_witness__witness_program_empty_witness)
+{
+    const auto flags = verify_flags_p2sh | verify_flags_witness;
+    const auto result = test_verify(CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_DROP_TRUE_P2WSH, 0, 0, flags);
+    BOOST_REQUIRE_EQUAL(result, verify_result_witness_program_empty_witness);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__truncated_other_witness__tx_invalid)
+{
+    // The first input is verified, but the witness of the second is truncated.
+    std::string transaction = CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX;
+    transaction.erase(transaction.size() - 16);
+    const auto result = test_verify(transaction, "51", 0, 0, verify_flags_p2sh | verify_flags_witness);
+    BOOST_REQUIRE_EQUAL(result, verify_result_tx_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__context__matches_contextless)
+{
+    // A context is reused across transactions of differing shape and failure.
+    struct spend { std::string tx; std::string prevout; uint64_t value; uint32_t index; uint32_t flags; };
+    const spend spends[]
+    {
+        { CONSENSUS_SCRIPT_VERIFY_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_WITNESS_PREVOUT_SCRIPT, 500000, 0, verify_flags_p2sh | verify_flags_witness },
+        { CONSENSUS_SCRIPT_VERIFY_TX, CONSENSUS_SCRIPT_VERIFY_PREVOUT_SCRIPT, 0, 0, verify_flags_p2sh },
+        { "42", "42", 0, 0, verify_flags_p2sh },
+        { CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_DROP_TRUE_P2WSH, 0, 1, verify_flags_p2sh | verify_flags_witness },
+        { CONSENSUS_SCRIPT_VERIFY_TX, CONSENSUS_SCRIPT_VERIFY_PREVOUT_SCRIPT, 0, 1, verify_flags_p2sh },
+        { CONSENSUS_SCRIPT_VERIFY_SECOND_INPUT_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_DROP_TRUE_P2WSH, 0, 0, verify_flags_p2sh | verify_flags_witness },
+        { CONSENSUS_SCRIPT_VERIFY_WITNESS_TX, CONSENSUS_SCRIPT_VERIFY_WITNESS_PREVOUT_SCRIPT, 500000, 0, verify_flags_p2sh | verify_flags_witness }
+    };
+
+    verification_context context;
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        for (const auto& spend: spends)
+        {
+            data_chunk tx, prevout;
+            BOOST_REQUIRE(decode_base16(tx, spend.tx));
+            BOOST_REQUIRE(decode_base16(prevout, spend.prevout));
+            const auto expected = verify_script(tx, { prevout, spend.value }, spend.index, spend.flags);
+            BOOST_REQUIRE_EQUAL(verify_script(context, tx, { prevout, spend.value }, spend.index, spend.flags), expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__script_verify__context_unsigned__matches_contextless)
+{
+    verification_context context;
+    static const stack witness;
+    for (const auto& test: valid_context_free_scripts)
+    {
+        const auto input = mnemonic_to_data(test.input);
+        const auto prevout = mnemonic_to_data(test.output);
+        BOOST_CHECK_MESSAGE(verify_unsigned_script(context, { prevout, 0 }, input, witness, verify_flags_none) == verify_result_eval_true, test.description);
+    }
+
+    for (const auto& test: invalid_context_free_scripts)
+    {
+        const auto input = mnemonic_to_data(test.input);
+        const auto prevout = mnemonic_to_data(test.output);
+        const auto expected = verify_unsigned_script({ prevout, 0 }, input, witness, verify_flags_none);
+        BOOST_CHECK_MESSAGE(verify_unsigned_script(context, { prevout, 0 }, input, witness, verify_flags_none) == expected, test.description);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(script__parse__not_invalid)
 {
     for (const auto& test: not_invalid_parse_scripts)
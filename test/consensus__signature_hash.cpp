@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+// These give us test accesss to unpublished symbols.
+#include "consensus/consensus.hpp"
+#include "script/interpreter.h"
+
+using namespace libbitcoin::consensus;
+
+BOOST_AUTO_TEST_SUITE(consensus__signature_hash)
+
+// First witness tx, one input and two outputs.
+#define CONSENSUS_SIGNATURE_HASH_WITNESS_TX \
+    "010000000001015836964079411659db5a4cfddd70e3f0de0261268f86c998a69a143f47c6c83800000000171600149445e8b825f1a17d5e091948545c90654096db68ffffffff02d8be04000000000017a91422c17a06117b40516f9826804800003562e834c98700000000000000004d6a4b424950313431205c6f2f2048656c6c6f20536567576974203a2d29206b656570206974207374726f6e6721204c4c415020426974636f696e20747769747465722e636f6d2f6b6873396e6502483045022100aaa281e0611ba0b5a2cd055f77e5594709d611ad1233e7096394f64ffe16f5b202207e2dcc9ef3a54c24471799ab99f6615847b21be2a6b4e0285918fd025597c5740121021ec0613f21c4e81c4b300426e5e5d30fa651f41e9993223adbe74dbe603c74fb00000000"
+
+// Two inputs and one output, so that the second input has no SIGHASH_SINGLE output.
+#define CONSENSUS_SIGNATURE_HASH_TX \
+    "01000000" \
+    "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "025151" "feffffff" \
+    "01" \
+    "1027000000000000" "0151" \
+    "00000000"
+
+// The same with witnesses for the first input only.
+#define CONSENSUS_SIGNATURE_HASH_TX_WITNESS \
+    "01000000" \
+    "0001" \
+    "02" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "2222222222222222222222222222222222222222222222222222222222222222" "01000000" "025151" "feffffff" \
+    "01" \
+    "1027000000000000" "0151" \
+    "02" "01aa" "00" \
+    "00" \
+    "64000000"
+
+static const int hash_types[]
+{
+    0,
+    SIGHASH_ALL,
+    SIGHASH_NONE,
+    SIGHASH_SINGLE,
+    4,
+    SIGHASH_ALL | SIGHASH_ANYONECANPAY,
+    SIGHASH_NONE | SIGHASH_ANYONECANPAY,
+    SIGHASH_SINGLE | SIGHASH_ANYONECANPAY
+};
+
+// test helper
+static bool parses(const data_chunk& transaction, bool view)
+{
+    uint256 hash;
+    return signature_hash(hash, transaction, 0, {}, 0, SIGHASH_ALL,
+        SigVersion::BASE, view);
+}
+
+// test helper
+static void test_hashes(const data_chunk& transaction, uint32_t inputs)
+{
+    const auto code = mnemonic_to_data("dup hash160 [c564c740c6900b93afc9f1bdaef0a9d466adf6ee] equalverify codeseparator checksig");
+
+    for (uint32_t index = 0; index < inputs; ++index)
+    {
+        for (const auto sigversion: { SigVersion::BASE, SigVersion::WITNESS_V0 })
+        {
+            for (const auto hash_type: hash_types)
+            {
+                uint256 expected, hash;
+                BOOST_REQUIRE(signature_hash(expected, transaction, index, code, 42, hash_type, sigversion, false));
+                BOOST_REQUIRE(signature_hash(hash, transaction, index, code, 42, hash_type, sigversion, true));
+                BOOST_CHECK_MESSAGE(hash == expected, "index: " << index << " hash type: " << hash_type);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__signature_hash__view__matches_transaction)
+{
+    test_hashes(decode(CONSENSUS_SIGNATURE_HASH_TX), 2);
+    test_hashes(decode(CONSENSUS_SIGNATURE_HASH_TX_WITNESS), 2);
+    test_hashes(decode(CONSENSUS_SIGNATURE_HASH_WITNESS_TX), 1);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__signature_hash__input_out_of_range__false)
+{
+    uint256 hash;
+    const auto tx = decode(CONSENSUS_SIGNATURE_HASH_TX);
+    BOOST_REQUIRE(!signature_hash(hash, tx, 2, {}, 0, SIGHASH_ALL, SigVersion::BASE, true));
+    BOOST_REQUIRE(!signature_hash(hash, tx, 2, {}, 0, SIGHASH_ALL, SigVersion::BASE, false));
+}
+
+BOOST_AUTO_TEST_CASE(consensus__signature_hash__truncated__parses_as_transaction)
+{
+    const auto tx = decode(CONSENSUS_SIGNATURE_HASH_WITNESS_TX);
+
+    for (size_t size = 0; size <= tx.size(); ++size)
+    {
+        const data_chunk prefix(tx.begin(), tx.begin() + size);
+        BOOST_CHECK_MESSAGE(parses(prefix, true) == parses(prefix, false), "size: " << size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__signature_hash__malformed__parses_as_transaction)
+{
+    static const std::string malformed[]
+    {
+        // Non-canonical input count.
+        "01000000" "fd0100" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" "00" "00000000",
+
+        // Superfluous witness record.
+        "01000000" "0001" "01" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" "00" "00" "00000000",
+
+        // Unknown optional data.
+        "01000000" "0002" "01" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" "00" "00000000",
+
+        // Script size exceeding MAX_SIZE.
+        "01000000" "01" "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "fe01000002" "ffffffff" "00" "00000000"
+    };
+
+    for (const auto& hex: malformed)
+    {
+        const auto tx = decode(hex);
+        BOOST_CHECK_MESSAGE(parses(tx, true) == parses(tx, false), hex);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
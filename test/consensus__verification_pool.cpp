@@ -0,0 +1,294 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__verification_pool)
+
+using namespace libbitcoin::consensus;
+
+// Test case derived from:
+// github.com/libbitcoin/libbitcoin-explorer/wiki/How-to-Spend-Bitcoin
+#define CONSENSUS_VERIFICATION_POOL_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+#define CONSENSUS_VERIFICATION_POOL_WRONG_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac"
+
+static const uint32_t flags = verify_flags_p2sh;
+
+// test helper
+static transaction_reference reference(const data_chunk& transaction,
+    const output_reference& prevout)
+{
+    return { transaction.data(), transaction.size(), &prevout, 1 };
+}
+
+// verification_pool
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__construct_threads__expected)
+{
+    verification_pool pool({ 3, {}, false });
+    BOOST_REQUIRE_EQUAL(pool.threads(), 3u);
+    BOOST_REQUIRE_EQUAL(pool.statistics().size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__construct_default__not_empty)
+{
+    verification_pool pool;
+    BOOST_REQUIRE(pool.threads() > 0u);
+    BOOST_REQUIRE(default_pool().threads() > 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__construct_processors__expected)
+{
+    verification_pool pool({ 2, { 0 }, false });
+    BOOST_REQUIRE_EQUAL(pool.threads(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__construct_numa__not_empty)
+{
+    verification_pool pool({ 0, {}, false, true, false });
+    BOOST_REQUIRE(pool.threads() > 0u);
+}
+
+// verify_transaction (pool)
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transaction_valid__true)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto script = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    BOOST_REQUIRE_EQUAL(verify_transaction(pool, reference(tx, prevout), flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transaction_missing_prevout__tx_input_invalid)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const transaction_reference transaction{ tx.data(), tx.size(), nullptr, 0 };
+    BOOST_REQUIRE_EQUAL(verify_transaction(pool, transaction, flags), verify_result_tx_input_invalid);
+}
+
+// verify_transactions (pool)
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_empty__true)
+{
+    verification_pool pool({ 2, {}, false });
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, nullptr, nullptr, 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_failures__first_failure)
+{
+    verification_pool pool({ 4, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    auto truncated = tx;
+    truncated.pop_back();
+    const auto valid = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_VERIFICATION_POOL_WRONG_PREVOUT_SCRIPT);
+    const output_reference valid_prevout{ valid.data(), valid.size(), 0 };
+    const output_reference invalid_prevout{ invalid.data(), invalid.size(), 0 };
+
+    std::vector<transaction_reference> transactions(64, reference(tx, valid_prevout));
+    transactions[5] = reference(truncated, valid_prevout);
+    transactions[17] = reference(tx, invalid_prevout);
+    std::vector<verify_result> results(transactions.size());
+
+    // The pool is reused across batches.
+    for (size_t batch = 0; batch < 3; ++batch)
+    {
+        BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags), verify_result_tx_invalid);
+        BOOST_REQUIRE_EQUAL(results[0], verify_result_eval_true);
+        BOOST_REQUIRE_EQUAL(results[5], verify_result_tx_invalid);
+        BOOST_REQUIRE_EQUAL(results[17], verify_result_equalverify);
+        BOOST_REQUIRE_EQUAL(results[63], verify_result_eval_true);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_in_order__first_failure)
+{
+    verification_pool pool({ 3, {}, true });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto valid = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_VERIFICATION_POOL_WRONG_PREVOUT_SCRIPT);
+    const output_reference valid_prevout{ valid.data(), valid.size(), 0 };
+    const output_reference invalid_prevout{ invalid.data(), invalid.size(), 0 };
+
+    std::vector<transaction_reference> transactions(16, reference(tx, valid_prevout));
+    transactions[9] = reference(tx, invalid_prevout);
+    std::vector<verify_result> results(transactions.size());
+
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags), verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[8], verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(results[9], verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[10], verify_result_eval_true);
+}
+
+// verify_transactions (cancellation)
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_cancelled__cancelled)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto script = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    const std::vector<transaction_reference> transactions(16, reference(tx, prevout));
+    std::vector<verify_result> results(transactions.size());
+
+    cancellation token;
+    token.cancel();
+    const batch_settings settings{ &token, false, true, verify_lane_block };
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags, settings), verify_result_cancelled);
+    for (const auto result: results)
+        BOOST_REQUIRE_EQUAL(result, verify_result_cancelled);
+
+    token.reset();
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags, settings), verify_result_eval_true);
+    for (const auto result: results)
+        BOOST_REQUIRE_EQUAL(result, verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_fail_fast__failure)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto valid = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_VERIFICATION_POOL_WRONG_PREVOUT_SCRIPT);
+    const output_reference valid_prevout{ valid.data(), valid.size(), 0 };
+    const output_reference invalid_prevout{ invalid.data(), invalid.size(), 0 };
+
+    std::vector<transaction_reference> transactions(64, reference(tx, valid_prevout));
+    transactions[40] = reference(tx, invalid_prevout);
+    std::vector<verify_result> results(transactions.size());
+
+    cancellation token;
+    const batch_settings settings{ &token, true, false, verify_lane_mempool };
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags, settings), verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[40], verify_result_equalverify);
+    BOOST_REQUIRE(token.cancelled());
+
+    // Others either completed or were stopped.
+    for (const auto result: results)
+        BOOST_REQUIRE(result == verify_result_eval_true || result == verify_result_cancelled || result == verify_result_equalverify);
+}
+
+// verify_transactions (lanes)
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_mempool_lane__lane_statistics)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto script = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    const std::vector<transaction_reference> transactions(8, reference(tx, prevout));
+    std::vector<verify_result> results(transactions.size());
+
+    const batch_settings settings{ nullptr, false, false, verify_lane_mempool };
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags, settings), verify_result_eval_true);
+
+    // A parse and an input verification task for each transaction.
+    const auto mempool = pool.statistics(verify_lane_mempool);
+    BOOST_REQUIRE_EQUAL(mempool.batches, 2u);
+    BOOST_REQUIRE_EQUAL(mempool.tasks, 16u);
+    BOOST_REQUIRE_EQUAL(mempool.queued, 0u);
+    BOOST_REQUIRE(mempool.max_latency_nanoseconds <= mempool.latency_nanoseconds);
+
+    const auto block = pool.statistics(verify_lane_block);
+    BOOST_REQUIRE_EQUAL(block.batches, 0u);
+    BOOST_REQUIRE_EQUAL(block.tasks, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_concurrent_lanes__true)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto script = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    const std::vector<transaction_reference> transactions(64, reference(tx, prevout));
+    std::vector<verify_result> mempool_results(transactions.size());
+    std::vector<verify_result> block_results(transactions.size());
+    verify_result mempool_result;
+
+    std::thread mempool([&]()
+    {
+        mempool_result = verify_transactions(pool, mempool_results.data(), transactions.data(), transactions.size(), flags, { nullptr, false, false, verify_lane_mempool });
+    });
+
+    const auto block_result = verify_transactions(pool, block_results.data(), transactions.data(), transactions.size(), flags, { nullptr, false, false, verify_lane_block });
+    mempool.join();
+
+    BOOST_REQUIRE_EQUAL(block_result, verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(mempool_result, verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(pool.statistics(verify_lane_block).batches, 2u);
+    BOOST_REQUIRE_EQUAL(pool.statistics(verify_lane_mempool).batches, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__verify_transactions_numa_spin__first_failure)
+{
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto valid = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_VERIFICATION_POOL_WRONG_PREVOUT_SCRIPT);
+    const output_reference valid_prevout{ valid.data(), valid.size(), 0 };
+    const output_reference invalid_prevout{ invalid.data(), invalid.size(), 0 };
+    std::vector<transaction_reference> transactions(16, reference(tx, valid_prevout));
+    transactions[9] = reference(tx, invalid_prevout);
+
+    for (const auto numa: { false, true })
+    {
+        verification_pool pool({ 2, {}, false, numa, true });
+        std::vector<verify_result> results(transactions.size());
+        BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags), verify_result_equalverify);
+        BOOST_REQUIRE_EQUAL(results[0], verify_result_eval_true);
+        BOOST_REQUIRE_EQUAL(results[9], verify_result_equalverify);
+        BOOST_REQUIRE_EQUAL(results[15], verify_result_eval_true);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verification_pool__statistics__tasks_run)
+{
+    verification_pool pool({ 2, {}, false });
+    const auto tx = decode(CONSENSUS_VERIFICATION_POOL_TX);
+    const auto script = decode(CONSENSUS_VERIFICATION_POOL_PREVOUT_SCRIPT);
+    const output_reference prevout{ script.data(), script.size(), 0 };
+    const std::vector<transaction_reference> transactions(32, reference(tx, prevout));
+    std::vector<verify_result> results(transactions.size());
+    BOOST_REQUIRE_EQUAL(verify_transactions(pool, results.data(), transactions.data(), transactions.size(), flags), verify_result_eval_true);
+
+    // Each of the 64 tasks (32 parses and 32 inputs) runs on a worker or the
+    // submitting thread.
+    uint64_t tasks = 0;
+    for (const auto& worker: pool.statistics())
+    {
+        BOOST_REQUIRE(worker.steals <= worker.tasks);
+        tasks += worker.tasks;
+    }
+
+    BOOST_REQUIRE(tasks <= 64u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
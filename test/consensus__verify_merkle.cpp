@@ -0,0 +1,304 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "crypto/sha256.h"
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__verify_merkle)
+
+using namespace libbitcoin::consensus;
+
+// The genesis block coinbase, its txid is the genesis merkle root.
+#define CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE \
+    "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff4d04ffff001d0104455468652054696d65732030332f4a616e2f32303039204368616e63656c6c6f72206f6e206272696e6b206f66207365636f6e64206261696c6f757420666f722062616e6b73ffffffff0100f2052a01000000434104678afdb0fe5548271967f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec112de5c384df7ba0b8d578a4c702b6bf11d5fac00000000"
+
+// A header with the given merkle root (in internal byte order).
+#define CONSENSUS_VERIFY_MERKLE_HEADER(root) \
+    "01000000" \
+    "0000000000000000000000000000000000000000000000000000000000000000" \
+    root \
+    "29ab5f49" "ffff001d" "1dac2b7c"
+
+#define CONSENSUS_VERIFY_MERKLE_GENESIS \
+    CONSENSUS_VERIFY_MERKLE_HEADER("3ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a") \
+    "01" CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE
+
+// A coinbase with a witness reserved value (zero) and a witness commitment.
+#define CONSENSUS_VERIFY_MERKLE_WITNESS_COINBASE \
+    "01000000" "0001" "01" \
+    "0000000000000000000000000000000000000000000000000000000000000000" "ffffffff" "03510151" "ffffffff" \
+    "02" \
+    "00f2052a01000000" "0151" \
+    "0000000000000000" "26" "6a24aa21a9ed" "c2dc0c98224a5f267dfd06cbd77c71734f36ab5df4c54e486530238d8f0f0b3e" \
+    "01" "20" "0000000000000000000000000000000000000000000000000000000000000000" \
+    "00000000"
+
+#define CONSENSUS_VERIFY_MERKLE_WITNESS_TX \
+    "02000000" "0001" "01" \
+    "1111111111111111111111111111111111111111111111111111111111111111" "00000000" "00" "ffffffff" \
+    "01" "1027000000000000" "0151" \
+    "02" "0101" "027551" \
+    "00000000"
+
+#define CONSENSUS_VERIFY_MERKLE_WITNESS_TX_WTXID \
+    "202d6a57cbbc32fd57b5149b9316d6899db47a82af4a3f06e4de845e494404a8"
+
+#define CONSENSUS_VERIFY_MERKLE_WITNESS_BLOCK \
+    CONSENSUS_VERIFY_MERKLE_HEADER("93c71f174d983855adf74eb12c802b49b08034286ffbddc5b8c7206ae6843ad7") \
+    "02" CONSENSUS_VERIFY_MERKLE_WITNESS_COINBASE CONSENSUS_VERIFY_MERKLE_WITNESS_TX
+
+#define CONSENSUS_VERIFY_MERKLE_TX_A \
+    "010000000111111111111111111111111111111111111111111111111111111111111111110000000000ffffffff011027000000000000015100000000"
+
+#define CONSENSUS_VERIFY_MERKLE_TX_B \
+    "010000000122222222222222222222222222222222222222222222222222222222222222220000000000ffffffff011027000000000000015100000000"
+
+// The root of [coinbase, a, b], which is also that of [coinbase, a, b, b].
+#define CONSENSUS_VERIFY_MERKLE_MUTABLE_ROOT \
+    "e051db3e42fccd765c8233604b3647370ccd024d3ea4d0e131da1e0e43a6d0dc"
+
+// test helper
+static hash_digest decode_hash(const std::string& hex)
+{
+    hash_digest out;
+    const auto data = decode(hex);
+    BOOST_REQUIRE_EQUAL(data.size(), out.size());
+    std::copy(data.begin(), data.end(), out.begin());
+    return out;
+}
+
+// test helper
+static hash_list repeated_hashes(size_t count)
+{
+    hash_list out(count);
+    for (size_t index = 0; index < count; ++index)
+        out[index].fill(static_cast<uint8_t>(index + 1));
+
+    return out;
+}
+
+// test helper
+static data_chunk sha256d(const uint8_t* data, size_t size)
+{
+    data_chunk once(CSHA256::OUTPUT_SIZE);
+    data_chunk twice(CSHA256::OUTPUT_SIZE);
+    CSHA256().Write(data, size).Finalize(once.data());
+    CSHA256().Write(once.data(), once.size()).Finalize(twice.data());
+    return twice;
+}
+
+// SHA256D64 (the multi-way transform of merkle levels)
+
+BOOST_AUTO_TEST_CASE(consensus__sha256d64__multi_way__one_way_equivalent)
+{
+    // Seventeen blocks pass through each of the 8, 4, 2 and 1-way transforms
+    // that are selected, as detected by the library at load.
+    constexpr size_t blocks = 17;
+    data_chunk in(blocks * 64);
+    for (size_t index = 0; index < in.size(); ++index)
+        in[index] = static_cast<uint8_t>(index * 131 + (index / 64) * 17 + 3);
+
+    for (size_t count = 0; count <= blocks; ++count)
+    {
+        data_chunk out(count * 32);
+        SHA256D64(out.data(), in.data(), count);
+
+        for (size_t block = 0; block < count; ++block)
+        {
+            const auto expected = sha256d(&in[block * 64], 64);
+            BOOST_REQUIRE(std::equal(expected.begin(), expected.end(), out.begin() + block * 32));
+        }
+    }
+
+    data_chunk last(32);
+    SHA256D64(last.data(), &in[(blocks - 1) * 64], 1);
+    BOOST_REQUIRE(last == decode("5ca21549588d372d2e228bec2450e86a55ca47a11a18017ca0347c0495104c57"));
+}
+
+// merkle_root
+
+BOOST_AUTO_TEST_CASE(consensus__merkle_root__empty__false)
+{
+    hash_digest root;
+    bool mutated;
+    BOOST_REQUIRE(!merkle_root(root, mutated, {}));
+}
+
+BOOST_AUTO_TEST_CASE(consensus__merkle_root__single__hash)
+{
+    hash_digest root;
+    bool mutated = true;
+    const auto hashes = repeated_hashes(1);
+    BOOST_REQUIRE(merkle_root(root, mutated, hashes));
+    BOOST_REQUIRE(root == hashes.front());
+    BOOST_REQUIRE(!mutated);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__merkle_root__five__expected)
+{
+    hash_digest root;
+    bool mutated = true;
+    BOOST_REQUIRE(merkle_root(root, mutated, repeated_hashes(5)));
+    BOOST_REQUIRE(root == decode_hash("26e2870f72368b3f8baef83fa26282d95d9c194e1f33d90a12932e0f6022e5d3"));
+    BOOST_REQUIRE(!mutated);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__merkle_root__eleven__expected)
+{
+    // Exceeds the widest (eight way) transform, with odd levels.
+    hash_digest root;
+    bool mutated = true;
+    BOOST_REQUIRE(merkle_root(root, mutated, repeated_hashes(11)));
+    BOOST_REQUIRE(root == decode_hash("00118133e5f9cf9c0da5443ad80ed3c69ec37cead6a6f7926c7452e1278ba554"));
+    BOOST_REQUIRE(!mutated);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__merkle_root__duplicated_last__mutated)
+{
+    hash_digest odd;
+    hash_digest even;
+    bool mutated = true;
+    auto hashes = repeated_hashes(3);
+    BOOST_REQUIRE(merkle_root(odd, mutated, hashes));
+    BOOST_REQUIRE(!mutated);
+
+    hashes.push_back(hashes.back());
+    BOOST_REQUIRE(merkle_root(even, mutated, hashes));
+    BOOST_REQUIRE(mutated);
+    BOOST_REQUIRE(odd == even);
+}
+
+// verify_witness_commitment
+
+BOOST_AUTO_TEST_CASE(consensus__verify_witness_commitment__valid__true)
+{
+    const auto coinbase = decode(CONSENSUS_VERIFY_MERKLE_WITNESS_COINBASE);
+    const hash_list wtxids{ {}, decode_hash(CONSENSUS_VERIFY_MERKLE_WITNESS_TX_WTXID) };
+    BOOST_REQUIRE_EQUAL(verify_witness_commitment(coinbase, wtxids), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_witness_commitment__coinbase_wtxid_ignored__true)
+{
+    const auto coinbase = decode(CONSENSUS_VERIFY_MERKLE_WITNESS_COINBASE);
+    hash_list wtxids{ {}, decode_hash(CONSENSUS_VERIFY_MERKLE_WITNESS_TX_WTXID) };
+    wtxids.front().fill(0x42);
+    BOOST_REQUIRE_EQUAL(verify_witness_commitment(coinbase, wtxids), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_witness_commitment__wrong_wtxid__block_witness_mismatch)
+{
+    const auto coinbase = decode(CONSENSUS_VERIFY_MERKLE_WITNESS_COINBASE);
+    const hash_list wtxids{ {}, repeated_hashes(1).front() };
+    BOOST_REQUIRE_EQUAL(verify_witness_commitment(coinbase, wtxids), verify_result_block_witness_mismatch);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_witness_commitment__no_reserved_value__block_witness_nonce_size)
+{
+    // The coinbase without its witness.
+    const auto coinbase = decode("01000000" "01"
+        "0000000000000000000000000000000000000000000000000000000000000000" "ffffffff" "03510151" "ffffffff"
+        "02"
+        "00f2052a01000000" "0151"
+        "0000000000000000" "26" "6a24aa21a9ed" "c2dc0c98224a5f267dfd06cbd77c71734f36ab5df4c54e486530238d8f0f0b3e"
+        "00000000");
+
+    const hash_list wtxids{ {}, decode_hash(CONSENSUS_VERIFY_MERKLE_WITNESS_TX_WTXID) };
+    BOOST_REQUIRE_EQUAL(verify_witness_commitment(coinbase, wtxids), verify_result_block_witness_nonce_size);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_witness_commitment__no_commitment__block_witness_uncommitted)
+{
+    const auto coinbase = decode(CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE);
+    BOOST_REQUIRE_EQUAL(verify_witness_commitment(coinbase, { {} }), verify_result_block_witness_uncommitted);
+}
+
+// verify_merkle
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__genesis__true)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_GENESIS);
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_witness), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__wrong_root__block_merkle_mismatch)
+{
+    auto block = decode(CONSENSUS_VERIFY_MERKLE_GENESIS);
+    block[36] ^= 0x01;
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_block_merkle_mismatch);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__duplicated_transaction__block_merkle_mutated)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_HEADER(CONSENSUS_VERIFY_MERKLE_MUTABLE_ROOT) "04"
+        CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE
+        CONSENSUS_VERIFY_MERKLE_TX_A
+        CONSENSUS_VERIFY_MERKLE_TX_B
+        CONSENSUS_VERIFY_MERKLE_TX_B);
+
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_block_merkle_mutated);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__unduplicated_transaction__true)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_HEADER(CONSENSUS_VERIFY_MERKLE_MUTABLE_ROOT) "03"
+        CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE
+        CONSENSUS_VERIFY_MERKLE_TX_A
+        CONSENSUS_VERIFY_MERKLE_TX_B);
+
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__witness_commitment__true)
+{
+    verification_context context;
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_WITNESS_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_merkle(context, block, verify_flags_witness), verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(verify_merkle(context, block, verify_flags_witness), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__witness_without_flag__block_witness_unexpected)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_WITNESS_BLOCK);
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_block_witness_unexpected);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__witness_uncommitted__block_witness_unexpected)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_HEADER("109ec0ce661a2063d0f621f467b50e3f0fd7e34e0ca5f2614310fcc0d4284d5f") "02"
+        CONSENSUS_VERIFY_MERKLE_GENESIS_COINBASE
+        CONSENSUS_VERIFY_MERKLE_WITNESS_TX);
+
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_witness), verify_result_block_witness_unexpected);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_merkle__no_transactions__block_invalid)
+{
+    const auto block = decode(CONSENSUS_VERIFY_MERKLE_HEADER("3ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a") "00");
+    BOOST_REQUIRE_EQUAL(verify_merkle(block, verify_flags_none), verify_result_block_invalid);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+#include <boost/test/unit_test.hpp>
+#include "script.hpp"
+#include "test.hpp"
+
+BOOST_AUTO_TEST_SUITE(consensus__verify_transaction)
+
+using namespace libbitcoin::consensus;
+
+// Test case derived from:
+// github.com/libbitcoin/libbitcoin-explorer/wiki/How-to-Spend-Bitcoin
+#define CONSENSUS_VERIFY_TRANSACTION_TX \
+    "01000000017d01943c40b7f3d8a00a2d62fa1d560bf739a2368c180615b0a7937c0e883e7c000000006b4830450221008f66d188c664a8088893ea4ddd9689024ea5593877753ecc1e9051ed58c15168022037109f0d06e6068b7447966f751de8474641ad2b15ec37f4a9d159b02af68174012103e208f5403383c77d5832a268c9f71480f6e7bfbdfa44904becacfad66163ea31ffffffff01c8af0000000000001976a91458b7a60f11a904feef35a639b6048de8dd4d9f1c88ac00000000"
+#define CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ee88ac"
+#define CONSENSUS_VERIFY_TRANSACTION_WRONG_PREVOUT_SCRIPT \
+    "76a914c564c740c6900b93afc9f1bdaef0a9d466adf6ef88ac"
+
+static const uint32_t flags = verify_flags_p2sh;
+
+// test helper
+static output_reference reference(const data_chunk& script, uint64_t value=0)
+{
+    return { script.data(), script.size(), value };
+}
+
+// test helper
+static transaction_reference reference(const data_chunk& transaction,
+    const output_reference& prevout)
+{
+    return { transaction.data(), transaction.size(), &prevout, 1 };
+}
+
+// verify_script (referenced)
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__verify_script_referenced__true)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    BOOST_REQUIRE_EQUAL(verify_script(tx.data(), tx.size(), reference(script), 0, flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__verify_script_referenced_context__equalverify)
+{
+    verification_context context;
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_WRONG_PREVOUT_SCRIPT);
+    BOOST_REQUIRE_EQUAL(verify_script(context, tx.data(), tx.size(), reference(script), 0, flags), verify_result_equalverify);
+}
+
+// verify_transaction
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__valid__true)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    const auto prevout = reference(script);
+    BOOST_REQUIRE_EQUAL(verify_transaction(reference(tx, prevout), flags), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__incorrect_pubkey_hash__equalverify)
+{
+    verification_context context;
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_WRONG_PREVOUT_SCRIPT);
+    const auto prevout = reference(script);
+    BOOST_REQUIRE_EQUAL(verify_transaction(context, reference(tx, prevout), flags), verify_result_equalverify);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__missing_prevout__tx_input_invalid)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const transaction_reference transaction{ tx.data(), tx.size(), nullptr, 0 };
+    BOOST_REQUIRE_EQUAL(verify_transaction(transaction, flags), verify_result_tx_input_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__trailing_byte__tx_size_invalid)
+{
+    auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    tx.push_back(0x42);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    const auto prevout = reference(script);
+    BOOST_REQUIRE_EQUAL(verify_transaction(reference(tx, prevout), flags), verify_result_tx_size_invalid);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__value_overflow__value_overflow)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    const auto prevout = reference(script, 0xffffffffffffffff);
+    BOOST_REQUIRE_EQUAL(verify_transaction(reference(tx, prevout), flags), verify_value_overflow);
+}
+
+// verify_transactions
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__verify_transactions_empty__true)
+{
+    BOOST_REQUIRE_EQUAL(verify_transactions(nullptr, nullptr, 0, flags, 0), verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__verify_transactions_valid__true)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto script = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    const auto prevout = reference(script);
+    const std::vector<transaction_reference> transactions(17, reference(tx, prevout));
+    std::vector<verify_result> results(transactions.size(), verify_result_eval_false);
+
+    for (const size_t threads: { 0, 1, 4 })
+    {
+        BOOST_REQUIRE_EQUAL(verify_transactions(results.data(), transactions.data(), transactions.size(), flags, threads), verify_result_eval_true);
+        for (const auto result: results)
+            BOOST_REQUIRE_EQUAL(result, verify_result_eval_true);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensus__verify_transaction__verify_transactions_failures__first_failure)
+{
+    const auto tx = decode(CONSENSUS_VERIFY_TRANSACTION_TX);
+    const auto valid = decode(CONSENSUS_VERIFY_TRANSACTION_PREVOUT_SCRIPT);
+    const auto invalid = decode(CONSENSUS_VERIFY_TRANSACTION_WRONG_PREVOUT_SCRIPT);
+    const auto valid_prevout = reference(valid);
+    const auto invalid_prevout = reference(invalid);
+    const auto overflow_prevout = reference(valid, 0xffffffffffffffff);
+
+    std::vector<transaction_reference> transactions(8, reference(tx, valid_prevout));
+    transactions[3] = reference(tx, invalid_prevout);
+    transactions[6] = reference(tx, overflow_prevout);
+    std::vector<verify_result> results(transactions.size());
+
+    BOOST_REQUIRE_EQUAL(verify_transactions(results.data(), transactions.data(), transactions.size(), flags, 3), verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[0], verify_result_eval_true);
+    BOOST_REQUIRE_EQUAL(results[3], verify_result_equalverify);
+    BOOST_REQUIRE_EQUAL(results[6], verify_value_overflow);
+    BOOST_REQUIRE_EQUAL(results[7], verify_result_eval_true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
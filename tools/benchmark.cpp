@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Times the evaluation of opcode-dense scripts by each interpreter engine:
+//
+//   switch       EvalScript, which dispatches each instruction in a switch.
+//   threaded     EvalScriptThreaded with flags outside of the specialized
+//                sets, so that its handlers read the flags at runtime.
+//   specialized  EvalScriptThreaded with the standardness policy flags, for
+//                which its handlers are specialized.
+//
+// The two flag sets differ only by SCRIPT_VERIFY_CONST_SCRIPTCODE, which does
+// not affect scripts without OP_CODESEPARATOR, so each engine evaluates the
+// same operations. Scripts are decoded once, and each evaluation starts from
+// an empty stack. The reported time is the median over the repetitions.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The interpreter is not published, so the benchmark uses its headers.
+#include "script/decoded.h"
+#include "script/interpreter.h"
+#include "script/script.h"
+#include "script/stack.h"
+
+static constexpr unsigned int policy_flags =
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_DERSIG |
+    SCRIPT_VERIFY_LOW_S | SCRIPT_VERIFY_NULLDUMMY |
+    SCRIPT_VERIFY_MINIMALDATA | SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_NOPS |
+    SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY | SCRIPT_VERIFY_CHECKSEQUENCEVERIFY |
+    SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_MINIMALIF |
+    SCRIPT_VERIFY_NULLFAIL | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE;
+
+static constexpr unsigned int runtime_flags =
+    policy_flags | SCRIPT_VERIFY_CONST_SCRIPTCODE;
+
+struct benchmark_script
+{
+    std::string name;
+    CScript script;
+};
+
+// Each script has the most (201) counted operations that a script admits.
+static std::vector<benchmark_script> scripts()
+{
+    std::vector<benchmark_script> out;
+
+    CScript arithmetic;
+    arithmetic << OP_1;
+    for (auto count = 0; count < 100; ++count)
+        arithmetic << OP_1ADD << OP_1SUB;
+    arithmetic << OP_0NOTEQUAL;
+    out.push_back({ "arithmetic", arithmetic });
+
+    CScript stack;
+    stack << OP_1 << OP_2 << OP_3;
+    for (auto count = 0; count < 50; ++count)
+        stack << OP_ROT << OP_SWAP << OP_OVER << OP_DROP;
+    stack << OP_DEPTH;
+    out.push_back({ "stack", stack });
+
+    CScript conditional;
+    conditional << OP_1;
+    for (auto count = 0; count < 50; ++count)
+        conditional << OP_DUP << OP_IF << OP_ELSE << OP_ENDIF;
+    conditional << OP_NOP;
+    out.push_back({ "conditional", conditional });
+
+    CScript hashing;
+    hashing << std::vector<unsigned char>(32, 0x42);
+    for (auto count = 0; count < 201; ++count)
+        hashing << OP_SHA256;
+    out.push_back({ "hashing", hashing });
+
+    return out;
+}
+
+enum class engine
+{
+    switched,
+    threaded,
+    specialized
+};
+
+// The median nanoseconds per evaluation of the script.
+static double time_engine(const CScript& script, engine kind, size_t iterations,
+    size_t repetitions)
+{
+    using namespace std::chrono;
+    const BaseSignatureChecker checker;
+    const DecodedScript decoded(script);
+    StackArena arena;
+    ScriptStack stack(arena);
+    std::vector<double> samples;
+
+    for (size_t repetition = 0; repetition < repetitions; ++repetition)
+    {
+        const auto start = steady_clock::now();
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+        {
+            ScriptExecutionData execdata;
+            ScriptError error;
+            stack.clear();
+
+            const auto success = kind == engine::switched ?
+                EvalScript(stack, decoded, policy_flags, checker,
+                    SigVersion::BASE, execdata, &error) :
+                EvalScriptThreaded(stack, decoded, kind == engine::threaded ?
+                    runtime_flags : policy_flags, checker, SigVersion::BASE,
+                    execdata, &error);
+
+            if (!success)
+                throw std::runtime_error("script error " +
+                    std::to_string(static_cast<int>(error)));
+        }
+
+        const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() -
+            start).count();
+        samples.push_back(static_cast<double>(elapsed) / iterations);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: libbitcoin-consensus-benchmark [-n iterations] "
+        "[-r repetitions]\n"
+        "Times the evaluation of opcode-dense scripts by each interpreter.\n"
+        "  -n  Evaluations of each script per repetition (default: 20000).\n"
+        "  -r  Repetitions, of which the median is reported (default: 7).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = 20000;
+    size_t repetitions = 7;
+
+    try
+    {
+        for (auto arg = 1; arg < argc; ++arg)
+        {
+            const std::string option(argv[arg]);
+            if ((option != "-n" && option != "-r") || arg + 1 == argc)
+                throw std::invalid_argument(option);
+
+            const auto value = std::max(std::stoul(argv[++arg], nullptr, 0),
+                1ul);
+
+            if (option == "-n")
+                iterations = value;
+            else
+                repetitions = value;
+        }
+    }
+    catch (const std::exception&)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::cout << std::left << std::setw(14) << "script"
+            << std::right << std::setw(12) << "switch"
+            << std::setw(12) << "threaded"
+            << std::setw(14) << "specialized" << "  (ns/script)\n";
+
+        for (const auto& test: scripts())
+        {
+            std::cout << std::left << std::setw(14) << test.name << std::right
+                << std::fixed << std::setprecision(1)
+                << std::setw(12) << time_engine(test.script, engine::switched,
+                    iterations, repetitions)
+                << std::setw(12) << time_engine(test.script, engine::threaded,
+                    iterations, repetitions)
+                << std::setw(14) << time_engine(test.script,
+                    engine::specialized, iterations, repetitions)
+                << "\n";
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << "Evaluation failed: " << exception.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
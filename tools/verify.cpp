@@ -0,0 +1,603 @@
+/**
+ * Copyright (c) 2011-2023 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Re-verifies every input of Bitcoin Core blk*.dat files, each paired with a
+// file of the outputs that its blocks spend, and reports throughput.
+//
+// The spent outputs file is columnar, all integers are little-endian:
+//
+//   magic    4 bytes, "bcso"
+//   version  uint32, 1 or 2
+//   blocks   uint64, the number of blocks in the paired blk file
+//   outputs  uint64, the number of spent outputs
+//   block    (blocks + 1) x uint64, index of the first output of each block
+//   flags    blocks x uint32, the verify_flags of each block (version 2)
+//   value    outputs x uint64, the value of each output
+//   script   (outputs + 1) x uint64, offset of each script within scripts
+//   scripts  the concatenated output scripts
+//
+// Blocks are in the order of their records in the blk file. The outputs of a
+// block are those spent by its non-coinbase inputs, in transaction and input
+// order, as verify_block expects.
+//
+// The flags of a block are those in force at its height, so that blocks
+// before the activation of BIP16, BIP66, BIP65, BIP112 or BIP147 verify as
+// they were accepted. A version 1 file has no flags column, and its blocks are
+// all verified with the -f flags, under which such earlier blocks may fail.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <bitcoin/consensus.hpp>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace libbitcoin::consensus;
+
+// The script verification flags of current consensus.
+static constexpr uint32_t default_flags =
+    verify_flags_p2sh |
+    verify_flags_dersig |
+    verify_flags_nulldummy |
+    verify_flags_checklocktimeverify |
+    verify_flags_checksequenceverify |
+    verify_flags_witness;
+
+static constexpr uint8_t spent_magic[] { 'b', 'c', 's', 'o' };
+static constexpr uint32_t spent_version_unflagged = 1;
+static constexpr uint32_t spent_version = 2;
+static constexpr size_t spent_header_size = 24;
+static constexpr size_t record_header_size = 8;
+
+static uint32_t read_little_endian32(const uint8_t* data)
+{
+    return
+        static_cast<uint32_t>(data[0]) |
+        static_cast<uint32_t>(data[1]) << 8 |
+        static_cast<uint32_t>(data[2]) << 16 |
+        static_cast<uint32_t>(data[3]) << 24;
+}
+
+static uint64_t read_little_endian64(const uint8_t* data)
+{
+    return
+        static_cast<uint64_t>(read_little_endian32(data)) |
+        static_cast<uint64_t>(read_little_endian32(data + 4)) << 32;
+}
+
+// A read-only memory mapping of a file (read into memory where mapping is
+// not implemented).
+class mapped_file
+{
+public:
+    mapped_file(const std::string& path)
+    {
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("cannot open " + path);
+
+        buffer_.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#else
+        const auto descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor == -1)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat status;
+        if (::fstat(descriptor, &status) == -1)
+        {
+            ::close(descriptor);
+            throw std::runtime_error("cannot stat " + path);
+        }
+
+        size_ = static_cast<size_t>(status.st_size);
+        if (size_ != 0)
+        {
+            const auto map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE,
+                descriptor, 0);
+
+            if (map == MAP_FAILED)
+            {
+                ::close(descriptor);
+                throw std::runtime_error("cannot map " + path);
+            }
+
+            // Files are read once, front to back within each block.
+            ::madvise(map, size_, MADV_WILLNEED);
+            data_ = static_cast<const uint8_t*>(map);
+        }
+
+        ::close(descriptor);
+#endif
+    }
+
+    ~mapped_file()
+    {
+#ifndef _WIN32
+        if (data_ != nullptr)
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const uint8_t* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+#ifdef _WIN32
+    std::vector<uint8_t> buffer_;
+#endif
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// A blk file, its blocks and the columns of its spent outputs file.
+class block_file
+{
+public:
+    struct block
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    block_file(const std::string& blocks_path, const std::string& spent_path)
+      : path_(blocks_path), blocks_(blocks_path), spent_(spent_path)
+    {
+        index_blocks();
+        index_spent(spent_path);
+    }
+
+    const std::string& path() const
+    {
+        return path_;
+    }
+
+    const std::vector<block>& blocks() const
+    {
+        return index_;
+    }
+
+    const uint8_t* block_data(size_t block) const
+    {
+        return blocks_.data() + index_[block].offset;
+    }
+
+    // The range of the outputs spent by the block.
+    uint64_t first_output(size_t block) const
+    {
+        return read_little_endian64(block_column_ + block * 8);
+    }
+
+    uint64_t last_output(size_t block) const
+    {
+        return read_little_endian64(block_column_ + block * 8 + 8);
+    }
+
+    // The flags of the block, or the given flags if the file has none.
+    uint32_t flags(size_t block, uint32_t unflagged) const
+    {
+        return flags_column_ == nullptr ? unflagged :
+            read_little_endian32(flags_column_ + block * 4);
+    }
+
+    // Reference an output within the mapped columns.
+    void get_output(output_reference& out, uint64_t index) const
+    {
+        const auto begin = read_little_endian64(script_column_ + index * 8);
+        const auto end = read_little_endian64(script_column_ + index * 8 + 8);
+        out.script = scripts_ + begin;
+        out.script_size = static_cast<size_t>(end - begin);
+        out.value = read_little_endian64(value_column_ + index * 8);
+    }
+
+    // Reference the outputs spent by the block, replacing those of out.
+    void get_outputs(std::vector<output_reference>& out, size_t block) const
+    {
+        out.clear();
+        for (auto output = first_output(block); output < last_output(block);
+            ++output)
+        {
+            out.emplace_back();
+            get_output(out.back(), output);
+        }
+    }
+
+private:
+    // Core preallocates blk files, a zeroed record ends the blocks.
+    void index_blocks()
+    {
+        const auto data = blocks_.data();
+        const auto size = blocks_.size();
+        size_t offset = 0;
+
+        while (size - offset >= record_header_size &&
+            read_little_endian32(data + offset) != 0)
+        {
+            const auto block_size = read_little_endian32(data + offset + 4);
+            offset += record_header_size;
+
+            if (block_size > size - offset)
+                throw std::runtime_error("truncated block in " + path_);
+
+            index_.push_back({ offset, block_size });
+            offset += block_size;
+        }
+    }
+
+    // The columns are validated so that blocks may be read without checks.
+    void index_spent(const std::string& path)
+    {
+        const auto data = spent_.data();
+        const auto size = spent_.size();
+        const auto invalid = std::runtime_error("invalid spent outputs " + path);
+
+        if (size < spent_header_size ||
+            !std::equal(std::begin(spent_magic), std::end(spent_magic), data))
+            throw invalid;
+
+        const auto version = read_little_endian32(data + 4);
+        if (version != spent_version && version != spent_version_unflagged)
+            throw invalid;
+
+        // The block count is that of the blk file, so only outputs is bounded.
+        const auto blocks = read_little_endian64(data + 8);
+        const auto outputs = read_little_endian64(data + 16);
+        const auto columns = static_cast<uint64_t>(size - spent_header_size);
+        const auto flags_size = version == spent_version ? blocks * 4 : 0;
+
+        if (blocks != index_.size() || outputs > columns / 16 ||
+            (blocks + 1) * 8 + flags_size + (outputs * 2 + 1) * 8 > columns)
+            throw invalid;
+
+        block_column_ = data + spent_header_size;
+        flags_column_ = flags_size == 0 ? nullptr :
+            block_column_ + (blocks + 1) * 8;
+        value_column_ = block_column_ + (blocks + 1) * 8 + flags_size;
+        script_column_ = value_column_ + outputs * 8;
+        scripts_ = script_column_ + (outputs + 1) * 8;
+        const auto scripts_size = static_cast<uint64_t>(data + size - scripts_);
+
+        if (!is_partition(block_column_, blocks, outputs) ||
+            !is_partition(script_column_, outputs, scripts_size))
+            throw invalid;
+    }
+
+    // The count + 1 offsets begin at zero, ascend and end at total.
+    static bool is_partition(const uint8_t* column, uint64_t count,
+        uint64_t total)
+    {
+        uint64_t previous = 0;
+        for (uint64_t index = 0; index <= count; ++index)
+        {
+            const auto offset = read_little_endian64(column + index * 8);
+            if ((index == 0 && offset != 0) || offset < previous)
+                return false;
+
+            previous = offset;
+        }
+
+        return previous == total;
+    }
+
+    const std::string path_;
+    const mapped_file blocks_;
+    const mapped_file spent_;
+    std::vector<block> index_;
+    const uint8_t* block_column_ = nullptr;
+    const uint8_t* flags_column_ = nullptr;
+    const uint8_t* value_column_ = nullptr;
+    const uint8_t* script_column_ = nullptr;
+    const uint8_t* scripts_ = nullptr;
+};
+
+// Verifies the blocks in a pipeline, the inputs of each in parallel, in block
+// order or costliest first, and reports the counters of its stages.
+static size_t verify_pipeline(
+    const std::vector<std::unique_ptr<block_file>>& files,
+    const std::vector<std::pair<size_t, size_t>>& jobs, unsigned threads,
+    uint32_t flags, bool in_order, uint64_t& inputs,
+    pipeline_statistics& statistics)
+{
+    std::vector<std::vector<output_reference>> spent(jobs.size());
+    std::atomic<size_t> failures{ 0 };
+
+    // Blocks are submitted in order from a single thread, so that the
+    // sequence of a block is its job.
+    const auto complete = [&](uint64_t sequence, verify_result result)
+    {
+        const auto& job = jobs[sequence];
+        const auto& file = *files[job.first];
+        spent[sequence].clear();
+        spent[sequence].shrink_to_fit();
+
+        if (result != verify_result_eval_true)
+        {
+            ++failures;
+            std::cerr << file.path() << ": block " << job.second << " at "
+                << file.blocks()[job.second].offset << " failed ("
+                << result << ")" << std::endl;
+        }
+    };
+
+    block_pipeline pipeline({ 1, 1, threads, 4, in_order }, complete);
+
+    for (size_t job = 0; job < jobs.size(); ++job)
+    {
+        const auto& file = *files[jobs[job].first];
+        const auto index = jobs[job].second;
+        auto& outputs = spent[job];
+        file.get_outputs(outputs, index);
+
+        inputs += outputs.size();
+        pipeline.submit({ file.block_data(index), file.blocks()[index].size,
+            outputs.data(), outputs.size() }, file.flags(index, flags));
+    }
+
+    pipeline.drain();
+
+    statistics = pipeline.statistics();
+    const auto report = [](const char* name, const stage_statistics& stage)
+    {
+        const auto seconds = [](uint64_t nanoseconds)
+        {
+            return static_cast<double>(nanoseconds) / 1e9;
+        };
+
+        std::cout << name
+            << " blocks " << stage.blocks
+            << ", items " << stage.items
+            << ", busy " << seconds(stage.busy_nanoseconds) << "s"
+            << ", starved " << seconds(stage.starved_nanoseconds) << "s"
+            << ", blocked " << seconds(stage.blocked_nanoseconds) << "s\n";
+    };
+
+    std::cout << "order:            "
+        << (in_order ? "block" : "costliest first") << "\n";
+    report("parse:            ", statistics.parse);
+    report("precompute:       ", statistics.precompute);
+    report("verify:           ", statistics.verify);
+    return failures;
+}
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: libbitcoin-consensus-verify [-j threads] [-f flags] [-p] "
+        "[-c] <blk.dat> <spent> [<blk.dat> <spent>]...\n"
+        "Verifies every input of the blocks against their spent outputs.\n"
+        "  -j  Verification threads (default: hardware concurrency).\n"
+        "  -p  Verify in a pipeline of parse, precompute and verify stages,\n"
+        "      the inputs of each block on the threads, costliest first.\n"
+        "  -c  Verify in the pipeline twice, the inputs of each block in\n"
+        "      block order and then costliest first, and compare the time\n"
+        "      to verify the blocks, the sum of their makespans. Counters\n"
+        "      are those of both passes.\n"
+        "  -f  Verification flags of blocks in version 1 spent outputs\n"
+        "      files, which have no flags of their own (default: 0x"
+        << std::hex << default_flags << std::dec << ").\n";
+}
+
+int main(int argc, char* argv[])
+{
+    auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto flags = default_flags;
+    auto pipelined = false;
+    auto compare = false;
+    std::vector<std::string> paths;
+
+    try
+    {
+        for (auto arg = 1; arg < argc; ++arg)
+        {
+            const std::string option(argv[arg]);
+
+            if ((option == "-j" || option == "-f") && arg + 1 < argc)
+            {
+                const auto value = std::stoul(argv[++arg], nullptr, 0);
+                if (option == "-j")
+                    threads = std::max(static_cast<unsigned>(value), 1u);
+                else
+                    flags = static_cast<uint32_t>(value);
+            }
+            else if (option == "-p")
+            {
+                pipelined = true;
+            }
+            else if (option == "-c")
+            {
+                pipelined = true;
+                compare = true;
+            }
+            else
+            {
+                paths.push_back(option);
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    if (paths.empty() || paths.size() % 2 != 0)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    // Files remain mapped for the duration of verification.
+    std::vector<std::unique_ptr<block_file>> files;
+    std::vector<std::pair<size_t, size_t>> jobs;
+
+    try
+    {
+        for (size_t path = 0; path < paths.size(); path += 2)
+        {
+            files.push_back(std::make_unique<block_file>(paths[path],
+                paths[path + 1]));
+
+            for (size_t block = 0; block < files.back()->blocks().size(); ++block)
+                jobs.emplace_back(files.size() - 1, block);
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<size_t> next_job{ 0 };
+    std::atomic<uint64_t> inputs{ 0 };
+    std::atomic<uint64_t> signature_checks{ 0 };
+    std::atomic<size_t> failures{ 0 };
+    std::mutex report_mutex;
+
+    // Blocks are claimed in turn by each thread, which verifies them in its
+    // own context. Blocks are verified in place in the mapped file, their
+    // spent outputs referenced there, reusing the capacity of the references.
+    const auto verify = [&]()
+    {
+        verification_context context;
+        std::vector<output_reference> spent;
+        uint64_t verified = 0;
+
+        for (auto job = next_job++; job < jobs.size(); job = next_job++)
+        {
+            const auto& file = *files[jobs[job].first];
+            const auto index = jobs[job].second;
+            file.get_outputs(spent, index);
+
+            const auto result = verify_block(context, { file.block_data(index),
+                file.blocks()[index].size, spent.data(), spent.size() },
+                file.flags(index, flags));
+            verified += spent.size();
+
+            if (result != verify_result_eval_true)
+            {
+                ++failures;
+                const std::lock_guard<std::mutex> lock(report_mutex);
+                std::cerr << file.path() << ": block " << index << " at "
+                    << file.blocks()[index].offset << " failed ("
+                    << result << ")" << std::endl;
+            }
+        }
+
+        inputs += verified;
+        signature_checks += context.signature_checks();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // The verify stage is busy for the makespan of each block on the pool.
+    uint64_t in_order_makespan = 0;
+    uint64_t cost_order_makespan = 0;
+
+    if (pipelined)
+    {
+        uint64_t submitted = 0;
+        pipeline_statistics statistics{};
+
+        if (compare)
+        {
+            failures += verify_pipeline(files, jobs, threads, flags, true,
+                submitted, statistics);
+            signature_checks += statistics.signature_checks;
+            in_order_makespan = statistics.verify.busy_nanoseconds;
+        }
+
+        failures += verify_pipeline(files, jobs, threads, flags, false,
+            submitted, statistics);
+        signature_checks += statistics.signature_checks;
+        cost_order_makespan = statistics.verify.busy_nanoseconds;
+        inputs = submitted;
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        for (unsigned thread = 0; thread < threads; ++thread)
+            workers.emplace_back(verify);
+
+        for (auto& worker: workers)
+            worker.join();
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const auto seconds = std::max(elapsed.count(), 1e-9);
+
+    std::cout
+        << "threads:          " << threads << "\n"
+        << "blocks:           " << jobs.size() << "\n"
+        << "inputs:           " << inputs << "\n"
+        << "signature checks: " << signature_checks << "\n"
+        << "failures:         " << failures << "\n"
+        << "seconds:          " << seconds << "\n"
+        << "inputs/s:         " << static_cast<uint64_t>(inputs / seconds) << "\n"
+        << "sigchecks/s:      "
+        << static_cast<uint64_t>(signature_checks / seconds) << std::endl;
+
+    if (compare)
+    {
+        const auto makespan = [](uint64_t nanoseconds)
+        {
+            return static_cast<double>(nanoseconds) / 1e9;
+        };
+
+        std::cout
+            << "makespan (block): " << makespan(in_order_makespan) << "s\n"
+            << "makespan (cost):  " << makespan(cost_order_makespan) << "s\n"
+            << "speedup:          " << makespan(in_order_makespan) /
+                std::max(makespan(cost_order_makespan), 1e-9) << std::endl;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}